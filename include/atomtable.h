@@ -0,0 +1,149 @@
+#pragma once
+
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <functional>
+#include "common.h"
+
+
+namespace TDEngine2
+{
+	/*!
+		class AtomTable
+
+		\brief The class interns strings, so every unique identifier is stored once per process and is referred
+		by a 32-bit id. The table is append only and could be used by all workers concurrently. Entries never
+		move in memory, so strings that are returned by GetString stay valid until the program's termination.
+
+		The table is split into shards, each of them has its own lock. The lowest bits of an id contain
+		a shard's index, the rest is an index of the entry within the shard. The empty string is always
+		interned with mEmptyAtomId
+	*/
+
+	class AtomTable
+	{
+		public:
+			static constexpr uint32_t mEmptyAtomId = 0;
+
+			static constexpr uint32_t mShardsCountLog2 = 4;
+			static constexpr uint32_t mShardsCount = 1 << mShardsCountLog2;
+
+			static constexpr uint32_t mEntriesPerBlockLog2 = 12;
+			static constexpr uint32_t mEntriesPerBlock = 1 << mEntriesPerBlockLog2;
+			static constexpr uint32_t mMaxBlocksPerShard = 1 << 10; ///< Up to 4M of unique strings per shard
+		public:
+			AtomTable();
+			~AtomTable() = default;
+
+			AtomTable(const AtomTable&) = delete;
+			AtomTable& operator= (const AtomTable&) = delete;
+
+			/*!
+				\brief The method returns an id of the given string, the string is copied into the table when it's met first time
+			*/
+
+			uint32_t Intern(std::string_view value);
+
+			const std::string& GetString(uint32_t id) const TDE2_NOEXCEPT;
+			size_t GetHash(uint32_t id) const TDE2_NOEXCEPT;
+
+			/*!
+				\brief The method returns a process wide table that is shared between all workers
+			*/
+
+			static AtomTable& Get();
+		private:
+			struct TEntry
+			{
+				std::string mValue;
+				size_t      mHash = 0;
+			};
+
+			struct TKey
+			{
+				std::string_view mValue;
+				size_t           mHash;
+
+				bool operator== (const TKey& key) const { return mHash == key.mHash && mValue == key.mValue; }
+			};
+
+			struct TKeyHasher
+			{
+				size_t operator()(const TKey& key) const { return key.mHash; }
+			};
+
+			struct TShard
+			{
+				std::mutex                                                mMutex;
+				std::unordered_map<TKey, uint32_t, TKeyHasher>            mIndices;
+				std::array<std::unique_ptr<TEntry[]>, mMaxBlocksPerShard> mpBlocks;
+				uint32_t                                                  mEntriesCount = 0;
+			};
+		private:
+			const TEntry& _getEntry(uint32_t id) const TDE2_NOEXCEPT;
+		private:
+			std::array<std::unique_ptr<TShard>, mShardsCount> mpShards;
+
+			uint64_t                                          mUid; ///< Distinguishes tables within thread local caches of atoms
+	};
+
+
+	/*!
+		class TAtom
+
+		\brief The type is a handle of an interned string. Atoms are compared by their ids. The hash of an atom
+		is computed once on interning and equals to std::hash<std::string> of its value, so unordered containers
+		keyed by atoms are iterated in the same order as ones keyed by strings
+	*/
+
+	class TAtom
+	{
+		public:
+			TAtom() = default;
+			TAtom(std::string_view value);
+			TAtom(const std::string& value);
+			TAtom(const char* pValue);
+
+			/*!
+				\brief The method wraps an id that was previously returned by AtomTable::Intern
+			*/
+
+			static TAtom FromId(uint32_t id) TDE2_NOEXCEPT;
+
+			const std::string& GetString() const TDE2_NOEXCEPT;
+			size_t GetHash() const TDE2_NOEXCEPT;
+			uint32_t GetId() const TDE2_NOEXCEPT { return mId; }
+
+			bool IsEmpty() const TDE2_NOEXCEPT { return AtomTable::mEmptyAtomId == mId; }
+
+			/// \note The operators are hidden friends, so implicit conversions into TAtom don't interfere with comparisons of other strings
+			friend bool operator== (const TAtom& left, const TAtom& right) { return left.mId == right.mId; }
+			friend bool operator!= (const TAtom& left, const TAtom& right) { return left.mId != right.mId; }
+
+			friend bool operator== (const TAtom& left, std::string_view right) { return left.GetString() == right; }
+			friend bool operator!= (const TAtom& left, std::string_view right) { return left.GetString() != right; }
+			friend bool operator== (const TAtom& left, const std::string& right) { return left.GetString() == right; }
+			friend bool operator!= (const TAtom& left, const std::string& right) { return left.GetString() != right; }
+			friend bool operator== (const TAtom& left, const char* pRight) { return left.GetString() == pRight; }
+			friend bool operator!= (const TAtom& left, const char* pRight) { return left.GetString() != pRight; }
+		private:
+			uint32_t mId = AtomTable::mEmptyAtomId;
+	};
+}
+
+
+namespace std
+{
+	template <>
+	struct hash<TDEngine2::TAtom>
+	{
+		size_t operator()(const TDEngine2::TAtom& atom) const TDE2_NOEXCEPT { return atom.GetHash(); }
+	};
+}
@@ -0,0 +1,227 @@
+#pragma once
+
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include "common.h"
+
+
+namespace TDEngine2
+{
+	/*!
+		\brief The v2 format of cached symbol tables. An image of a table is a header that is followed by arrays
+		of fixed-size records and a blob of strings. All records consist of 32-bit little-endian words, so on
+		little-endian hosts a mapped file is read in place and a table is restored by replacing indices with pointers.
+
+		Records refer to strings by indices of TStringRecord, every unique string is stored once. Any index could be
+		equal to mInvalidIndex if there is nothing to refer to
+	*/
+
+	namespace CacheFormat
+	{
+		static constexpr uint32_t mMagic = 0x43534454; ///< "TDSC" in little-endian order
+		static constexpr uint32_t mVersion = 2;
+
+		static constexpr uint32_t mInvalidIndex = 0xFFFFFFFF;
+
+
+		enum E_IMAGE_FLAGS : uint32_t
+		{
+			IF_SKIPPED = 1 << 0,
+		};
+
+
+		enum E_TYPE_FLAGS : uint32_t
+		{
+			TF_MARKED_WITH_ATTRIBUTE = 1 << 0,
+			TF_STRONGLY_TYPED        = 1 << 1,
+			TF_INTROSPECTABLE        = 1 << 2,
+			TF_FORWARD_DECLARATION   = 1 << 3,
+			TF_FINAL                 = 1 << 4,
+			TF_STRUCT                = 1 << 5,
+			TF_TEMPLATE              = 1 << 6,
+		};
+
+
+		struct THeader
+		{
+			uint32_t mMagic;
+			uint32_t mVersion;
+			uint32_t mToolVersionMajor;
+			uint32_t mToolVersionMinor;
+			uint32_t mOptionsDigestLow;  ///< Halves of ComputeOptionsDigestHash's result
+			uint32_t mOptionsDigestHigh;
+			uint32_t mFlags;             ///< E_IMAGE_FLAGS
+			uint32_t mSourceFilenameIndex;
+
+			uint32_t mStringsCount;
+			uint32_t mScopesCount;
+			uint32_t mSymbolsCount;
+			uint32_t mTypesCount;
+			uint32_t mAtomsCount;
+			uint32_t mBaseClassesCount;
+			uint32_t mStringsDataSize;   ///< Size of the blob in bytes
+
+			uint32_t mReserved;
+		};
+
+
+		struct TStringRecord
+		{
+			uint32_t mOffset; ///< Offset within the blob of strings
+			uint32_t mLength;
+		};
+
+
+		/*!
+			\brief Scopes are stored in order of their creation, so a parent always precedes its children
+		*/
+
+		struct TScopeRecord
+		{
+			uint32_t mParentIndex;
+			uint32_t mNameIndex;
+			uint32_t mIndex;          ///< SymTable::TScopeEntity::mIndex as unsigned value
+			uint32_t mTypeIndex;
+			uint32_t mTypeSlotIndex;  ///< Types are registered in order of their slots to keep order of SymTable::GetEnums and GetClasses
+			uint32_t mFirstSymbolIndex;
+			uint32_t mSymbolsCount;
+		};
+
+
+		struct TSymbolRecord
+		{
+			uint32_t mNameIndex;
+			uint32_t mTypeIndex;
+		};
+
+
+		/*!
+			\brief A type is stored once no matter how many scopes and symbols refer to it. Atoms are enumerators
+			of enums and fields of classes
+		*/
+
+		struct TTypeRecord
+		{
+			uint32_t mSubtype;
+			uint32_t mIdIndex;
+			uint32_t mMangledIdIndex;
+			uint32_t mSectionIdIndex;
+			uint32_t mParentTypeIndex;
+			uint32_t mAccessModifier;
+			uint32_t mFlags; ///< E_TYPE_FLAGS
+			uint32_t mUnderlyingTypeIndex;
+			uint32_t mFirstAtomIndex;
+			uint32_t mAtomsCount;
+			uint32_t mFirstBaseClassIndex;
+			uint32_t mBaseClassesCount;
+		};
+
+
+		struct TAtomRecord
+		{
+			uint32_t mStringIndex;
+		};
+
+
+		struct TBaseClassRecord
+		{
+			uint32_t mFullNameIndex;
+			uint32_t mIsVirtualInherited;
+			uint32_t mAccessSpecifier;
+		};
+
+
+		/*!
+			\brief Offsets of arrays of records within an image, they follow each other in the order of the fields
+		*/
+
+		struct TLayout
+		{
+			size_t mStringsOffset;
+			size_t mScopesOffset;
+			size_t mSymbolsOffset;
+			size_t mTypesOffset;
+			size_t mAtomsOffset;
+			size_t mBaseClassesOffset;
+			size_t mStringsDataOffset; ///< The blob is the only part of the image that isn't a sequence of words
+			size_t mSize;
+		};
+
+
+		TLayout GetLayout(const THeader& header);
+
+
+		/*!
+			\brief The index of the pack of cached tables. It's a header that is followed by an array of entries and
+			a blob of strings. Images of tables are stored within the pack at offsets that are multiple of mImageAlignment
+		*/
+
+		static constexpr uint32_t mIndexMagic = 0x49534454; ///< "TDSI" in little-endian order
+		static constexpr uint32_t mImageAlignment = 8;
+
+
+		struct TIndexHeader
+		{
+			uint32_t mMagic;
+			uint32_t mVersion;
+			uint32_t mPackGeneration;   ///< The pack is renamed on every compaction, so an index never refers to a pack it wasn't written for
+			uint32_t mEntriesCount;
+			uint32_t mStringsDataSize;
+			uint32_t mReserved;
+		};
+
+
+		struct TIndexEntryRecord
+		{
+			uint32_t mPathOffset;        ///< Paths are canonical, see TCacheData
+			uint32_t mPathLength;
+			uint32_t mHashOffset;
+			uint32_t mHashLength;
+			uint32_t mImageOffsetLow;
+			uint32_t mImageOffsetHigh;
+			uint32_t mImageSize;
+			uint32_t mFileSizeLow;       ///< Halves of fields of TFileStat
+			uint32_t mFileSizeHigh;
+			uint32_t mLastWriteTimeLow;
+			uint32_t mLastWriteTimeHigh;
+			uint32_t mInodeLow;
+			uint32_t mInodeHigh;
+			uint32_t mOptionsDigestLow;  ///< Halves of ComputeOptionsDigestHash's result for options the table was built with
+			uint32_t mOptionsDigestHigh;
+			uint32_t mLastAccessTimeLow;
+			uint32_t mLastAccessTimeHigh;
+			uint32_t mReserved;
+		};
+
+		/*!
+			\brief The function returns true if the data starts with the header of the current format's version.
+			Images of other versions and files of the previous Archive based format return false
+		*/
+
+		bool IsImage(std::string_view data) TDE2_NOEXCEPT;
+
+		/*!
+			\brief The function returns true if the data starts with the header of the current index's version
+		*/
+
+		bool IsIndex(std::string_view data) TDE2_NOEXCEPT;
+
+		/*!
+			\brief The function computes 64-bit FNV-1a hash of the value. It's used to compare options of a cached
+			image with current ones without storing the whole digest
+		*/
+
+		uint64_t ComputeOptionsDigestHash(std::string_view optionsDigest) TDE2_NOEXCEPT;
+
+		bool IsLittleEndianHost() TDE2_NOEXCEPT;
+
+		/*!
+			\brief The function converts words between the host's order and little-endian one, it does nothing on little-endian hosts
+		*/
+
+		void SwapWordsIfBigEndian(uint32_t* pWords, size_t wordsCount) TDE2_NOEXCEPT;
+	}
+}
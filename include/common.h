@@ -24,6 +24,7 @@ namespace TDEngine2
 
 
 	class SymTable;
+	class TypesFilter;
 
 
 	enum class E_EMIT_FLAGS : uint8_t
@@ -53,6 +54,7 @@ namespace TDEngine2
 		bool                      mIsTaggedOnlyModeEnabled = false;
 		bool                      mIsLogOutputEnabled = true;
 		bool                      mIsForceModeEnabled = false;
+		bool                      mIsCacheGCModeEnabled = false; ///< The tool only collects garbage within the cache and exits
 
 		std::vector<std::string>  mInputSources { "." };
 		std::vector<std::string>  mPathsToExclude;
@@ -61,24 +63,50 @@ namespace TDEngine2
 		std::string               mCacheDirname = "./cache/";
 		std::string               mCacheIndexFilename = "index.cache";
 
+		uint32_t                  mCacheSizeLimit = 0; ///< Megabytes, least recently used tables are evicted from a larger cache, 0 means there is no limit
+		uint32_t                  mCacheMaxAge = 0;    ///< Days, tables that weren't used for a longer time are evicted, 0 means there is no limit
+
 		std::string               mOutputDirname = ".";
 		std::string               mOutputFilename = "metadata.h";
 
 		uint16_t                  mCurrNumOfThreads = 1;
 
+		uint32_t                  mParallelParsingThreshold = 1 << 20; ///< Files of this size in bytes or larger are split into chunks that are parsed concurrently, 0 disables it
+
+		uint32_t                  mMaxTokensPerFile = 0;      ///< A file that contains more tokens is skipped, 0 means there is no limit
+		uint32_t                  mMaxParsingTimePerFile = 0; ///< A file that takes more milliseconds to parse is skipped, 0 means there is no limit
+
 		E_EMIT_FLAGS              mEmitFlags = E_EMIT_FLAGS::ALL;
 
+		std::shared_ptr<const TypesFilter> mpTypesFilter; ///< Is built from mEmitFlags and excluded typenames, the parser collects members of all types if it's null
+
 		static TIntrospectorOptions mInvalid;
 	};
 
 	TIntrospectorOptions ParseOptions(int argc, const char** argv) TDE2_NOEXCEPT;
 
+	/*!
+		\brief The function returns a string that identifies options which affect contents of symbol tables,
+		it's mixed into hashes of cached files, so tables that were built with other options aren't reused
+	*/
+
+	std::string GetOptionsDigest(const TIntrospectorOptions& options);
+
 	std::vector<std::string> GetHeaderFiles(const std::vector<std::string>& directories, const std::vector<std::string>& excludedPaths) TDE2_NOEXCEPT;
 	
 	void WriteOutput(const std::string& text) TDE2_NOEXCEPT;
 
 	std::unique_ptr<SymTable> ProcessHeaderFile(const TIntrospectorOptions& options, const std::string& filename) TDE2_NOEXCEPT;
 
+	/*!
+		\brief The function restores a symbol table from a separate cached file as the previous layout of the cache stored
+		them. Both images and files of the Archive based format are read
+
+		\return nullptr if there is no file or it's damaged, or it was written by another version or with other options
+	*/
+
+	std::unique_ptr<SymTable> LoadSymTableFromCache(const std::string& cachePath, const std::string& optionsDigest) TDE2_NOEXCEPT;
+
 
 	extern const std::string GeneratedHeaderPrelude;
 
@@ -132,50 +160,182 @@ namespace TDEngine2
 	}
 
 
+	class IInputStream;
+	class FileFingerprint;
+
+
+	/*!
+		\brief Attributes of a file that are read without opening it. If all of them are the same as the stored ones
+		the content is considered unchanged, see FileFingerprint. On Windows mInode is the file index of the volume
+	*/
+
+	struct TFileStat
+	{
+		uint64_t mSize = 0;
+		int64_t  mLastWriteTime = 0; ///< Nanoseconds on POSIX systems, 100-nanosecond intervals on Windows
+		uint64_t mInode = 0;
+
+		bool operator== (const TFileStat& other) const { return mSize == other.mSize && mLastWriteTime == other.mLastWriteTime && mInode == other.mInode; }
+		bool operator!= (const TFileStat& other) const { return !(*this == other); }
+	};
+
+
+	/*!
+		class TCacheData
+
+		\brief The class keeps all cached symbol tables within a single pack file. The pack is append only, images of
+		new tables are added to its end, superseded ones stay there until the pack is compacted. The index maps a header's
+		canonical path onto the header's fingerprint, a digest of options and a location of the image within the pack,
+		so a warm run maps the pack once. Every entry is valid on its own, runs over different sets of inputs share the cache.
+
+		The index isn't changed while jobs run. Jobs put new images into buffers of their threads, and Save merges them
+	*/
+
 	class TCacheData
 	{
 		public:
-			using TCacheIndexTable = std::unordered_map<std::string, std::string>;
-
+			struct TEntry
+			{
+				std::string mHash;        ///< A hash of the file's content, see FileFingerprint. Entries of the previous layout keep GetHashFromFilePath's one
+				TFileStat   mFileStat;
+				uint64_t    mOptionsDigestHash = 0; ///< See CacheFormat::ComputeOptionsDigestHash
+				uint64_t    mLastAccessTime = 0;    ///< Seconds since the epoch of the last run that built or reused the table
+				uint64_t    mOffset = 0;  ///< A position of the table's image within the pack
+				uint32_t    mSize = 0;    ///< 0 means the table is stored in a separate file named by the hash as the previous cache's layout did
+			};
+
+			using TCacheIndexTable = std::unordered_map<std::string, TEntry>;
+
+			struct TEvictionPolicy
+			{
+				uint64_t mSizeLimit = 0; ///< Bytes of images, 0 means there is no limit
+				uint64_t mMaxAge = 0;    ///< Seconds, 0 means there is no limit
+			};
+
+			static constexpr uint64_t mMinCompactedPackSize = 1 << 20; ///< Smaller packs are never compacted
+			static constexpr uint32_t mCompactionRatio = 2;            ///< The pack is compacted once it's this times larger than its live images
 		public:
+			TCacheData();
+			~TCacheData();
+
 			/*!
-				\brief The function returns an index of cached symbols per file. The key of the table
-				is a full header's path, the value is a name of corresponding cache file. The name is
-				SHA-256 hashsum
+				\brief The function reads an index of cached symbols per file and maps the pack. The key of the table
+				is a full header's path. Indices of the previous layout are read too, their tables are stored in files
+				that are named by hashes
 			*/
 
 			bool Load(const std::string& cacheSourceDirectory, const std::string& cacheFilename);
 
 			/*!
-				\brief The functions writes down current options into a main cache file
+				\brief The functions appends buffered images to the pack, compacts it if there is too much garbage,
+				and writes down the index. The index is replaced atomically, so an interrupted run leaves a valid cache.
+				Entries of removed files are dropped and entries are evicted according to the policy, then files that
+				the new index doesn't refer to are removed
 			*/
 
 			bool Save(const std::string& cacheSourceDirectory, const std::string& cacheFilename);
 
 			void Reset();
 
-			void AddSymTableEntity(const std::string& filePath, const std::string& fileHash);
+			/*!
+				\brief The method keeps the new image of the file's table until Save is called. It's thread safe,
+				a lock is taken only when a thread adds its first image
+			*/
+
+			void AddSymTableEntity(const std::string& filePath, const std::string& fileHash, const TFileStat& fileStat, std::string&& image);
+
+			/*!
+				\brief The method sets options that new tables are built with. Entries that were built with other options
+				aren't reused
+			*/
+
+			void SetOptionsDigest(const std::string& optionsDigest);
+
+			/*!
+				\brief The method sets limits that are applied by Save. Entries that weren't used for longer than the max age
+				are evicted first, then least recently used ones are evicted until images fit into the size limit
+			*/
+
+			void SetEvictionPolicy(const TEvictionPolicy& policy);
 
 			bool Contains(const std::string& filePath, const std::string& fileHash) const;
 
-			void SetInputHash(const std::string& hash);
+			/*!
+				\brief The method restores the file's table if the cache contains it with the same content. The content is
+				hashed only if the file's stat differs from the stored one, then the new stat is saved with the next Save,
+				so touched files are hashed once, as well as the time of the access. Tables that are stored in separate files
+				are loaded from them and moved into the pack on the next Save
+
+				\return nullptr if there is no such table or it couldn't be loaded
+			*/
+
+			std::unique_ptr<SymTable> LoadSymTable(const std::string& filePath, FileFingerprint& fingerprint);
+
 			void SetSymTablesIndex(TCacheIndexTable&& table);
 
 			const TCacheIndexTable& GetSymTablesIndex() const;
-			const std::string& GetInputHash() const;
 		private:
-			mutable std::mutex mMutex;
+			struct TPendingEntity
+			{
+				std::string mFilePath;
+				std::string mFileHash;
+				TFileStat   mFileStat;
+				std::string mImage; ///< An empty image means the table was reused, only the file's stat and the access time are updated
+			};
+
+			using TPendingEntities = std::vector<TPendingEntity>;
+		private:
+			TPendingEntities& _getThreadPendingEntities();
+
+			bool _loadPreviousIndex(const std::string& indexPath);
+			bool _saveIndex(const std::string& indexPath) const;
+
+			/*!
+				\brief The method removes entries of files that don't exist anymore
+			*/
 
-			std::string mInputHash;
+			void _removeStaleEntries();
 
+			/*!
+				\brief The method removes entries according to the eviction policy, new images are pending ones
+			*/
+
+			void _evictEntries(const TPendingEntities& pendingEntities, uint64_t currTime);
+
+			/*!
+				\brief The method removes packs of other generations and separate files of the previous layout that
+				the index doesn't refer to. Other files within the directory are never touched
+			*/
+
+			void _removeUnreferencedFiles() const;
+
+			std::string _getPackPath(uint32_t generation) const;
+		private:
 			TCacheIndexTable mSymTablesTable;
+
+			std::string mOptionsDigest;
+			uint64_t mOptionsDigestHash = 0;
+
+			TEvictionPolicy mEvictionPolicy;
+
+			std::string mCacheDirectory;
+
+			uint32_t mPackGeneration = 0;
+			uint64_t mPackSize = 0;
+
+			std::unique_ptr<IInputStream> mpPackStream;
+
+			std::mutex mPendingEntitiesMutex;
+			std::vector<std::unique_ptr<TPendingEntities>> mpPendingEntities; ///< A buffer per thread
+
+			uint64_t mUid; ///< Distinguishes instances within thread local pointers to buffers
 	};
 
 	
 	/*!
-		\brief All file paths within the vector should have canonical form to prevent different hashes for representations of same files
+		\brief The function hashes the path and the last write time of the file. The hash names separate files of
+		the previous cache's layout, it's used only to find them
 	*/
 
-	std::string GetHashFromInputFiles(const std::vector<std::string>& inputFiles);
-	std::string GetHashFromFilePath(const std::string& value);
+	std::string GetHashFromFilePath(const std::string& value, const std::string& optionsDigest = "");
 }
\ No newline at end of file
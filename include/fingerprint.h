@@ -0,0 +1,82 @@
+#pragma once
+
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "common.h"
+
+
+namespace TDEngine2
+{
+	/*!
+		\return false if the file doesn't exist or its attributes can't be read
+	*/
+
+	bool GetFileStat(const std::string& filePath, TFileStat& stat) TDE2_NOEXCEPT;
+
+
+	struct THash128
+	{
+		uint64_t mLow = 0;
+		uint64_t mHigh = 0;
+
+		bool operator== (const THash128& other) const { return mLow == other.mLow && mHigh == other.mHigh; }
+		bool operator!= (const THash128& other) const { return !(*this == other); }
+
+		/*!
+			\brief The method returns 32 lowercase hex digits, the high half goes first
+		*/
+
+		std::string ToString() const;
+	};
+
+
+	/*!
+		\brief The function computes MurmurHash3 (x64, 128-bit) of the data. It isn't a cryptographic hash, it's used
+		to detect changes of files' content and processes gigabytes per second
+	*/
+
+	THash128 ComputeContentHash(std::string_view data, uint64_t seed = 0) TDE2_NOEXCEPT;
+
+
+	/*!
+		class FileFingerprint
+
+		\brief The class decides whether a file is the same one that was cached. Comparison of TFileStat is the fast path,
+		the content is read and hashed only if the attributes differ, e.g. after a checkout that rewrote the file with the
+		same bytes. The hash is computed once and reused for the new cache entry.
+
+		The object isn't thread safe, it belongs to a job that processes the file
+	*/
+
+	class FileFingerprint
+	{
+		public:
+			explicit FileFingerprint(const std::string& filePath);
+			~FileFingerprint() = default;
+
+			/*!
+				\return true if the file has the given content hash. The hash is computed only if the stats differ or the file's ones can't be read
+			*/
+
+			bool Matches(const TFileStat& stat, const std::string& contentHash);
+
+			const TFileStat& GetStat() const TDE2_NOEXCEPT { return mStat; }
+
+			/*!
+				\brief The method returns the hash of the file's content in THash128::ToString's form or an empty string
+				if the file can't be read
+			*/
+
+			const std::string& GetContentHash();
+		private:
+			std::string mFilePath;
+
+			TFileStat   mStat;
+			bool        mIsStatValid = false;
+
+			std::string mContentHash;
+			bool        mIsContentHashComputed = false;
+	};
+}
@@ -6,12 +6,18 @@
 #include <unordered_map>
 #include <memory>
 #include <optional>
+#include <string_view>
+#include <array>
 #include "tokens.h"
+#include "scankernels.h"
 #include "common.h"
 
 
 namespace TDEngine2
 {
+	class ParsingBudget;
+
+
 	class IInputStream
 	{
 		public:
@@ -22,6 +28,16 @@ namespace TDEngine2
 			virtual bool Close() TDE2_NOEXCEPT = 0;
 
 			virtual std::string ReadLine() TDE2_NOEXCEPT = 0;
+
+			/*!
+				\brief The method returns a view of the whole content of the stream if an implementation
+				keeps it within a single contiguous memory block. Line oriented streams return std::nullopt,
+				so their content should be read with ReadLine
+
+				\return A view that is valid until the stream is closed, std::nullopt if there is no buffer
+			*/
+
+			virtual std::optional<std::string_view> GetBuffer() const TDE2_NOEXCEPT { return std::nullopt; }
 	};
 
 
@@ -45,17 +61,113 @@ namespace TDEngine2
 	};
 
 
-	class Lexer
+	/*!
+		class MappedFileInputStream
+
+		\brief The stream maps a whole file into memory and provides its content via GetBuffer without
+		any intermediate copies. Small files are loaded with a single read call, because mapping costs more for them
+	*/
+
+	class MappedFileInputStream : public IInputStream
 	{
 		public:
-			using TKeywordsMap = std::unordered_map<std::string, E_TOKEN_TYPE>;
+			explicit MappedFileInputStream(const std::string& filename) TDE2_NOEXCEPT;
+			virtual ~MappedFileInputStream() TDE2_NOEXCEPT;
+
+			bool Open() TDE2_NOEXCEPT override;
+			bool Close() TDE2_NOEXCEPT override;
+
+			std::string ReadLine() TDE2_NOEXCEPT override;
+
+			std::optional<std::string_view> GetBuffer() const TDE2_NOEXCEPT override;
+		protected:
+			MappedFileInputStream() TDE2_NOEXCEPT = default;
+
+			bool _mapFile(size_t fileSize) TDE2_NOEXCEPT;
+			bool _readFile(size_t fileSize) TDE2_NOEXCEPT;
+		protected:
+			static constexpr size_t mMinMappedFileSize = 16 * 1024; ///< Files that are less than the value are read instead of mapping
+
+			std::string              mFilename;
+
+			std::string              mFileContent; ///< The field is used only for small files that aren't mapped
+
+			const char*              mpData = nullptr;
+			size_t                   mDataSize = 0;
+			size_t                   mCurrReadPos = 0; ///< The position is used by ReadLine only
+
+			bool                     mIsOpened = false;
+			bool                     mIsMapped = false;
+
+#if defined(_WIN32)
+			void*                    mpFileHandle = nullptr;
+			void*                    mpMappingHandle = nullptr;
+#else
+			int                      mFileDescriptor = -1;
+#endif
+	};
+
+
+	class Lexer
+	{
 		public:
+			/*!
+				\brief The constructor prefers IInputStream::GetBuffer over line by line reading, so
+				the stream should be already opened at the moment. Line oriented streams are read
+				into an internal buffer once, the lexer never modifies the text it scans
+			*/
+
 			explicit Lexer(IInputStream& streamSource);
 			~Lexer() = default;
 
+			/*!
+				\brief The returned reference stays valid until the next GetNextToken call
+			*/
+
 			const TToken& GetCurrToken();
+
+			/*!
+				\brief The method moves to the next token, it's taken from the lookahead window first if PeekToken filled it.
+				The returned reference stays valid until the next GetNextToken call
+			*/
+
 			const TToken& GetNextToken();
+
+			/*!
+				\brief The method returns a token that goes offset tokens after the current one without moving the cursor.
+				PeekToken(0) is the current token, PeekToken(1) is the one GetNextToken will return. The offset can't
+				exceed mMaxLookaheadTokensCount.
+
+				The lookahead window is a fixed ring buffer, so the returned reference stays valid until the peeked
+				token is consumed with GetNextToken
+			*/
+
 			const TToken& PeekToken(uint32_t offset = 1);
+
+			/*!
+				\brief The method scans all remaining tokens at once, the last one in the array is always EOF. The lexer
+				shouldn't be used for streaming after that. If the budget is exceeded the rest of the file is cut off
+			*/
+
+			TTokensArray Tokenize(ParsingBudget* pBudget = nullptr);
+
+			/*!
+				\brief The method returns a line and a column of a token that was scanned by the lexer. Tokens don't
+				store them, so the first call scans the text for lines once
+			*/
+
+			TToken::TCursorPos GetCursorPos(const TToken& token);
+
+			/*!
+				\brief The method jumps over a balanced {...} block that starts with the current token directly in the source
+				buffer, so tokens within the block aren't scanned. The token right after the closing brace becomes the current one
+
+				\return false if the current token isn't an opening brace
+			*/
+
+			bool SkipBalancedBlock();
+		public:
+			static constexpr uint32_t mMaxLookaheadTokensCount = 8; ///< Should be a power of two
 		private:
 			Lexer() = default;
 
@@ -77,17 +189,26 @@ namespace TDEngine2
 
 			void _skipSingleLineComment();
 			void _skipMultiLineComment();
+
+			void _initSourceBuffer();
+
+			void _moveCursor(size_t pos);
 		private:
 			IInputStream*             mpStream;
 
-			std::string               mCurrProcessedText;
+			std::string               mOwnedSourceText; ///< Contains a whole text of a stream that doesn't provide its own buffer
+			std::string_view          mSourceText;
+
+			size_t                    mNextCharPos = 0; ///< The current character is placed right before the position, so 0 means nothing was read yet
+
+			std::array<TToken, mMaxLookaheadTokensCount> mLookaheadTokens;
+			uint32_t                  mLookaheadFirstIndex = 0;
+			uint32_t                  mLookaheadTokensCount = 0;
 
-			std::vector<TToken>       mTokensQueue;
 			TToken                    mLastScannedToken{};
 
-			uint32_t                  mCurrLineIndex = 1;
-			uint32_t                  mCurrHorPosIndex = 0;
+			const TScanKernels*       mpScanKernels;
 
-			static const TKeywordsMap mReservedTokens;
+			LinesIndex                mLinesIndex;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,86 @@
+#pragma once
+
+
+#include <cstdint>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <type_traits>
+#include "common.h"
+
+
+namespace TDEngine2
+{
+	/*!
+		class MemoryArena
+
+		\brief The class is a monotonic allocator. Memory is taken from chunks with a bump pointer and
+		is never freed separately, the whole arena is released with a single Reset call. Objects that are
+		created with Create are destroyed on Reset in reverse order.
+
+		Released chunks of the default size are kept in a thread local cache, so arenas of next files that
+		are processed by the same worker don't touch the heap
+	*/
+
+	class MemoryArena
+	{
+		public:
+			static constexpr size_t mDefaultChunkSize = 64 * 1024;
+		public:
+			MemoryArena() = default;
+			~MemoryArena();
+
+			MemoryArena(const MemoryArena&) = delete;
+			MemoryArena& operator= (const MemoryArena&) = delete;
+
+			void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+			template <typename T, typename... TArgs>
+			T* Create(TArgs&&... args)
+			{
+				T* pObject = new (Allocate(sizeof(T), alignof(T))) T(std::forward<TArgs>(args)...);
+
+				if constexpr (!std::is_trivially_destructible_v<T>)
+				{
+					_registerDestructor(pObject, [](void* pPtr) { static_cast<T*>(pPtr)->~T(); });
+				}
+
+				return pObject;
+			}
+
+			/*!
+				\brief The method destroys all objects that were created within the arena and releases its memory
+			*/
+
+			void Reset();
+
+			size_t GetUsedBytes() const TDE2_NOEXCEPT { return mUsedBytes; }
+		private:
+			struct TChunkHeader
+			{
+				TChunkHeader* mpNext;
+				size_t        mSize; ///< Includes the header
+			};
+
+			struct TDestructorRecord
+			{
+				void               (*mpDestructor)(void*);
+				void*              mpObject;
+				TDestructorRecord* mpNext;
+			};
+		private:
+			void _registerDestructor(void* pObject, void (*pDestructor)(void*));
+			void _allocateChunk(size_t minSize);
+
+			static TChunkHeader* _acquireChunk(size_t size);
+			static void _releaseChunk(TChunkHeader* pChunk);
+		private:
+			TChunkHeader*      mpChunks = nullptr;
+			TDestructorRecord* mpDestructors = nullptr;
+
+			uintptr_t          mCurrPos = 0;
+			uintptr_t          mEndPos = 0;
+
+			size_t             mUsedBytes = 0;
+	};
+}
@@ -6,19 +6,23 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
+#include <array>
 #include "common.h"
+#include "tokens.h"
+#include "atomtable.h"
 
 
 namespace TDEngine2
 {
 	class Lexer;
 	class SymTable;
+	class ParsingBudget;
 
-	struct TToken;
 	struct TType;
 	struct TEnumType;
+	struct TClassType;
 
-	enum class E_TOKEN_TYPE : uint16_t;
 	enum class E_ACCESS_SPECIFIER_TYPE : uint8_t;
 
 
@@ -29,6 +33,7 @@ namespace TDEngine2
 		enum class E_PARSER_ERROR_CODE: uint32_t
 		{
 			UNEXPECTED_SYMBOL,
+			BUDGET_EXCEEDED,
 			UNKNOWN
 		};
 
@@ -44,7 +49,14 @@ namespace TDEngine2
 				E_TOKEN_TYPE mExpectedToken;
 			};
 
+			struct TBudgetExceededErrorData
+			{
+				uint64_t mTokensCount;
+				uint32_t mElapsedTime; ///< In milliseconds
+			};
+
 			TUnexpectedTokenErrorData mUnexpectedTokenErrData;
+			TBudgetExceededErrorData  mBudgetExceededErrData;
 		} mData;
 
 		std::string ToString() const;
@@ -54,6 +66,36 @@ namespace TDEngine2
 	std::string ParserErrorToString(TParserError::E_PARSER_ERROR_CODE errorCode);
 
 
+	/*!
+		struct TDeclarationsChunk
+
+		\brief The structure describes a range of tokens that could be parsed apart from the rest of a file. A chunk
+		starts right after a declaration of the namespace level, so all it takes from preceding tokens are namespaces
+		that enclose it and a section that ENUM_META attributes of the same declarations sequence have set
+	*/
+
+	struct TDeclarationsChunk
+	{
+		size_t             mFirstTokenIndex = 0;
+		size_t             mEndTokenIndex = 0; ///< An index of the first token after the chunk
+
+		std::vector<TAtom> mNamespaces; ///< Named namespaces that enclose the chunk, the outermost one goes first
+
+		std::string        mSectionId;
+
+		bool               mIsWithinNamespace = false; ///< True if any named or anonymous namespace encloses the chunk
+	};
+
+
+	/*!
+		\brief The function splits tokens into chunks at ends of declarations of the namespace level, all chunks but
+		namespaces' boundaries contain at least minTokensCount tokens. An empty array is returned if the file
+		can't be split, so that chunks are parsed exactly the same way as the whole file
+	*/
+
+	std::vector<TDeclarationsChunk> SplitIntoDeclarationsChunks(const TTokensArray& tokens, size_t minTokensCount);
+
+
 	class Parser
 	{
 		public:
@@ -69,19 +111,64 @@ namespace TDEngine2
 			};
 
 		public:
-			Parser(Lexer& lexer, SymTable& symTable, const TIntrospectorOptions& options, const TOnErrorCallback& onErrorCallback);
+			/*!
+				\brief If the budget is given, the parser consumes it token by token. Once it's exceeded the rest of the file
+				is seen as EOF and BUDGET_EXCEEDED error is reported, the budget should outlive the parser
+			*/
+
+			Parser(Lexer& lexer, SymTable& symTable, const TIntrospectorOptions& options, const TOnErrorCallback& onErrorCallback, ParsingBudget* pBudget = nullptr);
+
+			/*!
+				\brief The parser walks over the tokens with an index instead of pulling them from the lexer,
+				the array should outlive the parser
+			*/
+
+			Parser(const TTokensArray& tokens, SymTable& symTable, const TIntrospectorOptions& options, const TOnErrorCallback& onErrorCallback, ParsingBudget* pBudget = nullptr);
 			~Parser() = default;
 
 			void Parse();
+
+			/*!
+				\brief The method parses a chunk of the tokens array into a table of its own, namespaces that enclose the chunk
+				are created first. Bodies of namespaces are parsed up to the end of the file, so the last chunk reports
+				the missing closing brace as the whole file does. False is returned if the declarations sequence failed or
+				it didn't end within the chunk's namespace, so the chunk couldn't be parsed apart from the rest of the file
+			*/
+
+			bool ParseChunk(const TDeclarationsChunk& chunk, bool isLastChunk);
 		private:
 			Parser() = default;
 
+			/*!
+				\brief The methods hide whether tokens are streamed from the lexer or taken from TTokensArray,
+				returned references follow the same rules as Lexer's ones
+			*/
+
+			const TToken& _getCurrToken();
+			const TToken& _getNextToken();
+			const TToken& _peekToken(uint32_t offset = 1);
+
+			TToken _getTokenAt(size_t index) const;
+
+			/*!
+				\brief The method is invoked once the budget is exceeded, it cuts the rest of tokens off and reports the error
+			*/
+
+			void _onBudgetExceeded();
+
+			/*!
+				\brief The method returns a line and a column of the token, it's used only for errors
+			*/
+
+			TToken::TCursorPos _getCursorPos(const TToken& token);
+
 			bool _expect(E_TOKEN_TYPE expectedType, const TToken& token);
 
-			bool _parseDeclarationSequence(bool isInvokedFromTemplateDecl = false, E_DECL_TYPE allowedDeclTypes = E_DECL_TYPE::ALL);
+			bool _parseDeclarationSequence(bool isInvokedFromTemplateDecl = false, E_DECL_TYPE allowedDeclTypes = E_DECL_TYPE::ALL, const std::string& sectionId = "");
 
 			bool _parseNamespaceDefinition();
 			bool _parseNamedNamespaceDefinition();
+			void _setNamespaceType(const TAtom& namespaceId);
 			bool _parseAnonymusNamespaceDefinition();
 
 			bool _parseBlockDeclaration();
@@ -95,19 +182,46 @@ namespace TDEngine2
 			std::unique_ptr<TType> _parseTypeSpecifiers();
 
 			bool _parseClassDeclaration(E_ACCESS_SPECIFIER_TYPE accessModifier, bool isTemplateDeclaration = false, bool isTagged = false);
-			bool _parseClassHeader(const std::string& className, E_ACCESS_SPECIFIER_TYPE accessModifier, bool isStruct = false, bool isTemplate = false, bool isTagged = false);
-			bool _parseClassBody(const std::string& className, bool isTagged = false);
-			bool _parseClassMemberSpecification(const std::string& className, E_ACCESS_SPECIFIER_TYPE accessModifier);
-			bool _parseClassMemberDeclaration(const std::string& className, E_ACCESS_SPECIFIER_TYPE accessModifier);
+			bool _parseClassHeader(const TAtom& className, E_ACCESS_SPECIFIER_TYPE accessModifier, bool isStruct = false, bool isTemplate = false, bool isTagged = false);
+			bool _parseClassBody(const TAtom& className, bool isTagged = false);
+			bool _parseClassMemberSpecification(const TAtom& className, E_ACCESS_SPECIFIER_TYPE accessModifier);
+			bool _parseClassMemberDeclaration(const TAtom& className, E_ACCESS_SPECIFIER_TYPE accessModifier, bool isMembersListRequired = true);
 
-			std::string _parseClassIdentifier();
+			TAtom _parseClassIdentifier();
 			std::string _parseSimpleTemplateIdentifier();
 
 			bool _consumeBalancedTokens();
 
+			/*!
+				\brief The method skips a {...} block that starts with the current token over raw bytes of the source,
+				the token right after the block becomes the current one
+			*/
+
+			bool _skipBalancedBlock();
+
 			bool _parseCompoundStatement();
+
+			/*!
+				\brief The methods tell whether a type could be written into the output with current options. Enumerators
+				and fields of other types are never collected, the types are still parsed for their nested declarations
+			*/
+
+			bool _isEnumEmittable(const TEnumType& enumType) const;
+			bool _isClassEmittable(const TClassType& classType) const;
 		private:
-			Lexer*               mpLexer;
+			Lexer*               mpLexer = nullptr;
+
+			const TTokensArray*  mpTokens = nullptr;
+			size_t               mCurrTokenIndex = 0;
+			size_t               mTokensEndIndex = 0; ///< Tokens starting from the index are seen as EOF
+			TToken               mCurrToken;
+
+			std::array<TToken, 8> mPeekedTokens;
+
+			LinesIndex           mLinesIndex; ///< Is used for the tokens array only, the lexer has its own index
+
+			ParsingBudget*       mpBudget = nullptr;
+			bool                 mIsBudgetExceeded = false;
 
 			SymTable*            mpSymTable;
 
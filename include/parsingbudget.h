@@ -0,0 +1,92 @@
+#pragma once
+
+
+#include <cstdint>
+#include <chrono>
+#include "common.h"
+
+
+namespace TDEngine2
+{
+	/*!
+		class ParsingBudget
+
+		\brief The class limits work that is spent on a single file. The lexer and the parser consume the budget
+		cooperatively token by token, once any limit is exceeded both of them see the end of the file, so a malformed
+		header is skipped instead of stalling a worker. The clock is read once per mClockCheckPeriod tokens.
+
+		The object isn't thread safe, it belongs to a job that processes the file
+	*/
+
+	class ParsingBudget
+	{
+		public:
+			static constexpr uint32_t mClockCheckPeriod = 4096; ///< Should be a power of two
+		public:
+			/*!
+				\param[in] maxTokensCount The limit of scanned tokens, 0 means there is no limit
+				\param[in] maxTime The limit of wall time in milliseconds, 0 means there is no limit
+			*/
+
+			ParsingBudget(uint64_t maxTokensCount, uint32_t maxTime);
+			~ParsingBudget() = default;
+
+			static ParsingBudget CreateFromOptions(const TIntrospectorOptions& options);
+
+			/*!
+				\brief The method accounts new tokens that were scanned from the file
+				\return false if the budget is exceeded
+			*/
+
+			bool ConsumeTokens(uint32_t count = 1)
+			{
+				mTokensCount += count;
+
+				if (mMaxTokensCount && mTokensCount > mMaxTokensCount)
+				{
+					mIsExceeded = true;
+				}
+
+				return Tick();
+			}
+
+			/*!
+				\brief The method is called by loops that don't scan new tokens, e.g. when the parser walks over already tokenized file
+				\return false if the budget is exceeded
+			*/
+
+			bool Tick()
+			{
+				if (!mIsExceeded && mMaxTime && !(++mTicksCount & (mClockCheckPeriod - 1)))
+				{
+					_checkTime();
+				}
+
+				return !mIsExceeded;
+			}
+
+			bool IsExceeded() const TDE2_NOEXCEPT { return mIsExceeded; }
+
+			uint64_t GetTokensCount() const TDE2_NOEXCEPT { return mTokensCount; }
+
+			/*!
+				\brief The method returns milliseconds that passed since the budget's creation
+			*/
+
+			uint32_t GetElapsedTime() const;
+		private:
+			void _checkTime();
+		private:
+			using TClock = std::chrono::steady_clock;
+
+			uint64_t           mMaxTokensCount;
+			uint32_t           mMaxTime;
+
+			uint64_t           mTokensCount = 0;
+			uint32_t           mTicksCount = 0;
+
+			TClock::time_point mStartTime;
+
+			bool               mIsExceeded = false;
+	};
+}
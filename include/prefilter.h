@@ -0,0 +1,82 @@
+#pragma once
+
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <regex>
+#include <memory>
+#include "common.h"
+#include "scankernels.h"
+
+
+namespace TDEngine2
+{
+	/*!
+		class KeywordsPrefilter
+
+		\brief The class answers whether a raw text of a header contains any of the given keywords as a whole
+		identifier, so the file is worth lexing and parsing. Candidates are found with a vectorized first-byte
+		filter and then verified. Matches within comments and strings are counted too, so the answer could be
+		a false positive but never a false negative
+	*/
+
+	class KeywordsPrefilter
+	{
+		public:
+			explicit KeywordsPrefilter(const std::vector<std::string_view>& keywords, const TScanKernels& kernels = GetScanKernels());
+			~KeywordsPrefilter() = default;
+
+			/*!
+				\brief The method creates a prefilter for declarations that the introspector could extract with the
+				given options. In tagged only mode these are ENUM_META, CLASS_META and INTERFACE_META markers,
+				otherwise enum, class and struct keywords
+			*/
+
+			static KeywordsPrefilter CreateFromOptions(const TIntrospectorOptions& options);
+
+			bool HasAnyKeyword(std::string_view text) const TDE2_NOEXCEPT;
+		private:
+			std::vector<std::string_view> mKeywords;
+
+			TCharsSet                     mFirstChars;
+			bool                          mHasAllFirstChars = true; ///< False if first chars of keywords don't fit into TCharsSet, so every position is checked
+
+			const TScanKernels*           mpKernels;
+	};
+
+
+	/*!
+		class TypesFilter
+
+		\brief The class answers whether a type with the given identifier could ever be written into the output
+		with the given emit flags and excluded typenames. The parser asks it before it collects lists of members,
+		so types that are never emitted are parsed only for their nested declarations. The patterns are compiled
+		once and the filter is shared between all workers
+	*/
+
+	class TypesFilter
+	{
+		public:
+			TypesFilter(E_EMIT_FLAGS emitFlags, const std::vector<std::string>& typenamesPatternsToExclude);
+			~TypesFilter() = default;
+
+			bool IsEnumEmittable(const std::string& id) const;
+			bool IsClassEmittable(const std::string& id, bool isStruct) const;
+
+			/*!
+				\brief The method returns a string that identifies the filter's configuration, symbol tables that are
+				built with filters with different digests are not interchangeable
+			*/
+
+			const std::string& GetDigest() const TDE2_NOEXCEPT { return mDigest; }
+		private:
+			bool _isExcluded(const std::string& id) const;
+		private:
+			E_EMIT_FLAGS            mEmitFlags;
+
+			std::vector<std::regex> mTypenamesPatternsToExclude;
+
+			std::string             mDigest;
+	};
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <string_view>
+#include "common.h"
+
+
+namespace TDEngine2
+{
+	enum class E_CHAR_CLASS : uint8_t
+	{
+		NONE             = 0x0,
+		WHITESPACE       = 1 << 0,
+		IDENTIFIER_START = 1 << 1,
+		IDENTIFIER       = 1 << 2,
+	};
+
+
+	using TCharClassesTable = std::array<uint8_t, 256>;
+
+
+	constexpr TCharClassesTable BuildCharClassesTable()
+	{
+		TCharClassesTable table{};
+
+		for (const char ch : { ' ', '\t', '\n', '\v', '\f', '\r' })
+		{
+			table[static_cast<uint8_t>(ch)] = static_cast<uint8_t>(E_CHAR_CLASS::WHITESPACE);
+		}
+
+		const uint8_t identifierStartFlags = static_cast<uint8_t>(E_CHAR_CLASS::IDENTIFIER_START) | static_cast<uint8_t>(E_CHAR_CLASS::IDENTIFIER);
+
+		for (uint32_t ch = 'a'; ch <= 'z'; ++ch)
+		{
+			table[ch] = identifierStartFlags;
+			table[ch - 'a' + 'A'] = identifierStartFlags;
+		}
+
+		for (uint32_t ch = '0'; ch <= '9'; ++ch)
+		{
+			table[ch] = static_cast<uint8_t>(E_CHAR_CLASS::IDENTIFIER);
+		}
+
+		table[static_cast<uint8_t>('_')] = identifierStartFlags;
+
+		return table;
+	}
+
+
+	/*!
+		\brief The table replaces std::isspace/std::isalpha/std::isalnum calls, which depend on the current locale
+		and aren't defined for negative chars. It matches the "C" locale
+	*/
+
+	constexpr TCharClassesTable CharClassesTable = BuildCharClassesTable();
+
+
+	constexpr bool HasCharClass(char ch, E_CHAR_CLASS charClass)
+	{
+		return CharClassesTable[static_cast<uint8_t>(ch)] & static_cast<uint8_t>(charClass);
+	}
+
+	constexpr bool IsWhitespaceChar(char ch) { return HasCharClass(ch, E_CHAR_CLASS::WHITESPACE); }
+	constexpr bool IsIdentifierStartChar(char ch) { return HasCharClass(ch, E_CHAR_CLASS::IDENTIFIER_START); }
+	constexpr bool IsIdentifierChar(char ch) { return HasCharClass(ch, E_CHAR_CLASS::IDENTIFIER); }
+
+
+	enum class E_SCAN_KERNELS_TYPE : uint8_t
+	{
+		SCALAR,
+		SSE2,
+		AVX2,
+	};
+
+
+	/*!
+		struct TCharsSet
+
+		\brief The set of up to mMaxCharsCount chars that TScanKernels::mpFindAnyOfChars looks for
+	*/
+
+	struct TCharsSet
+	{
+		static constexpr size_t mMaxCharsCount = 8;
+
+		std::array<char, mMaxCharsCount> mChars {};
+		size_t                           mCharsCount = 0;
+
+		bool Add(char ch) TDE2_NOEXCEPT;
+		bool Contains(char ch) const TDE2_NOEXCEPT;
+	};
+
+
+	/*!
+		struct TScanKernels
+
+		\brief The structure contains a set of functions that search through a text buffer. All of them
+		start at pos and return text.size() if nothing is found
+	*/
+
+	struct TScanKernels
+	{
+		E_SCAN_KERNELS_TYPE mType;
+
+		size_t (*mpFindNewLine)(std::string_view text, size_t pos);               ///< Returns a position of the next '\n'
+		size_t (*mpFindCommentDelimiter)(std::string_view text, size_t pos);      ///< Returns a position of the next "/*" or "*/" pair
+		size_t (*mpFindIdentifierEnd)(std::string_view text, size_t pos);         ///< Returns a position of the first char that can't be a part of an identifier
+		size_t (*mpCountNewLines)(std::string_view text, size_t pos, size_t end); ///< Returns a number of '\n' within [pos; end)
+		size_t (*mpFindAnyOfChars)(std::string_view text, size_t pos, const TCharsSet& chars); ///< Returns a position of the next char from the set
+	};
+
+
+	bool IsScanKernelsTypeSupported(E_SCAN_KERNELS_TYPE type) TDE2_NOEXCEPT;
+
+	/*!
+		\brief The function returns kernels of the given type or the best supported ones if the CPU lacks
+		required instructions
+	*/
+
+	const TScanKernels& GetScanKernels(E_SCAN_KERNELS_TYPE type) TDE2_NOEXCEPT;
+
+	/*!
+		\brief The function returns the best kernels for the current CPU, the choice is made once
+	*/
+
+	const TScanKernels& GetScanKernels() TDE2_NOEXCEPT;
+
+	/*!
+		\brief The function returns a position of '\n' that finishes a preprocessor directive. Lines that
+		end with a backslash are continued
+	*/
+
+	size_t FindMacroDefinitionEnd(const TScanKernels& kernels, std::string_view text, size_t pos) TDE2_NOEXCEPT;
+
+	/*!
+		\brief The function returns a position right after END_IGNORE_META_SECTION keyword that closes an ignore section,
+		the search starts from pos. Comments, string and char literals and preprocessor directives are skipped.
+		The size of the text is returned if the section isn't closed
+	*/
+
+	size_t FindIgnoreSectionEnd(const TScanKernels& kernels, std::string_view text, size_t pos) TDE2_NOEXCEPT;
+
+	/*!
+		\brief The function returns a position right after '}' that closes a block opened at openBracePos. Braces
+		within comments, literals, preprocessor directives and ignore sections aren't counted. The size of the text is
+		returned if the block isn't closed
+	*/
+
+	size_t FindBalancedBlockEnd(const TScanKernels& kernels, std::string_view text, size_t openBracePos) TDE2_NOEXCEPT;
+}
@@ -6,7 +6,10 @@
 #include <vector>
 #include <unordered_map>
 #include <fstream>
+#include <string_view>
 #include "common.h"
+#include "atomtable.h"
+#include "memoryarena.h"
 
 
 template<typename T> class Archive;
@@ -28,6 +31,13 @@ namespace TDEngine2
 	};
 
 
+	/*!
+		struct TType
+
+		\brief The type is a tagged record, a subtype is stored as a field and all operations are dispatched with
+		a switch over it. Types have no virtual functions, so use TypeCast instead of dynamic_cast to get a subtype
+	*/
+
 	struct TType
 	{
 		enum class E_SUBTYPE: uint32_t
@@ -39,24 +49,31 @@ namespace TDEngine2
 			UNKNOWN
 		};
 
-		using UniquePtr = std::unique_ptr<TType>;
-		using Ptr       = std::shared_ptr<TType>;
-		using WeakPtr   = std::weak_ptr<TType>;
+		static constexpr E_SUBTYPE mSubtypeId = E_SUBTYPE::BASE;
 
-		virtual ~TType() = default;
+		TType() = default;
 
 		static bool SafeSerialize(FileWriterArchive& archive, TType* pType);
-		static std::unique_ptr<TType> Deserialize(FileReaderArchive& archive, SymTable* pSymTable = nullptr);
 
-		virtual bool Load(FileReaderArchive& archive);
-		virtual bool Save(FileWriterArchive& archive);
+		/*!
+			\brief The method reads a type from the archive, the type is created within the given arena
+		*/
+
+		static TType* Deserialize(FileReaderArchive& archive, MemoryArena& arena, SymTable* pSymTable = nullptr);
+
+		bool Load(FileReaderArchive& archive);
+		bool Save(FileWriterArchive& archive);
+
+		/*!
+			\brief The method calls a method of the visitor that corresponds to the type's subtype
+		*/
 
-		virtual void Visit(ITypeVisitor& visitor) const;
+		void Visit(ITypeVisitor& visitor) const;
 
-		virtual E_SUBTYPE GetSubtype() const { return E_SUBTYPE::BASE; }
+		E_SUBTYPE GetSubtype() const { return mSubtype; }
 
-		std::string mId;
-		std::string mMangledId; // \note contains full path to type Namespace..ClassName@Type
+		TAtom mId;
+		TAtom mMangledId; // \note contains full path to type Namespace..ClassName@Type
 
 		/*!
 			\brief The identifier works as module's name to group metadata into parts and export declarations partially
@@ -78,34 +95,31 @@ namespace TDEngine2
 
 		SymTable* mpOwner = nullptr;
 
-		WeakPtr mpParentType{};
+		const TType* mpParentType = nullptr;
 
 		E_ACCESS_SPECIFIER_TYPE mAccessModifier = E_ACCESS_SPECIFIER_TYPE::PUBLIC;
 
 		bool mIsMarkedWithAttribute = false;
+	protected:
+		explicit TType(E_SUBTYPE subtype) : mSubtype(subtype) {}
+	private:
+		E_SUBTYPE mSubtype = E_SUBTYPE::BASE;
 	};
 
 	
 	struct TNamespaceType : TType
 	{
-		virtual ~TNamespaceType() = default;
+		static constexpr E_SUBTYPE mSubtypeId = E_SUBTYPE::NAMESPACE;
 
-		void Visit(ITypeVisitor& visitor)  const override;
-
-		E_SUBTYPE GetSubtype() const override { return E_SUBTYPE::NAMESPACE; }
+		TNamespaceType() : TType(mSubtypeId) {}
 	};
 
 
 	struct TEnumType: TType
 	{
-		virtual ~TEnumType() = default;
-
-		bool Load(FileReaderArchive& archive) override;
-		bool Save(FileWriterArchive& archive) override;
-
-		void Visit(ITypeVisitor& visitor) const override;
+		static constexpr E_SUBTYPE mSubtypeId = E_SUBTYPE::ENUM;
 
-		E_SUBTYPE GetSubtype() const override { return E_SUBTYPE::ENUM; }
+		TEnumType() : TType(mSubtypeId) {}
 
 		bool                     mIsStronglyTyped = false;
 		bool                     mIsIntrospectable = false;
@@ -113,31 +127,24 @@ namespace TDEngine2
 
 		std::string              mUnderlyingTypeStr = "int";
 
-		std::vector<std::string> mEnumerators;
+		std::vector<TAtom>       mEnumerators;
 	};
 
 
 	struct TClassType : TType
 	{
-		using Ptr = std::shared_ptr<TClassType>;
-
 		struct TBaseClassInfo
 		{
-			std::string mFullName; /// Includes full path with namespaces 
+			TAtom mFullName; /// Includes full path with namespaces 
 
 			bool mIsVirtualInherited = false;
 			
 			E_ACCESS_SPECIFIER_TYPE mAccessSpecifier = E_ACCESS_SPECIFIER_TYPE::PRIVATE; // default access for classes is private as described in specification
 		};
 
-		virtual ~TClassType() = default;
-
-		bool Load(FileReaderArchive& archive) override;
-		bool Save(FileWriterArchive& archive) override;
-
-		void Visit(ITypeVisitor& visitor) const override;
+		static constexpr E_SUBTYPE mSubtypeId = E_SUBTYPE::CLASS;
 
-		E_SUBTYPE GetSubtype() const override { return E_SUBTYPE::CLASS; }
+		TClassType() : TType(mSubtypeId) {}
 
 		bool mIsFinal = false;
 		bool mIsStruct = false;
@@ -145,18 +152,35 @@ namespace TDEngine2
 		bool mIsTemplate = false;
 
 		std::vector<TBaseClassInfo> mBaseClasses;
-		std::vector<std::string>    mFields;
+		std::vector<TAtom>          mFields;
 	};
 
 
+	/*!
+		\brief The function returns a pointer to the given type's subtype T or nullptr if the type has another one
+	*/
+
+	template <typename T>
+	T* TypeCast(TType* pType) TDE2_NOEXCEPT
+	{
+		return (pType && (T::mSubtypeId == pType->GetSubtype())) ? static_cast<T*>(pType) : nullptr;
+	}
+
+	template <typename T>
+	const T* TypeCast(const TType* pType) TDE2_NOEXCEPT
+	{
+		return (pType && (T::mSubtypeId == pType->GetSubtype())) ? static_cast<const T*>(pType) : nullptr;
+	}
+
+
 	class ISymTableVisitor;
 
 
 	struct TSymbolDesc
 	{
-		std::string              mName;
+		TAtom                    mName;
 
-		TType::Ptr               mpType = nullptr;
+		TType*                   mpType = nullptr;
 
 		static const TSymbolDesc mInvalid;
 	};
@@ -168,24 +192,79 @@ namespace TDEngine2
 	class SymTable
 	{
 		public:
+			using TScopeIndex = uint32_t;
+
+			static constexpr TScopeIndex mInvalidScopeIndex = 0xFFFFFFFF;
+			static constexpr TScopeIndex mGlobalScopeIndex = 0;
+
+			static constexpr uint32_t mInvalidSymbolIndex = 0xFFFFFFFF;
+			static constexpr uint32_t mSymbolsIndexThreshold = 16;
+
+			static constexpr uint32_t mInvalidTypeSlotIndex = 0xFFFFFFFF;
+
+			/*!
+				\brief All scopes of a table are stored in a single array in order of their creation and refer to
+				each other by indices. So a pointer to a scope stays valid only until the next CreateScope call
+			*/
+
 			struct TScopeEntity
 			{
-				using Ptr = std::unique_ptr<TScopeEntity>;
+				struct TNamedScopeSlot
+				{
+					TAtom       mName;
+					TScopeIndex mIndex = mInvalidScopeIndex;
+				};
+
+				/*!
+					\brief The method returns an index of a named child scope or mInvalidScopeIndex if there is no one
+				*/
+
+				TScopeIndex FindNamedScope(const TAtom& name) const;
+
+				/*!
+					\brief The method returns false if there is already a child scope with the same name
+				*/
+
+				bool AddNamedScope(const TAtom& name, TScopeIndex index);
+
+				size_t GetNamedScopesCount() const { return mNamedScopesCount; }
+
+				/*!
+					\brief The method returns an index of a variable within mVariables or mInvalidSymbolIndex if there is no one.
+					Small scopes are scanned linearly, a hashed index is built once a scope has mSymbolsIndexThreshold variables
+				*/
+
+				uint32_t FindSymbol(const TAtom& name) const;
+
+				/*!
+					\brief The method appends a new variable or updates a type of the existing one with the same name
+				*/
+
+				void AddSymbol(TSymbolDesc&& desc);
+
+				TScopeIndex                  mParentIndex = mInvalidScopeIndex;
+
+				TAtom                        mName; // empty for anonymous scopes
+
+				std::vector<TScopeIndex>     mNestedScopes{}; ///< Anonymous child scopes in order of their creation
+
+				std::vector<TSymbolDesc>     mVariables{}; ///< Variables in order of their declaration
 
-				bool Save(FileWriterArchive& archive);
-				bool Load(FileReaderArchive& archive, SymTable* symTable);
+				mutable std::unordered_map<TAtom, uint32_t> mSymbolsIndex{}; ///< Maps names onto indices of mVariables, covers first mIndexedSymbolsCount of them
+				mutable uint32_t             mIndexedSymbolsCount = 0;
 
-				TScopeEntity*                        mpParentScope = nullptr;
+				int32_t                      mIndex = -1; // -1 for all named scopes
 
-				std::vector<Ptr>                     mpNestedScopes{};
+				TType*                       mpType = nullptr; // for anonymous scopes it's nullptr, assign it with SetScopeType to register the type in the table's index
 
-				std::unordered_map<std::string, Ptr> mpNamedScopes{};
+				uint32_t                     mTypeSlotIndex = mInvalidTypeSlotIndex; ///< Position of mpType within an array of types of the same subtype
 
-				std::vector<TSymbolDesc>             mVariables{};
+				TAtom                        mMangledPrefix; ///< Mangled name of the closest named ancestor with a type (including this scope), it's valid if mIsMangledPrefixCached is true
 
-				int32_t                              mIndex = -1; // -1 for all named scopes
+				bool                         mIsMangledPrefixCached = false;
 
-				TType::Ptr                           mpType = nullptr; // for anonymous scopes it's nullptr
+				std::vector<TNamedScopeSlot> mNamedScopesSlots{}; ///< Open addressing table of named child scopes
+				uint32_t                     mNamedScopesCount = 0;
 			};
 		public:
 			SymTable();
@@ -194,48 +273,129 @@ namespace TDEngine2
 			bool Save(FileWriterArchive& archive);
 			bool Load(FileReaderArchive& archive);
 
+			/*!
+				\brief The method writes the table into an image of the v2 cache format that is described in cacheformat.h.
+				Types that are shared between scopes and symbols are written once. The image is built in memory, so it's
+				written into a file with a single call
+			*/
+
+			std::string SaveImage(const std::string& optionsDigest) const;
+
+			/*!
+				\brief The method restores the table from an image that SaveImage produced. Records are read in place,
+				so the image is usually a mapped file. It isn't referenced after the call.
+
+				\return false if the image is damaged or it was built by another version of the tool or with other options
+			*/
+
+			bool LoadImage(std::string_view image, const std::string& optionsDigest);
+
+			/*!
+				\brief The method passes all scopes to the visitor in order of their creation
+			*/
+
 			void Visit(ISymTableVisitor& visitor);
 
-			bool CreateScope(const std::string& name = "");
-			bool EnterScope(const std::string& name = "");
+			bool CreateScope(const TAtom& name = {});
+			bool EnterScope(const TAtom& name = {});
 			void ExitScope();
 
 			void AddSymbol(TSymbolDesc&& desc);
-			bool RemoveSymbol(const std::string& id);
+			bool RemoveSymbol(const TAtom& id);
 
-			const TSymbolDesc& LookUpSymbol(const std::string& id) const;
+			const TSymbolDesc& LookUpSymbol(const TAtom& id) const;
 
-			TScopeEntity* LookUpNamedScope(const std::string& name);
+			TScopeEntity* LookUpNamedScope(const TAtom& name);
+
+			TScopeEntity* GetScope(TScopeIndex index);
 
 			void SetSourceFilename(const std::string& filename);
 
-			std::string GetMangledNameForNamedScope(const std::string& id);
+			TAtom GetMangledNameForNamedScope(const TAtom& id);
 
 			const std::string& GetSourceFilename() const;
 
-			TType::Ptr GetCurrScopeType() const;
-			TType::Ptr GetParentScopeType() const;
+			/*!
+				\brief The method marks the table of a file that was skipped because its parsing budget was exceeded. The mark is
+				saved with the table, so cached files aren't parsed again until they change
+			*/
+
+			void MarkAsSkipped() { mIsSkipped = true; }
+			bool IsSkipped() const { return mIsSkipped; }
+
+			TType* GetCurrScopeType() const;
+			TType* GetParentScopeType() const;
+
+			/*!
+				\brief The method assigns a type to the scope and registers enums and classes in arrays of the table.
+				A type that replaces a previous one of the same subtype (a definition after a forward declaration) takes its slot
+			*/
+
+			void SetScopeType(TScopeEntity& scope, TType* pType);
+
+			/*!
+				\brief The methods return all enums and classes of the table in order of their first declaration,
+				so extractors don't need to walk through scopes
+			*/
+
+			const std::vector<const TEnumType*>& GetEnums() const { return mpEnums; }
+			const std::vector<const TClassType*>& GetClasses() const { return mpClasses; }
+
+			/*!
+				\brief The method appends scopes and types of the given table as if they were declared after ones of this table.
+				Namespaces with the same names are reopened, a class could follow its own forward declaration, any other
+				collision of names makes the method to return false. In that case the table is left partially merged
+			*/
+
+			bool Merge(const SymTable& table);
+
+			/*!
+				\brief The method creates a type that belongs to the table, it lives until the table is destroyed or loaded again
+			*/
+
+			template <typename T>
+			T* CreateType()
+			{
+				T* pType = mArena.Create<T>();
+				pType->mpOwner = this;
+
+				return pType;
+			}
 		private:
 			void _reset();
 
+			TScopeIndex _addScope(TScopeIndex parentIndex, const TAtom& name);
+
 			bool _createAnonymousScope();
-			bool _createNamedScope(const std::string& name);
+			bool _createNamedScope(const TAtom& name);
 
 			bool _visitAnonymousScope();
-			bool _visitNamedScope(const std::string& name);
+			bool _visitNamedScope(const TAtom& name);
+
+			const TSymbolDesc& _lookUpInternal(const TAtom& id) const;
 
-			const TSymbolDesc& _lookUpInternal(const std::string& id) const;
+			const TAtom& _getMangledPrefix(TScopeIndex index);
+
+			TType* _cloneType(const TType* pType, std::unordered_map<const TType*, TType*>& typesMapping);
 		private:
-			TScopeEntity::Ptr mpGlobalScope;
-			TScopeEntity*     mpCurrScope;
-			TScopeEntity*     mpPrevScope;
+			static constexpr uint32_t mArchiveTag = 0x4D595355; ///< Marks serialized tables of the current layout, tables of another one are rejected by Load
+
+			MemoryArena               mArena; ///< Owns all types of the table
+
+			std::vector<TScopeEntity> mScopes;
 
-			bool          mIsReadOnlyMode = false; // \note It's set to true if EnterScope is used
+			std::vector<const TEnumType*>  mpEnums; ///< Slots of replaced types of another subtype are nullptr
+			std::vector<const TClassType*> mpClasses;
+			TScopeIndex               mCurrScopeIndex = mGlobalScopeIndex;
 
-			int32_t       mLastVisitedScopeIndex = -1;
-			int32_t       mPrevVisitedScopeIndex; ///< \note The field is only updated when visiting VisitNamedScope
+			bool                      mIsReadOnlyMode = false; // \note It's set to true if EnterScope is used
 
-			std::string   mSourceFilename;
+			int32_t                   mLastVisitedScopeIndex = -1;
+			int32_t                   mPrevVisitedScopeIndex; ///< \note The field is only updated when visiting VisitNamedScope
+
+			std::string               mSourceFilename;
+
+			bool                      mIsSkipped = false;
 	};
 
 
@@ -269,7 +429,6 @@ namespace TDEngine2
 			virtual ~ISymTableVisitor() = default;
 
 			virtual void VisitScope(const SymTable::TScopeEntity& scope) = 0;
-			virtual void VisitNamedScope(const SymTable::TScopeEntity& namedScope) = 0;
 	};
 
 
@@ -278,7 +437,7 @@ namespace TDEngine2
 	{
 		public:
 			using TTypesArray = std::vector<const Type*>;
-			using TTypesHashMap = std::unordered_map<std::string, uint32_t>; // key is a full name of an entity which is consists of mangled name like the following Name@..@TypeName
+			using TTypesHashMap = std::unordered_map<TAtom, uint32_t>; // key is a full name of an entity which is consists of mangled name like the following Name@..@TypeName
 		
 		public:
 			MetaExtractor(const E_EMIT_FLAGS& flags) :
@@ -290,34 +449,17 @@ namespace TDEngine2
 
 			void VisitScope(const SymTable::TScopeEntity& scope) override
 			{
-				for (auto&& pCurrScope : scope.mpNestedScopes)
-				{
-					VisitScope(*pCurrScope);
-				}
-
-				for (auto&& currNamedScope : scope.mpNamedScopes)
-				{
-					VisitNamedScope(*currNamedScope.second);
-				}
-			}
-
-			void VisitNamedScope(const SymTable::TScopeEntity& namedScope) override
-			{
-				if (TType* pScopeType = namedScope.mpType.get()) // \note this scope isn't namespace probably class, struct or enum
+				if (TType* pScopeType = scope.mpType) // \note this scope isn't anonymous probably class, struct or enum
 				{
 					pScopeType->Visit(*this);
 				}
+			}
 
-				for (auto&& pCurrScope : namedScope.mpNestedScopes)
-				{
-					VisitScope(*pCurrScope);
-				}
+			/*!
+				\brief The method passes types of the table that the extractor is interested in without walking through its scopes
+			*/
 
-				for (auto&& currNamedScope : namedScope.mpNamedScopes)
-				{
-					VisitNamedScope(*currNamedScope.second);
-				}
-			}
+			virtual void Extract(const SymTable& symTable) = 0;
 
 			void VisitBaseType(const TType& type) override {}
 			void VisitEnumType(const TEnumType& type) override {}
@@ -349,6 +491,8 @@ namespace TDEngine2
 			EnumsMetaExtractor(const E_EMIT_FLAGS& flags);
 			virtual ~EnumsMetaExtractor() = default;
 
+			void Extract(const SymTable& symTable) override;
+
 			void VisitEnumType(const TEnumType& type) override;
 		private:
 			EnumsMetaExtractor() = default;
@@ -365,6 +509,8 @@ namespace TDEngine2
 			ClassMetaExtractor(const E_EMIT_FLAGS& flags);
 			virtual ~ClassMetaExtractor() = default;
 
+			void Extract(const SymTable& symTable) override;
+
 			void VisitClassType(const TClassType& type) override;
 		private:
 			ClassMetaExtractor() = default;
@@ -4,6 +4,12 @@
 #include <cstdint>
 #include <tuple>
 #include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <array>
+#include <algorithm>
+#include <iterator>
 
 
 namespace TDEngine2
@@ -67,19 +73,335 @@ namespace TDEngine2
 	};
 
 
+	/*!
+		struct TToken
+
+		\brief The token doesn't own its lexeme, mValue is a view into the lexer's source buffer. So the
+		token is cheap to copy and stays valid while the input stream it was scanned from is alive.
+		Materialize mValue into std::string if it should be stored somewhere.
+
+		The token's position is its byte offset only, use LinesIndex to get its line and column
+	*/
+
 	struct TToken
 	{
 		using TCursorPos = std::tuple<uint32_t, uint32_t>;
 
+		static constexpr uint32_t mInvalidAtomId = 0xFFFFFFFF;
+		static constexpr uint32_t mInvalidOffset = 0xFFFFFFFF; ///< The token isn't placed anywhere within the text, its position is {0, 0}
+
 		TToken() = default;
-		TToken(E_TOKEN_TYPE type, const std::string& value = "", const TCursorPos & pos = {0, 0});
+		TToken(E_TOKEN_TYPE type, std::string_view value = {}, uint32_t offset = mInvalidOffset);
+
+		E_TOKEN_TYPE     mType = E_TOKEN_TYPE::TT_EOF;
+		bool             mIsValid = false;
+		uint32_t         mOffset = mInvalidOffset;   ///< Byte offset of the lexeme within the source buffer
+		uint32_t         mAtomId = mInvalidAtomId;   ///< An identifier of interned lexeme, mInvalidAtomId if it wasn't interned
+		std::string_view mValue;                     ///< The lexeme itself, its size is the token's length
+	};
+
+
+	/*!
+		struct TTokensArray
+
+		\brief The structure contains all tokens of a file in a structure-of-arrays form. It's filled with
+		Lexer::Tokenize in a single pass, so the parser could walk over it with a plain index. As TToken it
+		refers to the source text, which either belongs to the input stream or is taken over from the lexer
+	*/
+
+	struct TTokensArray
+	{
+		void Reserve(size_t tokensCount);
+		void Add(const TToken& token);
 
-		E_TOKEN_TYPE mType = E_TOKEN_TYPE::TT_EOF;
-		TCursorPos   mPos = { 0, 0 };
-		std::string  mValue = "";
-		bool         mIsValid = false;
+		/*!
+			\brief The method returns a token at the given index, the last token (EOF) is returned for
+			all indices outside of the array
+		*/
+
+		TToken GetToken(size_t index) const;
+
+		size_t GetSize() const { return mTypes.size(); }
+
+		std::unique_ptr<std::string> mpOwnedSourceText; ///< The text that was read by the lexer from a line oriented stream
+		std::string_view             mSourceText;
+
+		std::vector<E_TOKEN_TYPE> mTypes; ///< E_TOKEN_TYPE is 16 bits wide
+		std::vector<uint32_t>     mOffsets;
+		std::vector<uint32_t>     mLengths;
+		std::vector<uint32_t>     mAtomIds;
+	};
+
+
+	/*!
+		class LinesIndex
+
+		\brief The class maps offsets of tokens onto lines and columns. Starts of lines are found with a single
+		newline scan of the whole text when a position is requested for the first time, so files that don't
+		produce any diagnostics are never scanned for lines
+	*/
+
+	class LinesIndex
+	{
+		public:
+			LinesIndex() = default;
+			explicit LinesIndex(std::string_view text);
+
+			/*!
+				\brief The method returns a position right after the token's lexeme as a pair of a column and a line,
+				the latter starts from 1. Tokens with mInvalidOffset are placed at {0, 0}
+			*/
+
+			TToken::TCursorPos GetCursorPos(const TToken& token);
+		private:
+			void _build();
+		private:
+			std::string_view      mText;
+			std::vector<uint32_t> mLinesStarts; ///< Stays empty until the first request
 	};
 
 
 	std::string TokenTypeToString(const E_TOKEN_TYPE& type);
+
+
+	struct TReservedTokenEntry
+	{
+		std::string_view mValue;
+		E_TOKEN_TYPE     mType;
+	};
+
+
+	/*!
+		\brief The list is the only place where reserved words are declared, both the lexer and the tests use it
+	*/
+
+	constexpr TReservedTokenEntry ReservedKeywords[]
+	{
+		{ "namespace", E_TOKEN_TYPE::TT_NAMESPACE },
+		{ "enum", E_TOKEN_TYPE::TT_ENUM },
+		{ "class", E_TOKEN_TYPE::TT_CLASS },
+		{ "struct", E_TOKEN_TYPE::TT_STRUCT },
+		{ "public", E_TOKEN_TYPE::TT_PUBLIC },
+		{ "protected", E_TOKEN_TYPE::TT_PROTECTED },
+		{ "private", E_TOKEN_TYPE::TT_PRIVATE },
+		{ "virtual", E_TOKEN_TYPE::TT_VIRTUAL },
+		{ "override", E_TOKEN_TYPE::TT_OVERRIDE },
+		{ "final", E_TOKEN_TYPE::TT_FINAL },
+		{ "template", E_TOKEN_TYPE::TT_TEMPLATE },
+		{ "ENUM_META", E_TOKEN_TYPE::TT_ENUM_META_ATTRIBUTE },
+		{ "CLASS_META", E_TOKEN_TYPE::TT_CLASS_META_ATTRIBUTE },
+		{ "INTERFACE_META", E_TOKEN_TYPE::TT_INTERFACE_META_ATTRIBUTE },
+		{ "BEGIN_IGNORE_META_SECTION", E_TOKEN_TYPE::TT_BEGIN_IGNORE_SECTION },
+		{ "END_IGNORE_META_SECTION", E_TOKEN_TYPE::TT_END_IGNORE_SECTION },
+		{ "SECTION", E_TOKEN_TYPE::TT_SECTION },
+		{ "char", E_TOKEN_TYPE::TT_CHAR },
+		{ "char16_t", E_TOKEN_TYPE::TT_CHAR16_T },
+		{ "char32_t", E_TOKEN_TYPE::TT_CHAR32_T },
+		{ "wchar_t", E_TOKEN_TYPE::TT_WCHAR_T },
+		{ "bool", E_TOKEN_TYPE::TT_BOOL },
+		{ "short", E_TOKEN_TYPE::TT_SHORT },
+		{ "int", E_TOKEN_TYPE::TT_INT },
+		{ "long", E_TOKEN_TYPE::TT_LONG },
+		{ "signed", E_TOKEN_TYPE::TT_SIGNED },
+		{ "unsigned", E_TOKEN_TYPE::TT_UNSIGNED },
+		{ "float", E_TOKEN_TYPE::TT_FLOAT },
+		{ "double", E_TOKEN_TYPE::TT_DOUBLE },
+		{ "void", E_TOKEN_TYPE::TT_VOID },
+		{ "auto", E_TOKEN_TYPE::TT_AUTO },
+		{ "decltype", E_TOKEN_TYPE::TT_DECLTYPE },
+		{ "typedef", E_TOKEN_TYPE::TT_TYPEDEF },
+	};
+
+	constexpr TReservedTokenEntry ReservedSymbols[]
+	{
+		{ "{", E_TOKEN_TYPE::TT_OPEN_BRACE },
+		{ "}", E_TOKEN_TYPE::TT_CLOSE_BRACE },
+		{ "(", E_TOKEN_TYPE::TT_OPEN_PARENTHES },
+		{ ")", E_TOKEN_TYPE::TT_CLOSE_PARENTHES },
+		{ ":", E_TOKEN_TYPE::TT_COLON },
+		{ ";", E_TOKEN_TYPE::TT_SEMICOLON },
+		{ "=", E_TOKEN_TYPE::TT_ASSIGN_OP },
+		{ ",", E_TOKEN_TYPE::TT_COMMA },
+		{ "<", E_TOKEN_TYPE::TT_LESS },
+		{ ">", E_TOKEN_TYPE::TT_GREAT },
+	};
+
+
+	namespace Keywords
+	{
+		constexpr uint32_t mHashTableBits = 7;
+		constexpr uint32_t mHashTableSize = 1 << mHashTableBits;
+
+		/*!
+			\brief The seed was picked to make the hash collision free over ReservedKeywords, see the static_assert below.
+			Update it if the list is changed
+		*/
+
+		constexpr uint32_t mHashSeed = 0x811C9DE5;
+
+		/*!
+			\brief FNV-1a over the first, the middle and the last characters and the length of the word
+		*/
+
+		constexpr uint32_t Hash(std::string_view value)
+		{
+			uint32_t hash = mHashSeed;
+
+			const uint32_t keys[] 
+			{ 
+				static_cast<uint8_t>(value[0]), 
+				static_cast<uint8_t>(value[value.size() / 2]), 
+				static_cast<uint8_t>(value[value.size() - 1]), 
+				static_cast<uint32_t>(value.size()) 
+			};
+
+			for (const uint32_t currKey : keys)
+			{
+				hash = (hash ^ currKey) * 16777619u;
+			}
+
+			return hash >> (32 - mHashTableBits);
+		}
+
+		constexpr size_t GetMinKeywordLength()
+		{
+			size_t length = ReservedKeywords[0].mValue.size();
+
+			for (auto&& currEntry : ReservedKeywords)
+			{
+				length = (std::min)(length, currEntry.mValue.size());
+			}
+
+			return length;
+		}
+
+		constexpr size_t GetMaxKeywordLength()
+		{
+			size_t length = 0;
+
+			for (auto&& currEntry : ReservedKeywords)
+			{
+				length = (std::max)(length, currEntry.mValue.size());
+			}
+
+			return length;
+		}
+
+		constexpr size_t mMinKeywordLength = GetMinKeywordLength();
+		constexpr size_t mMaxKeywordLength = GetMaxKeywordLength();
+
+		/*!
+			\brief The table stores indices of ReservedKeywords' entries increased by one, zero marks an empty slot
+		*/
+
+		using TKeywordsHashTable = std::array<uint8_t, mHashTableSize>;
+
+		constexpr TKeywordsHashTable BuildKeywordsHashTable()
+		{
+			TKeywordsHashTable table{};
+
+			for (size_t i = 0; i < std::size(ReservedKeywords); ++i)
+			{
+				table[Hash(ReservedKeywords[i].mValue)] = static_cast<uint8_t>(i + 1);
+			}
+
+			return table;
+		}
+
+		constexpr TKeywordsHashTable mKeywordsHashTable = BuildKeywordsHashTable();
+
+		constexpr bool IsHashCollisionFree()
+		{
+			size_t usedSlotsCount = 0;
+
+			for (const uint8_t currSlot : mKeywordsHashTable)
+			{
+				usedSlotsCount += (currSlot ? 1 : 0);
+			}
+
+			return usedSlotsCount == std::size(ReservedKeywords);
+		}
+
+		static_assert(std::size(ReservedKeywords) < 256, "Keywords hash table stores 8 bit indices");
+		static_assert(IsHashCollisionFree(), "Keywords hash collides, pick another mHashSeed");
+
+
+		using TSymbolsTable = std::array<E_TOKEN_TYPE, 256>;
+
+		constexpr TSymbolsTable BuildSymbolsTable()
+		{
+			TSymbolsTable table{};
+
+			for (auto& currSlot : table)
+			{
+				currSlot = E_TOKEN_TYPE::TT_UNKNOWN;
+			}
+
+			for (auto&& currEntry : ReservedSymbols)
+			{
+				table[static_cast<uint8_t>(currEntry.mValue[0])] = currEntry.mType;
+			}
+
+			return table;
+		}
+
+		constexpr TSymbolsTable mSymbolsTable = BuildSymbolsTable();
+	}
+
+
+	/*!
+		\brief The function returns a type of a keyword if the given identifier is reserved, TT_IDENTIFIER otherwise
+	*/
+
+	constexpr E_TOKEN_TYPE GetKeywordTokenType(std::string_view identifier)
+	{
+		if (identifier.size() < Keywords::mMinKeywordLength || identifier.size() > Keywords::mMaxKeywordLength)
+		{
+			return E_TOKEN_TYPE::TT_IDENTIFIER;
+		}
+
+		const uint8_t slot = Keywords::mKeywordsHashTable[Keywords::Hash(identifier)];
+		if (!slot || ReservedKeywords[slot - 1].mValue != identifier)
+		{
+			return E_TOKEN_TYPE::TT_IDENTIFIER;
+		}
+
+		return ReservedKeywords[slot - 1].mType;
+	}
+
+
+	/*!
+		\brief The function returns a type of a single character punctuator, TT_UNKNOWN if the character isn't one of them
+	*/
+
+	constexpr E_TOKEN_TYPE GetSymbolTokenType(char ch)
+	{
+		return Keywords::mSymbolsTable[static_cast<uint8_t>(ch)];
+	}
+
+
+	/*!
+		\brief The function returns a spelling of the given keyword, an empty string if the type isn't a keyword
+	*/
+
+	constexpr std::string_view GetKeywordValue(E_TOKEN_TYPE type)
+	{
+		for (auto&& currEntry : ReservedKeywords)
+		{
+			if (currEntry.mType == type)
+			{
+				return currEntry.mValue;
+			}
+		}
+
+		return {};
+	}
+
+
+	static_assert(GetKeywordTokenType("BEGIN_IGNORE_META_SECTION") == E_TOKEN_TYPE::TT_BEGIN_IGNORE_SECTION);
+	static_assert(GetKeywordTokenType("CLASS_META") == E_TOKEN_TYPE::TT_CLASS_META_ATTRIBUTE);
+	static_assert(GetKeywordTokenType("classes") == E_TOKEN_TYPE::TT_IDENTIFIER);
+	static_assert(GetSymbolTokenType('{') == E_TOKEN_TYPE::TT_OPEN_BRACE);
+	static_assert(GetSymbolTokenType('a') == E_TOKEN_TYPE::TT_UNKNOWN);
+	static_assert(GetKeywordValue(E_TOKEN_TYPE::TT_ENUM_META_ATTRIBUTE) == "ENUM_META");
 }
\ No newline at end of file
@@ -0,0 +1,171 @@
+#include "../include/atomtable.h"
+#include <cassert>
+#include <atomic>
+
+
+namespace TDEngine2
+{
+	namespace
+	{
+		/*!
+			\brief The cache keeps recently interned atoms of the current thread. Identifiers repeat a lot within
+			a header, so most of lookups are done without taking a shard's lock
+		*/
+
+		struct TThreadLocalAtomsCache
+		{
+			static constexpr size_t mEntriesCount = 1024;
+
+			std::array<uint32_t, mEntriesCount> mAtomIds;
+
+			uint64_t                            mOwnerUid = 0;
+
+			uint32_t& GetEntry(uint64_t tableUid, size_t hash)
+			{
+				if (mOwnerUid != tableUid) // \note Ids of another table are meaningless for this one
+				{
+					mAtomIds.fill(AtomTable::mEmptyAtomId);
+					mOwnerUid = tableUid;
+				}
+
+				return mAtomIds[hash & (mEntriesCount - 1)];
+			}
+		};
+
+
+		thread_local TThreadLocalAtomsCache AtomsCache;
+
+
+		std::atomic<uint64_t> NextAtomTableUid { 1 };
+	}
+
+
+	AtomTable::AtomTable():
+		mUid(NextAtomTableUid++)
+	{
+		for (auto& pShard : mpShards)
+		{
+			pShard = std::make_unique<TShard>();
+		}
+
+		/// \note The empty string occupies the first entry of the first shard, so its id is always mEmptyAtomId
+		TShard& firstShard = *mpShards[0];
+
+		firstShard.mpBlocks[0] = std::make_unique<TEntry[]>(mEntriesPerBlock);
+		firstShard.mpBlocks[0][0].mHash = std::hash<std::string_view>{}("");
+		firstShard.mEntriesCount = 1;
+	}
+
+	uint32_t AtomTable::Intern(std::string_view value)
+	{
+		if (value.empty())
+		{
+			return mEmptyAtomId;
+		}
+
+		const size_t hash = std::hash<std::string_view>{}(value);
+
+		uint32_t& cachedAtomId = AtomsCache.GetEntry(mUid, hash);
+		if (mEmptyAtomId != cachedAtomId)
+		{
+			const TEntry& cachedEntry = _getEntry(cachedAtomId);
+
+			if (cachedEntry.mHash == hash && cachedEntry.mValue == value)
+			{
+				return cachedAtomId;
+			}
+		}
+
+		const uint32_t shardIndex = static_cast<uint32_t>(hash & (mShardsCount - 1));
+		TShard& shard = *mpShards[shardIndex];
+
+		std::lock_guard<std::mutex> lock(shard.mMutex);
+
+		auto it = shard.mIndices.find({ value, hash });
+		if (it != shard.mIndices.cend())
+		{
+			return (cachedAtomId = it->second);
+		}
+
+		const uint32_t entryIndex = shard.mEntriesCount;
+		const uint32_t blockIndex = entryIndex >> mEntriesPerBlockLog2;
+
+		assert(blockIndex < mMaxBlocksPerShard);
+
+		auto& pBlock = shard.mpBlocks[blockIndex];
+		if (!pBlock)
+		{
+			pBlock = std::make_unique<TEntry[]>(mEntriesPerBlock);
+		}
+
+		TEntry& entry = pBlock[entryIndex & (mEntriesPerBlock - 1)];
+		entry.mValue = value;
+		entry.mHash = hash;
+
+		++shard.mEntriesCount;
+
+		const uint32_t atomId = (entryIndex << mShardsCountLog2) | shardIndex;
+
+		shard.mIndices.emplace(TKey{ entry.mValue, hash }, atomId); // \note The key refers to the entry's storage that never moves
+
+		return (cachedAtomId = atomId);
+	}
+
+	const std::string& AtomTable::GetString(uint32_t id) const TDE2_NOEXCEPT
+	{
+		return _getEntry(id).mValue;
+	}
+
+	size_t AtomTable::GetHash(uint32_t id) const TDE2_NOEXCEPT
+	{
+		return _getEntry(id).mHash;
+	}
+
+	AtomTable& AtomTable::Get()
+	{
+		static AtomTable atomTable;
+		return atomTable;
+	}
+
+	const AtomTable::TEntry& AtomTable::_getEntry(uint32_t id) const TDE2_NOEXCEPT
+	{
+		const TShard& shard = *mpShards[id & (mShardsCount - 1)];
+		const uint32_t entryIndex = id >> mShardsCountLog2;
+
+		return shard.mpBlocks[entryIndex >> mEntriesPerBlockLog2][entryIndex & (mEntriesPerBlock - 1)];
+	}
+
+
+	TAtom::TAtom(std::string_view value):
+		mId(AtomTable::Get().Intern(value))
+	{
+	}
+
+	TAtom::TAtom(const std::string& value):
+		TAtom(std::string_view{ value })
+	{
+	}
+
+	TAtom::TAtom(const char* pValue):
+		TAtom(std::string_view{ pValue ? pValue : "" })
+	{
+	}
+
+	TAtom TAtom::FromId(uint32_t id) TDE2_NOEXCEPT
+	{
+		TAtom atom;
+		atom.mId = id;
+
+		return atom;
+	}
+
+	const std::string& TAtom::GetString() const TDE2_NOEXCEPT
+	{
+		return AtomTable::Get().GetString(mId);
+	}
+
+	size_t TAtom::GetHash() const TDE2_NOEXCEPT
+	{
+		return AtomTable::Get().GetHash(mId);
+	}
+}
@@ -0,0 +1,90 @@
+#include "../include/cacheformat.h"
+#include <cstring>
+
+
+namespace TDEngine2
+{
+	namespace CacheFormat
+	{
+		static_assert(sizeof(THeader) % sizeof(uint32_t) == 0 && sizeof(TScopeRecord) == 7 * sizeof(uint32_t) && sizeof(TTypeRecord) == 12 * sizeof(uint32_t) &&
+					  sizeof(TIndexHeader) == 6 * sizeof(uint32_t) && sizeof(TIndexEntryRecord) == 18 * sizeof(uint32_t),
+					  "Records of the cache format should consist of 32-bit words without any padding");
+
+
+		TLayout GetLayout(const THeader& header)
+		{
+			TLayout layout;
+
+			layout.mStringsOffset     = sizeof(THeader);
+			layout.mScopesOffset      = layout.mStringsOffset + static_cast<size_t>(header.mStringsCount) * sizeof(TStringRecord);
+			layout.mSymbolsOffset     = layout.mScopesOffset + static_cast<size_t>(header.mScopesCount) * sizeof(TScopeRecord);
+			layout.mTypesOffset       = layout.mSymbolsOffset + static_cast<size_t>(header.mSymbolsCount) * sizeof(TSymbolRecord);
+			layout.mAtomsOffset       = layout.mTypesOffset + static_cast<size_t>(header.mTypesCount) * sizeof(TTypeRecord);
+			layout.mBaseClassesOffset = layout.mAtomsOffset + static_cast<size_t>(header.mAtomsCount) * sizeof(TAtomRecord);
+			layout.mStringsDataOffset = layout.mBaseClassesOffset + static_cast<size_t>(header.mBaseClassesCount) * sizeof(TBaseClassRecord);
+			layout.mSize              = layout.mStringsDataOffset + header.mStringsDataSize;
+
+			return layout;
+		}
+
+		namespace
+		{
+			bool HasHeader(std::string_view data, uint32_t magic, size_t headerSize)
+			{
+				if (data.size() < headerSize)
+				{
+					return false;
+				}
+
+				uint32_t words[2];
+				memcpy(words, data.data(), sizeof(words));
+				SwapWordsIfBigEndian(words, 2);
+
+				return (magic == words[0]) && (mVersion == words[1]);
+			}
+		}
+
+
+		bool IsImage(std::string_view data)
+		{
+			return HasHeader(data, mMagic, sizeof(THeader));
+		}
+
+		bool IsIndex(std::string_view data)
+		{
+			return HasHeader(data, mIndexMagic, sizeof(TIndexHeader));
+		}
+
+		uint64_t ComputeOptionsDigestHash(std::string_view optionsDigest)
+		{
+			uint64_t hash = 14695981039346656037ull;
+
+			for (const char ch : optionsDigest)
+			{
+				hash = (hash ^ static_cast<uint8_t>(ch)) * 1099511628211ull;
+			}
+
+			return hash;
+		}
+
+		bool IsLittleEndianHost()
+		{
+			static const uint16_t endiannessTest = 1;
+			return *reinterpret_cast<const uint8_t*>(&endiannessTest) == 1;
+		}
+
+		void SwapWordsIfBigEndian(uint32_t* pWords, size_t wordsCount)
+		{
+			if (IsLittleEndianHost())
+			{
+				return;
+			}
+
+			for (size_t i = 0; i < wordsCount; ++i)
+			{
+				const uint32_t value = pWords[i];
+				pWords[i] = (value >> 24) | ((value >> 8) & 0xFF00) | ((value << 8) & 0xFF0000) | (value << 24);
+			}
+		}
+	}
+}
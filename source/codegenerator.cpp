@@ -153,8 +153,8 @@ template<> struct Type<TYPEID({0})> { using Value = {0}; }; /// {0}
 				continue;
 			}
 
-			pCurrSymbolTable->Visit(enumsExtractor);
-			pCurrSymbolTable->Visit(classesExtractor);
+			enumsExtractor.Extract(*pCurrSymbolTable);
+			classesExtractor.Extract(*pCurrSymbolTable);
 		}
 
 		std::string dependenciesInclusionsStr = WriteInclusions(enumsExtractor);
@@ -176,13 +176,13 @@ template<> struct Type<TYPEID({0})> { using Value = {0}; }; /// {0}
 	void CodeGenerator::VisitEnumType(const TEnumType& type)
 	{
 		if (type.mIsForwardDeclaration ||
-			_shouldSkipGeneration(type.mId) || 
+			_shouldSkipGeneration(type.mId.GetString()) || 
 			(mIsTaggedOnlyMode && !type.mIsMarkedWithAttribute)) // \note skip forward declarations to prevent duplicates of traits of the same type
 		{
 			return;
 		}
 
-		std::string fullEnumName = "::" + Wrench::StringUtils::ReplaceAll(type.mMangledId, "@", "::");
+		std::string fullEnumName = "::" + Wrench::StringUtils::ReplaceAll(type.mMangledId.GetString(), "@", "::");
 
 		size_t enumeratorsCount = type.mEnumerators.size();
 
@@ -192,7 +192,7 @@ template<> struct Type<TYPEID({0})> { using Value = {0}; }; /// {0}
 
 		for (size_t i = 0; i < enumeratorsCount; ++i)
 		{
-			auto&& currEnumerator = enumerators[i];
+			auto&& currEnumerator = enumerators[i].GetString();
 
 			fieldsStr
 				.append(Wrench::StringUtils::Format(mEnumeratorFieldPattern, fullEnumName, fullEnumName + "::" + currEnumerator, currEnumerator))
@@ -221,13 +221,13 @@ template<> struct Type<TYPEID({0})> { using Value = {0}; }; /// {0}
 	{
 		if (type.mIsForwardDeclaration ||
 			type.mIsTemplate ||
-			_shouldSkipGeneration(type.mId) ||
+			_shouldSkipGeneration(type.mId.GetString()) ||
 			(mIsTaggedOnlyMode && !type.mIsMarkedWithAttribute)) // \note skip forward declarations to prevent duplicates of traits of the same type
 		{
 			return;
 		}
 
-		std::string fullClassIdentifier = "::" + Wrench::StringUtils::ReplaceAll(type.mMangledId, "@", "::");
+		std::string fullClassIdentifier = "::" + Wrench::StringUtils::ReplaceAll(type.mMangledId.GetString(), "@", "::");
 
 		auto&& parentClasses = _getParentClasses(type);
 
@@ -238,7 +238,7 @@ template<> struct Type<TYPEID({0})> { using Value = {0}; }; /// {0}
 		for (size_t i = 0; i < fieldsCount; ++i)
 		{
 			fieldsStr
-				.append(Wrench::StringUtils::Format(mClassTypeFieldPattern, fullClassIdentifier, type.mFields[i]))
+				.append(Wrench::StringUtils::Format(mClassTypeFieldPattern, fullClassIdentifier, type.mFields[i].GetString()))
 				.append(i + 1 < fieldsCount ? "," : Wrench::StringUtils::GetEmptyStr()).append("\n\t\t");
 		}
 
@@ -266,7 +266,7 @@ template<> struct Type<TYPEID({0})> { using Value = {0}; }; /// {0}
 
 		for (auto&& currBaseClassInfo : classType.mBaseClasses)
 		{
-			parentClasses.push_back(Wrench::StringUtils::Format("TYPEID({0})", currBaseClassInfo.mFullName));
+			parentClasses.push_back(Wrench::StringUtils::Format("TYPEID({0})", currBaseClassInfo.mFullName.GetString()));
 		}
 
 		return parentClasses;
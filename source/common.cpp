@@ -2,6 +2,11 @@
 #include "../include/lexer.h"
 #include "../include/parser.h"
 #include "../include/symtable.h"
+#include "../include/prefilter.h"
+#include "../include/jobmanager.h"
+#include "../include/parsingbudget.h"
+#include "../include/cacheformat.h"
+#include "../include/fingerprint.h"
 #include "../deps/argparse/argparse.h"
 #include "../deps/PicoSHA2/picosha2.h"
 #include "../deps/archive/archive.h"
@@ -10,10 +15,15 @@
 #include <iostream>
 #include <fstream>
 #include <array>
+#include <algorithm>
 #include <mutex>
 #include <unordered_set>
 #include <string>
 #include <cstring>
+#include <cctype>
+#include <chrono>
+#include <atomic>
+#include <iterator>
 
 #include <experimental/filesystem>
 namespace fs = std::experimental::filesystem;
@@ -35,11 +45,17 @@ namespace TDEngine2
 	{
 		int showVersion = 0;
 		int numOfThreads = 1;
+		int parallelParsingThreshold = static_cast<int>(TIntrospectorOptions{}.mParallelParsingThreshold);
+		int maxTokensPerFile = 0;
+		int maxParsingTimePerFile = 0;
+		int cacheSizeLimit = 0;
+		int cacheMaxAge = 0;
 
 		// flags
 		int taggedOnly = 0;
 		int suppressLogOutput = 0;
 		int forceMode = 0;
+		int cacheGCMode = 0;
 		int emitFlags = 0;
 
 		const char* pOutputDirectory = nullptr;
@@ -55,11 +71,18 @@ namespace TDEngine2
 			OPT_BOOLEAN('V', "version", &showVersion, "Print version info and exit"),
 			OPT_STRING('O', "outdir", &pOutputDirectory, "Write output into specified <dirname>"),
 			OPT_STRING('o', "outfile", &pOutputFilename, "Output file's name <filename>"),
-			OPT_STRING('C', "cache-dir", &pOutputFilename, "All cache files will be written into the specified <dirname>"),
+			OPT_STRING('C', "cache-dir", &pCacheOutputDirectory, "All cache files will be written into the specified <dirname>"),
 			OPT_INTEGER('T', "num-threads", &numOfThreads, "A number of available threads to process a few header files simultaneously"),
+			OPT_INTEGER(0, "parallel-parsing-threshold", &parallelParsingThreshold, "Headers of the given size in bytes or larger are parsed with all available threads, 0 disables it"),
+			OPT_INTEGER(0, "max-tokens-per-file", &maxTokensPerFile, "Files that contain more tokens are skipped, 0 means there is no limit"),
+			OPT_INTEGER(0, "max-parsing-time", &maxParsingTimePerFile, "Files that take more milliseconds to be parsed are skipped, 0 means there is no limit"),
 			OPT_BOOLEAN('t', "tagged-only", &taggedOnly, "The flag enables a mode when only tagged with corresponding attributes types will be passed into output file"),
 			OPT_BOOLEAN('q', "quiet", &suppressLogOutput, "Enables suppresion of program's output"),
 			OPT_BOOLEAN('F', "force", &forceMode, "Enables force mode for the utility, all cached data will be ignored"),
+			OPT_GROUP("Cache options"),
+			OPT_INTEGER(0, "cache-size-limit", &cacheSizeLimit, "Least recently used tables are evicted once the cache is larger than the given size in megabytes, 0 means there is no limit"),
+			OPT_INTEGER(0, "cache-max-age", &cacheMaxAge, "Tables that weren't used for the given number of days are evicted, 0 means there is no limit"),
+			OPT_BOOLEAN(0, "cache-gc", &cacheGCMode, "Only collects garbage within the cache according to its limits and exits"),
 			OPT_GROUP("Code generation options"),
 			OPT_BIT(0, "emit-enums", &emitFlags, "Enables code generation for enumerations", NULL, static_cast<int>(E_EMIT_FLAGS::ENUMS), OPT_NONEG),
 			OPT_BIT(0, "emit-classes", &emitFlags, "Enables code generation for classes", NULL, static_cast<int>(E_EMIT_FLAGS::CLASSES), OPT_NONEG),
@@ -86,6 +109,7 @@ namespace TDEngine2
 		utilityOptions.mIsTaggedOnlyModeEnabled = static_cast<bool>(taggedOnly);
 		utilityOptions.mIsLogOutputEnabled = !static_cast<bool>(suppressLogOutput);
 		utilityOptions.mIsForceModeEnabled = static_cast<bool>(forceMode);
+		utilityOptions.mIsCacheGCModeEnabled = static_cast<bool>(cacheGCMode);
 
 		// \note parse input files before any option, because argparse library will remove all argv's values after it processes that
 		if (argc >= 1)
@@ -118,6 +142,12 @@ namespace TDEngine2
 		if (pCacheOutputDirectory)
 		{
 			utilityOptions.mCacheDirname = pCacheOutputDirectory;
+
+			/// \note Names of cache files are appended to the directory's one
+			if (!utilityOptions.mCacheDirname.empty() && utilityOptions.mCacheDirname.back() != '/' && utilityOptions.mCacheDirname.back() != '\\')
+			{
+				utilityOptions.mCacheDirname.push_back('/');
+			}
 		}
 
 		if (numOfThreads <= 0 || numOfThreads > (std::numeric_limits<int>::max() / 2))
@@ -129,6 +159,32 @@ namespace TDEngine2
 		utilityOptions.mCurrNumOfThreads = static_cast<uint16_t>(numOfThreads);
 		utilityOptions.mEmitFlags = static_cast<E_EMIT_FLAGS>(emitFlags);
 
+		if (parallelParsingThreshold < 0)
+		{
+			std::cerr << "Error: negative parallel parsing threshold was specified\n";
+			std::terminate();
+		}
+
+		utilityOptions.mParallelParsingThreshold = static_cast<uint32_t>(parallelParsingThreshold);
+
+		if (maxTokensPerFile < 0 || maxParsingTimePerFile < 0)
+		{
+			std::cerr << "Error: negative budget per file was specified\n";
+			std::terminate();
+		}
+
+		utilityOptions.mMaxTokensPerFile = static_cast<uint32_t>(maxTokensPerFile);
+		utilityOptions.mMaxParsingTimePerFile = static_cast<uint32_t>(maxParsingTimePerFile);
+
+		if (cacheSizeLimit < 0 || cacheMaxAge < 0)
+		{
+			std::cerr << "Error: negative limit of the cache was specified\n";
+			std::terminate();
+		}
+
+		utilityOptions.mCacheSizeLimit = static_cast<uint32_t>(cacheSizeLimit);
+		utilityOptions.mCacheMaxAge = static_cast<uint32_t>(cacheMaxAge);
+
 		if (pExcludedPathsStr)
 		{
 			utilityOptions.mPathsToExclude = Wrench::StringUtils::Split(std::string(pExcludedPathsStr), ";");
@@ -136,16 +192,20 @@ namespace TDEngine2
 
 		utilityOptions.mPathsToExclude.push_back(utilityOptions.mOutputFilename);
 		
+		std::vector<std::string> typenamesPatternsToExclude;
+
 		if (pExcludedTypenamesStr)
 		{
-			auto&& patterns = Wrench::StringUtils::Split(std::string(pExcludedTypenamesStr), ";");
+			typenamesPatternsToExclude = Wrench::StringUtils::Split(std::string(pExcludedTypenamesStr), ";");
 
-			for (auto&& currPatternStr : patterns)
+			for (auto&& currPatternStr : typenamesPatternsToExclude)
 			{
 				utilityOptions.mTypenamesPatternsToExclude.emplace_back(currPatternStr);
 			}
 		}
 
+		utilityOptions.mpTypesFilter = std::make_shared<const TypesFilter>(utilityOptions.mEmitFlags, typenamesPatternsToExclude);
+
 		return std::move(utilityOptions);
 	}
 
@@ -229,11 +289,89 @@ namespace TDEngine2
 		std::cout << text;
 	}
 
+	namespace
+	{
+		/*!
+			\brief The function splits a large file into chunks at top level declarations and parses them concurrently,
+			then partial tables are merged in order of the source. Nullptr is returned if the file isn't large enough
+			or chunks couldn't be parsed apart from each other, in that case the whole file is parsed sequentially
+		*/
+
+		std::unique_ptr<SymTable> ParseTokensConcurrently(const TIntrospectorOptions& options, const TTokensArray& tokens, const Parser::TOnErrorCallback& onErrorCallback)
+		{
+			constexpr size_t MinChunkTokensCount = 16 * 1024;
+
+			const size_t threadsCount = options.mCurrNumOfThreads;
+
+			if (threadsCount < 2 || !options.mParallelParsingThreshold || tokens.mSourceText.size() < options.mParallelParsingThreshold)
+			{
+				return nullptr;
+			}
+
+			const std::vector<TDeclarationsChunk> chunks = SplitIntoDeclarationsChunks(tokens, (std::max)(MinChunkTokensCount, tokens.GetSize() / (threadsCount * 4)));
+			if (chunks.size() < 2)
+			{
+				return nullptr;
+			}
+
+			struct TChunkResult
+			{
+				SymTable                  mSymTable;
+				std::vector<TParserError> mErrors; ///< Errors are reported after merging, the parse could be discarded yet
+				bool                      mIsParsed = false;
+			};
+
+			std::vector<TChunkResult> results(chunks.size());
+
+			{
+				JobManager jobManager(static_cast<uint32_t>((std::min)(threadsCount, chunks.size()))); // \note Waits for all chunks at the end of the scope
+
+				for (size_t i = 0; i < chunks.size(); ++i)
+				{
+					jobManager.SubmitJob(std::function<void()>([&tokens, &chunks, &results, &options, i]
+					{
+						TChunkResult& result = results[i];
+
+						Parser parser{ tokens, result.mSymTable, options, [&result](auto&& error) { result.mErrors.push_back(error); } };
+						result.mIsParsed = parser.ParseChunk(chunks[i], i + 1 == chunks.size());
+					}));
+				}
+			}
+
+			/// \note An error could change the way the rest of the file is parsed, so only the last chunk is allowed to have them
+			for (size_t i = 0; i < results.size(); ++i)
+			{
+				if (!results[i].mIsParsed || (i + 1 < results.size() && !results[i].mErrors.empty()))
+				{
+					return nullptr;
+				}
+			}
+
+			std::unique_ptr<SymTable> pSymTable = std::make_unique<SymTable>();
+
+			for (auto&& currResult : results)
+			{
+				if (!pSymTable->Merge(currResult.mSymTable))
+				{
+					return nullptr;
+				}
+			}
+
+			for (auto&& currError : results.back().mErrors)
+			{
+				onErrorCallback(currError);
+			}
+
+			return pSymTable;
+		}
+	}
+
+
 	std::unique_ptr<SymTable> ProcessHeaderFile(const TIntrospectorOptions& options, const std::string& filename) TDE2_NOEXCEPT
 	{
 		WriteOutput(std::string("\n").append("Process ").append(filename).append(" file... "));
 
-		if (std::unique_ptr<IInputStream> pFileStream{ new FileInputStream(filename) })
+		if (std::unique_ptr<IInputStream> pFileStream{ new MappedFileInputStream(filename) })
 		{
 			if (!pFileStream->Open())
 			{
@@ -241,18 +379,68 @@ namespace TDEngine2
 				return nullptr;
 			}
 
-			Lexer lexer{ *pFileStream };
-
 			std::unique_ptr<SymTable> pSymTable = std::make_unique<SymTable>();
 			pSymTable->SetSourceFilename(fs::canonical(filename).string());
 
+			/// \note Most of headers don't declare anything the tool could extract, don't lex them at all
+			if (auto&& buffer = pFileStream->GetBuffer())
+			{
+				if (!KeywordsPrefilter::CreateFromOptions(options).HasAnyKeyword(*buffer))
+				{
+					WriteOutput("OK (nothing to introspect)\n");
+					return pSymTable;
+				}
+			}
+
 			bool hasErrors = false;
 
-			Parser{ lexer, *pSymTable, options, [&filename, &hasErrors](auto&& error)
+			ParsingBudget budget = ParsingBudget::CreateFromOptions(options);
+
+			auto onErrorCallback = [&filename, &hasErrors, &budget](auto&& error)
 			{
+				/// \note Errors that follow the cut of the file are caused by it
+				if (budget.IsExceeded() && TParserError::E_PARSER_ERROR_CODE::BUDGET_EXCEEDED != error.mCode)
+				{
+					return;
+				}
+
 				hasErrors = true;
 				WriteOutput(std::string("\nError (").append(filename).append(")").append(error.ToString()));
-			} }.Parse();
+			};
+
+			if (options.mIsTaggedOnlyModeEnabled)
+			{
+				/// \note Bodies of untagged classes are skipped over raw bytes, so the file is lexed on demand to never scan them
+				Lexer lexer{ *pFileStream };
+				Parser{ lexer, *pSymTable, options, onErrorCallback, &budget }.Parse();
+			}
+			else
+			{
+				const TTokensArray tokens = Lexer{ *pFileStream }.Tokenize(&budget);
+
+				std::unique_ptr<SymTable> pMergedSymTable = budget.IsExceeded() ? nullptr : ParseTokensConcurrently(options, tokens, onErrorCallback);
+
+				if (pMergedSymTable)
+				{
+					pMergedSymTable->SetSourceFilename(pSymTable->GetSourceFilename());
+					pSymTable = std::move(pMergedSymTable);
+				}
+				else
+				{
+					Parser{ tokens, *pSymTable, options, onErrorCallback, &budget }.Parse();
+				}
+			}
+
+			if (budget.IsExceeded()) // \note Nothing of a partially parsed file is emitted
+			{
+				auto pSkippedSymTable = std::make_unique<SymTable>();
+				pSkippedSymTable->SetSourceFilename(pSymTable->GetSourceFilename());
+				pSkippedSymTable->MarkAsSkipped();
+
+				WriteOutput("\n");
+
+				return pSkippedSymTable;
+			}
 
 			if (!hasErrors)
 			{
@@ -266,6 +454,43 @@ namespace TDEngine2
 	}
 
 
+	std::unique_ptr<SymTable> LoadSymTableFromCache(const std::string& cachePath, const std::string& optionsDigest) TDE2_NOEXCEPT
+	{
+		std::unique_ptr<SymTable> pSymTable = std::make_unique<SymTable>();
+
+		{
+			MappedFileInputStream cacheFileStream(cachePath);
+
+			if (!cacheFileStream.Open())
+			{
+				return nullptr;
+			}
+
+			auto&& buffer = cacheFileStream.GetBuffer();
+
+			if (buffer && CacheFormat::IsImage(*buffer))
+			{
+				return pSymTable->LoadImage(*buffer, optionsDigest) ? std::move(pSymTable) : nullptr;
+			}
+		}
+
+		/// \note A file of the Archive based format
+		std::ifstream symTableSourceFile(cachePath, std::ios::binary);
+		if (!symTableSourceFile.is_open())
+		{
+			return nullptr;
+		}
+
+		Archive<std::ifstream> symTableSourceArchive(symTableSourceFile);
+
+		const bool isLoaded = pSymTable->Load(symTableSourceArchive);
+
+		symTableSourceFile.close();
+
+		return isLoaded ? std::move(pSymTable) : nullptr;
+	}
+
+
 	/*!
 		\brief FileOutputStream's definition
 	*/
@@ -317,35 +542,132 @@ namespace TDEngine2
 	}
 
 
+	namespace
+	{
+		std::atomic<uint64_t> NextCacheDataUid { 1 };
+
+
+		uint64_t AlignImageOffset(uint64_t offset)
+		{
+			return (offset + CacheFormat::mImageAlignment - 1) & ~static_cast<uint64_t>(CacheFormat::mImageAlignment - 1);
+		}
+
+
+		/*!
+			\brief The function returns an empty string if the file doesn't exist
+		*/
+
+		std::string GetCanonicalPath(const std::string& filePath)
+		{
+			std::error_code errorCode;
+			const fs::path canonicalPath = fs::canonical(filePath, errorCode);
+
+			return errorCode ? std::string() : canonicalPath.string();
+		}
+
+
+		bool IsPrevLayoutCacheFilename(const std::string& filename)
+		{
+			return (64 == filename.size()) && std::all_of(filename.cbegin(), filename.cend(), [](char ch) { return std::isxdigit(static_cast<uint8_t>(ch)); });
+		}
+	}
+
+
+	TCacheData::TCacheData():
+		mUid(NextCacheDataUid++)
+	{
+	}
+
+	TCacheData::~TCacheData()
+	{
+	}
+
 	bool TCacheData::Load(const std::string& cacheSourceDirectory, const std::string& cacheFilename)
 	{
-		std::ifstream inputFile(fs::path(cacheSourceDirectory).concat(cacheFilename), std::ios::binary);
+		using namespace CacheFormat;
 
-		defer([&inputFile]
+		mCacheDirectory = cacheSourceDirectory;
+
+		const std::string indexPath = fs::path(cacheSourceDirectory).concat(cacheFilename).string();
+
+		MappedFileInputStream indexStream(indexPath);
+		if (!indexStream.Open())
 		{
-			inputFile.close();
-		});
+			return false;
+		}
 
-		if (!inputFile.is_open())
+		auto&& buffer = indexStream.GetBuffer();
+		if (!buffer || !IsIndex(*buffer))
+		{
+			indexStream.Close();
+			return _loadPreviousIndex(indexPath);
+		}
+
+		const std::string_view index = *buffer;
+
+		TIndexHeader header;
+		memcpy(&header, index.data(), sizeof(header));
+		SwapWordsIfBigEndian(reinterpret_cast<uint32_t*>(&header), sizeof(header) / sizeof(uint32_t));
+
+		const size_t stringsDataOffset = sizeof(TIndexHeader) + static_cast<size_t>(header.mEntriesCount) * sizeof(TIndexEntryRecord);
+		if (stringsDataOffset + header.mStringsDataSize != index.size())
 		{
 			return false;
 		}
 
-		Archive<std::ifstream> cacheArchive{ inputFile };
+		std::vector<TIndexEntryRecord> entries(header.mEntriesCount);
 
-		cacheArchive >> mInputHash;
-		
-		size_t entitiesCount = 0;
+		if (!entries.empty())
+		{
+			memcpy(entries.data(), index.data() + sizeof(TIndexHeader), entries.size() * sizeof(TIndexEntryRecord));
+			SwapWordsIfBigEndian(reinterpret_cast<uint32_t*>(entries.data()), entries.size() * sizeof(TIndexEntryRecord) / sizeof(uint32_t));
+		}
 
-		cacheArchive >> entitiesCount;
+		const std::string_view stringsData = index.substr(stringsDataOffset);
 
-		std::string currPath;
-		std::string currHash;
+		auto isInRange = [&stringsData](uint32_t offset, uint32_t length)
+		{
+			return offset <= stringsData.size() && length <= stringsData.size() - offset;
+		};
 
-		for (size_t i = 0; i < entitiesCount; ++i)
+		mPackGeneration = header.mPackGeneration;
+
+		/// \note The pack stays mapped until Save, images of tables are read from it in place
+		mpPackStream = std::make_unique<MappedFileInputStream>(_getPackPath(mPackGeneration));
+		if (!mpPackStream->Open())
 		{
-			cacheArchive >> currPath >> currHash;
-			mSymTablesTable.emplace(currPath, currHash);
+			mpPackStream = nullptr;
+		}
+
+		mPackSize = mpPackStream ? mpPackStream->GetBuffer().value_or(std::string_view{}).size() : 0;
+
+		mSymTablesTable.reserve(entries.size());
+
+		for (auto&& currEntry : entries)
+		{
+			if (!isInRange(currEntry.mPathOffset, currEntry.mPathLength) || !isInRange(currEntry.mHashOffset, currEntry.mHashLength))
+			{
+				return false;
+			}
+
+			const uint64_t imageOffset = static_cast<uint64_t>(currEntry.mImageOffsetLow) | (static_cast<uint64_t>(currEntry.mImageOffsetHigh) << 32);
+
+			if (currEntry.mImageSize && (imageOffset > mPackSize || currEntry.mImageSize > mPackSize - imageOffset)) // \note The pack was lost or truncated
+			{
+				continue;
+			}
+
+			TEntry entry { std::string(stringsData.substr(currEntry.mHashOffset, currEntry.mHashLength)) };
+
+			entry.mFileStat.mSize = static_cast<uint64_t>(currEntry.mFileSizeLow) | (static_cast<uint64_t>(currEntry.mFileSizeHigh) << 32);
+			entry.mFileStat.mLastWriteTime = static_cast<int64_t>(static_cast<uint64_t>(currEntry.mLastWriteTimeLow) | (static_cast<uint64_t>(currEntry.mLastWriteTimeHigh) << 32));
+			entry.mFileStat.mInode = static_cast<uint64_t>(currEntry.mInodeLow) | (static_cast<uint64_t>(currEntry.mInodeHigh) << 32);
+			entry.mOptionsDigestHash = static_cast<uint64_t>(currEntry.mOptionsDigestLow) | (static_cast<uint64_t>(currEntry.mOptionsDigestHigh) << 32);
+			entry.mLastAccessTime = static_cast<uint64_t>(currEntry.mLastAccessTimeLow) | (static_cast<uint64_t>(currEntry.mLastAccessTimeHigh) << 32);
+			entry.mOffset = imageOffset;
+			entry.mSize = currEntry.mImageSize;
+
+			mSymTablesTable.emplace(stringsData.substr(currEntry.mPathOffset, currEntry.mPathLength), std::move(entry));
 		}
 
 		return true;
@@ -353,66 +675,249 @@ namespace TDEngine2
 
 	bool TCacheData::Save(const std::string& cacheSourceDirectory, const std::string& cacheFilename)
 	{
-		std::ofstream cacheFile(fs::path(cacheSourceDirectory).concat(cacheFilename), std::ios::binary);
+		using namespace CacheFormat;
+
+		mCacheDirectory = cacheSourceDirectory;
+
+		TPendingEntities pendingEntities;
 
-		defer([&cacheFile]
 		{
-			cacheFile.close();
+			std::lock_guard<std::mutex> lock{ mPendingEntitiesMutex };
+
+			for (auto&& pThreadPendingEntities : mpPendingEntities)
+			{
+				std::move(pThreadPendingEntities->begin(), pThreadPendingEntities->end(), std::back_inserter(pendingEntities));
+			}
+
+			mpPendingEntities.clear();
+		}
+
+		const uint64_t currTime = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+
+		/// \note Reused tables get new access time and stats of files that were touched without changes of their content, their images stay where they are
+		auto reusedEntitiesIter = std::partition(pendingEntities.begin(), pendingEntities.end(), [](auto&& entity) { return !entity.mImage.empty(); });
+
+		std::for_each(reusedEntitiesIter, pendingEntities.end(), [this, currTime](auto&& entity)
+		{
+			auto iter = mSymTablesTable.find(entity.mFilePath);
+			if ((iter != mSymTablesTable.end()) && (iter->second.mHash == entity.mFileHash))
+			{
+				iter->second.mFileStat = entity.mFileStat;
+				iter->second.mLastAccessTime = currTime;
+			}
 		});
 
-		Archive<std::ofstream> cacheArchive { cacheFile };
+		pendingEntities.erase(reusedEntitiesIter, pendingEntities.end());
+
+		_removeStaleEntries();
+
+		/// \note Threads append images in arbitrary order, sort them to keep the pack the same between runs
+		std::sort(pendingEntities.begin(), pendingEntities.end(), [](auto&& left, auto&& right) { return left.mFilePath < right.mFilePath; });
+
+		for (auto&& currEntity : pendingEntities)
+		{
+			mSymTablesTable[currEntity.mFilePath] = { currEntity.mFileHash, currEntity.mFileStat, mOptionsDigestHash, currTime, 0, 0 }; // \note Superseded images become garbage, the location is assigned below
+		}
+
+		_evictEntries(pendingEntities, currTime);
+
+		/// \note Images of evicted entries are never written
+		pendingEntities.erase(std::remove_if(pendingEntities.begin(), pendingEntities.end(), [this](auto&& entity) { return !mSymTablesTable.count(entity.mFilePath); }), pendingEntities.end());
+
+		uint64_t pendingSize = 0;
+
+		for (auto&& currEntity : pendingEntities)
+		{
+			pendingSize += AlignImageOffset(currEntity.mImage.size());
+		}
+
+		uint64_t liveSize = pendingSize;
+
+		for (auto&& currEntry : mSymTablesTable)
+		{
+			liveSize += AlignImageOffset(currEntry.second.mSize);
+		}
+
+		/// \note The pack could be longer than its mapped part if its index was lost, images are appended after all of its content
+		std::error_code errorCode;
+		const uintmax_t packFileSize = fs::file_size(_getPackPath(mPackGeneration), errorCode);
 
-		cacheArchive << mInputHash;
+		const uint64_t prevPackSize = errorCode ? 0 : std::max<uint64_t>(mPackSize, packFileSize);
 
-		cacheArchive << mSymTablesTable.size();
+		const uint64_t packSize = AlignImageOffset(prevPackSize) + pendingSize;
+		const bool isCompactionNeeded = ((packSize >= mMinCompactedPackSize) && (packSize > mCompactionRatio * liveSize)) ||
+										(mEvictionPolicy.mSizeLimit && (packSize > mEvictionPolicy.mSizeLimit) && (packSize > liveSize)); // \note Garbage doesn't fit into the limit
 
-		for (auto&& currSymTableInfo : mSymTablesTable)
+		const uint32_t packGeneration = isCompactionNeeded ? (mPackGeneration + 1) : mPackGeneration;
+
+		uint64_t packEnd = isCompactionNeeded ? 0 : prevPackSize;
+
+		std::ofstream packFile;
+
+		if (isCompactionNeeded)
 		{
-			cacheArchive << currSymTableInfo.first << currSymTableInfo.second;
+			packFile.open(_getPackPath(packGeneration), std::ios::binary | std::ios::trunc);
+		}
+		else
+		{
+			mpPackStream = nullptr; // \note The pack isn't mapped while it grows
+			packFile.open(_getPackPath(packGeneration), std::ios::binary | std::ios::app);
 		}
 
+		if (!packFile.is_open())
+		{
+			return false;
+		}
+
+		auto writeImage = [&packFile, &packEnd](std::string_view image)
+		{
+			static const char padding[mImageAlignment] {};
+
+			const uint64_t imageOffset = AlignImageOffset(packEnd);
+
+			packFile.write(padding, static_cast<std::streamsize>(imageOffset - packEnd));
+			packFile.write(image.data(), static_cast<std::streamsize>(image.size()));
+
+			packEnd = imageOffset + image.size();
+
+			return imageOffset;
+		};
+
+		if (isCompactionNeeded) // \note Live images are copied into a new pack, the index refers to the old one until it's replaced
+		{
+			const std::string_view prevPack = mpPackStream ? mpPackStream->GetBuffer().value_or(std::string_view{}) : std::string_view{};
+
+			for (auto&& currEntry : mSymTablesTable)
+			{
+				if (currEntry.second.mSize)
+				{
+					currEntry.second.mOffset = writeImage(prevPack.substr(currEntry.second.mOffset, currEntry.second.mSize));
+				}
+			}
+
+			mpPackStream = nullptr;
+		}
+
+		for (auto&& currEntity : pendingEntities)
+		{
+			TEntry& entry = mSymTablesTable[currEntity.mFilePath];
+
+			entry.mOffset = writeImage(currEntity.mImage);
+			entry.mSize = static_cast<uint32_t>(currEntity.mImage.size());
+		}
+
+		packFile.close();
+
+		if (!packFile)
+		{
+			return false;
+		}
+
+		mPackGeneration = packGeneration;
+		mPackSize = packEnd;
+
+		if (!_saveIndex(fs::path(cacheSourceDirectory).concat(cacheFilename).string()))
+		{
+			return false;
+		}
+
+		/// \note The previous pack after compaction and separate files whose tables were moved into the pack aren't referred anymore
+		_removeUnreferencedFiles();
+
 		return true;
 	}
 
 	void TCacheData::Reset()
 	{
-		std::lock_guard<std::mutex> lock{ mMutex };
-
-		mInputHash.clear();
 		mSymTablesTable.clear();
+
+		std::lock_guard<std::mutex> lock{ mPendingEntitiesMutex };
+		mpPendingEntities.clear();
 	}
 
-	void TCacheData::AddSymTableEntity(const std::string& filePath, const std::string& fileHash)
+	void TCacheData::AddSymTableEntity(const std::string& filePath, const std::string& fileHash, const TFileStat& fileStat, std::string&& image)
 	{
-		std::lock_guard<std::mutex> lock{ mMutex };
-
-		if (mSymTablesTable.find(filePath) == mSymTablesTable.cend())
+		std::string canonicalPath = GetCanonicalPath(filePath);
+		if (canonicalPath.empty())
 		{
-			mSymTablesTable.emplace(filePath, fileHash);
 			return;
 		}
 
-		mSymTablesTable[filePath] = fileHash;
+		_getThreadPendingEntities().push_back({ std::move(canonicalPath), fileHash, fileStat, std::move(image) });
 	}
 
-	bool TCacheData::Contains(const std::string& filePath, const std::string& fileHash) const
+	void TCacheData::SetEvictionPolicy(const TEvictionPolicy& policy)
+	{
+		mEvictionPolicy = policy;
+	}
+
+	void TCacheData::SetOptionsDigest(const std::string& optionsDigest)
 	{
-		std::lock_guard<std::mutex> lock{ mMutex };
+		mOptionsDigest = optionsDigest;
+		mOptionsDigestHash = CacheFormat::ComputeOptionsDigestHash(optionsDigest);
+	}
 
-		auto iter = mSymTablesTable.find(filePath);
+	bool TCacheData::Contains(const std::string& filePath, const std::string& fileHash) const
+	{
+		auto iter = mSymTablesTable.find(GetCanonicalPath(filePath));
 		
-		return (iter != mSymTablesTable.cend()) && (iter->second == fileHash);
+		return (iter != mSymTablesTable.cend()) && (iter->second.mHash == fileHash);
 	}
 
-	void TCacheData::SetInputHash(const std::string& hash)
+	std::unique_ptr<SymTable> TCacheData::LoadSymTable(const std::string& filePath, FileFingerprint& fingerprint)
 	{
-		std::lock_guard<std::mutex> lock{ mMutex };
-		mInputHash = hash;
+		std::string canonicalPath = GetCanonicalPath(filePath);
+
+		auto iter = mSymTablesTable.find(canonicalPath);
+		if (iter == mSymTablesTable.cend())
+		{
+			return nullptr;
+		}
+
+		const TEntry& entry = iter->second;
+
+		if (!entry.mSize)
+		{
+			/// \note Separate files are named by hashes of paths that were passed to the tool
+			const std::string prevHash = GetHashFromFilePath(filePath, mOptionsDigest);
+			if (entry.mHash != prevHash)
+			{
+				return nullptr;
+			}
+
+			std::unique_ptr<SymTable> pSymTable = LoadSymTableFromCache(fs::path(mCacheDirectory).concat(prevHash).string(), mOptionsDigest);
+			if (pSymTable && !fingerprint.GetContentHash().empty())
+			{
+				_getThreadPendingEntities().push_back({ std::move(canonicalPath), fingerprint.GetContentHash(), fingerprint.GetStat(), pSymTable->SaveImage(mOptionsDigest) });
+			}
+
+			return pSymTable;
+		}
+
+		if ((entry.mOptionsDigestHash != mOptionsDigestHash) || !fingerprint.Matches(entry.mFileStat, entry.mHash))
+		{
+			return nullptr;
+		}
+
+		auto&& pack = mpPackStream ? mpPackStream->GetBuffer() : std::nullopt;
+		if (!pack)
+		{
+			return nullptr;
+		}
+
+		std::unique_ptr<SymTable> pSymTable = std::make_unique<SymTable>();
+		if (!pSymTable->LoadImage(pack->substr(entry.mOffset, entry.mSize), mOptionsDigest))
+		{
+			return nullptr;
+		}
+
+		_getThreadPendingEntities().push_back({ std::move(canonicalPath), entry.mHash, fingerprint.GetStat() });
+
+		return std::move(pSymTable);
 	}
 
 	void TCacheData::SetSymTablesIndex(TCacheIndexTable&& table)
 	{
-		std::lock_guard<std::mutex> lock{ mMutex };
 		std::swap(mSymTablesTable, table);
 	}
 
@@ -421,37 +926,272 @@ namespace TDEngine2
 		return mSymTablesTable;
 	}
 
-	const std::string& TCacheData::GetInputHash() const
+	TCacheData::TPendingEntities& TCacheData::_getThreadPendingEntities()
 	{
-		return mInputHash;
+		thread_local uint64_t OwnerUid = 0;
+		thread_local TPendingEntities* pPendingEntities = nullptr;
+
+		if (OwnerUid != mUid)
+		{
+			std::lock_guard<std::mutex> lock{ mPendingEntitiesMutex };
+
+			mpPendingEntities.push_back(std::make_unique<TPendingEntities>());
+
+			pPendingEntities = mpPendingEntities.back().get();
+			OwnerUid = mUid;
+		}
+
+		return *pPendingEntities;
 	}
 
+	bool TCacheData::_loadPreviousIndex(const std::string& indexPath)
+	{
+		std::ifstream inputFile(indexPath, std::ios::binary);
+
+		defer([&inputFile]
+		{
+			inputFile.close();
+		});
+
+		if (!inputFile.is_open())
+		{
+			return false;
+		}
+
+		Archive<std::ifstream> cacheArchive{ inputFile };
+
+		std::string inputHash; ///< Validity of entries doesn't depend on a set of inputs anymore
+
+		cacheArchive >> inputHash;
+		
+		size_t entitiesCount = 0;
+
+		cacheArchive >> entitiesCount;
+
+		std::string currPath;
+		std::string currHash;
+
+		for (size_t i = 0; i < entitiesCount; ++i)
+		{
+			cacheArchive >> currPath >> currHash;
+
+			std::string canonicalPath = GetCanonicalPath(currPath);
+			if (!canonicalPath.empty())
+			{
+				mSymTablesTable.emplace(std::move(canonicalPath), TEntry { currHash });
+			}
+		}
 
-	std::string GetHashFromInputFiles(const std::vector<std::string>& inputFiles)
+		return true;
+	}
+
+	bool TCacheData::_saveIndex(const std::string& indexPath) const
 	{
-		picosha2::hash256_one_by_one hashGenerator;
+		using namespace CacheFormat;
 
-		hashGenerator.init();
+		std::string stringsData;
+
+		auto addString = [&stringsData](const std::string& value)
+		{
+			const uint32_t offset = static_cast<uint32_t>(stringsData.size());
+			stringsData.append(value);
 
-		for (auto&& currInputFilePath : inputFiles)
+			return offset;
+		};
+
+		TIndexHeader header { mIndexMagic, mVersion, mPackGeneration, static_cast<uint32_t>(mSymTablesTable.size()) };
+
+		std::vector<TIndexEntryRecord> entries;
+		entries.reserve(mSymTablesTable.size());
+
+		for (auto&& currEntry : mSymTablesTable)
 		{
-			hashGenerator.process(currInputFilePath.cbegin(), currInputFilePath.cend());
+			const TEntry& entry = currEntry.second;
+
+			const TFileStat& stat = entry.mFileStat;
+
+			entries.push_back({ addString(currEntry.first), static_cast<uint32_t>(currEntry.first.size()), addString(entry.mHash), static_cast<uint32_t>(entry.mHash.size()),
+								static_cast<uint32_t>(entry.mOffset), static_cast<uint32_t>(entry.mOffset >> 32), entry.mSize,
+								static_cast<uint32_t>(stat.mSize), static_cast<uint32_t>(stat.mSize >> 32),
+								static_cast<uint32_t>(stat.mLastWriteTime), static_cast<uint32_t>(static_cast<uint64_t>(stat.mLastWriteTime) >> 32),
+								static_cast<uint32_t>(stat.mInode), static_cast<uint32_t>(stat.mInode >> 32),
+								static_cast<uint32_t>(entry.mOptionsDigestHash), static_cast<uint32_t>(entry.mOptionsDigestHash >> 32),
+								static_cast<uint32_t>(entry.mLastAccessTime), static_cast<uint32_t>(entry.mLastAccessTime >> 32), 0 });
 		}
 
-		hashGenerator.finish();
+		header.mStringsDataSize = static_cast<uint32_t>(stringsData.size());
+		header.mReserved = 0;
 
-		std::string outputHashStr;
-		picosha2::get_hash_hex_string(hashGenerator, outputHashStr);
+		SwapWordsIfBigEndian(reinterpret_cast<uint32_t*>(&header), sizeof(header) / sizeof(uint32_t));
 
-		return outputHashStr;
+		if (!entries.empty())
+		{
+			SwapWordsIfBigEndian(reinterpret_cast<uint32_t*>(entries.data()), entries.size() * sizeof(TIndexEntryRecord) / sizeof(uint32_t));
+		}
+
+		/// \note The index is written aside and then renamed, so readers see either the previous index or the new one
+		const std::string tempIndexPath = indexPath + ".tmp";
+
+		{
+			std::ofstream indexFile(tempIndexPath, std::ios::binary | std::ios::trunc);
+			if (!indexFile.is_open())
+			{
+				return false;
+			}
+
+			indexFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+			indexFile.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(TIndexEntryRecord)));
+			indexFile.write(stringsData.data(), static_cast<std::streamsize>(stringsData.size()));
+
+			indexFile.close();
+
+			if (!indexFile)
+			{
+				return false;
+			}
+		}
+
+		std::error_code errorCode;
+		fs::rename(tempIndexPath, indexPath, errorCode);
+
+		return !errorCode;
+	}
+
+	void TCacheData::_removeStaleEntries()
+	{
+		TFileStat stat;
+
+		for (auto iter = mSymTablesTable.begin(); iter != mSymTablesTable.end();)
+		{
+			iter = GetFileStat(iter->first, stat) ? std::next(iter) : mSymTablesTable.erase(iter);
+		}
+	}
+
+	void TCacheData::_evictEntries(const TPendingEntities& pendingEntities, uint64_t currTime)
+	{
+		if (mEvictionPolicy.mMaxAge)
+		{
+			for (auto iter = mSymTablesTable.begin(); iter != mSymTablesTable.end();)
+			{
+				const bool isExpired = (currTime > iter->second.mLastAccessTime) && (currTime - iter->second.mLastAccessTime > mEvictionPolicy.mMaxAge);
+				iter = isExpired ? mSymTablesTable.erase(iter) : std::next(iter);
+			}
+		}
+
+		if (!mEvictionPolicy.mSizeLimit)
+		{
+			return;
+		}
+
+		std::unordered_map<std::string, uint64_t> pendingSizes;
+
+		for (auto&& currEntity : pendingEntities)
+		{
+			pendingSizes[currEntity.mFilePath] = AlignImageOffset(currEntity.mImage.size());
+		}
+
+		std::vector<std::pair<const std::string*, const TEntry*>> entries;
+		entries.reserve(mSymTablesTable.size());
+
+		uint64_t totalSize = 0;
+
+		for (auto&& currEntry : mSymTablesTable)
+		{
+			auto pendingIter = pendingSizes.find(currEntry.first);
+			totalSize += (pendingIter != pendingSizes.cend()) ? pendingIter->second : AlignImageOffset(currEntry.second.mSize);
+
+			entries.emplace_back(&currEntry.first, &currEntry.second);
+		}
+
+		if (totalSize <= mEvictionPolicy.mSizeLimit)
+		{
+			return;
+		}
+
+		/// \note Paths break ties, so the same entries are evicted on every host
+		std::sort(entries.begin(), entries.end(), [](auto&& left, auto&& right)
+		{
+			return (left.second->mLastAccessTime != right.second->mLastAccessTime) ? (left.second->mLastAccessTime < right.second->mLastAccessTime) : (*left.first < *right.first);
+		});
+
+		std::vector<std::string> evictedPaths;
+
+		for (auto&& currEntry : entries)
+		{
+			if (totalSize <= mEvictionPolicy.mSizeLimit)
+			{
+				break;
+			}
+
+			auto pendingIter = pendingSizes.find(*currEntry.first);
+			totalSize -= (pendingIter != pendingSizes.cend()) ? pendingIter->second : AlignImageOffset(currEntry.second->mSize);
+
+			evictedPaths.push_back(*currEntry.first);
+		}
+
+		for (auto&& currPath : evictedPaths)
+		{
+			mSymTablesTable.erase(currPath);
+		}
+	}
+
+	void TCacheData::_removeUnreferencedFiles() const
+	{
+		std::unordered_set<std::string> referencedFilenames { fs::path(_getPackPath(mPackGeneration)).filename().string() };
+
+		for (auto&& currEntry : mSymTablesTable)
+		{
+			if (!currEntry.second.mSize)
+			{
+				referencedFilenames.emplace(currEntry.second.mHash);
+			}
+		}
+
+		std::error_code errorCode;
+
+		for (fs::directory_iterator iter(mCacheDirectory, errorCode), endIter; !errorCode && iter != endIter; iter.increment(errorCode))
+		{
+			const std::string filename = iter->path().filename().string();
+
+			const bool isPack = (0 == filename.rfind("symtables.", 0)) && (filename.size() > 5) && (0 == filename.compare(filename.size() - 5, 5, ".pack"));
+
+			if ((isPack || IsPrevLayoutCacheFilename(filename)) && !referencedFilenames.count(filename))
+			{
+				std::error_code removeErrorCode;
+				fs::remove(iter->path(), removeErrorCode);
+			}
+		}
+	}
+
+	std::string TCacheData::_getPackPath(uint32_t generation) const
+	{
+		return fs::path(mCacheDirectory).concat("symtables.").concat(std::to_string(generation)).concat(".pack").string();
+	}
+
+
+	std::string GetOptionsDigest(const TIntrospectorOptions& options)
+	{
+		std::string digest;
+
+		digest.append("version:").append(std::to_string(ToolVersion.mMajor)).append(".").append(std::to_string(ToolVersion.mMinor)).append("\n");
+		digest.append("tagged:").append(options.mIsTaggedOnlyModeEnabled ? "1" : "0").append("\n");
+		digest.append("budget:").append(std::to_string(options.mMaxTokensPerFile)).append(":").append(std::to_string(options.mMaxParsingTimePerFile)).append("\n"); // \note Skipped files are cached too
+
+		if (options.mpTypesFilter)
+		{
+			digest.append(options.mpTypesFilter->GetDigest());
+		}
+
+		return digest;
 	}
 
-	std::string GetHashFromFilePath(const std::string& value)
+	std::string GetHashFromFilePath(const std::string& value, const std::string& optionsDigest)
 	{
 		picosha2::hash256_one_by_one hashGenerator;
 
 		hashGenerator.init();
 		hashGenerator.process(value.cbegin(), value.cend());
+		hashGenerator.process(optionsDigest.cbegin(), optionsDigest.cend());
 
 		std::string timestampStr = std::to_string(static_cast<long long>(fs::last_write_time(value).time_since_epoch().count()));
 		hashGenerator.process(timestampStr.cbegin(), timestampStr.cend());
@@ -0,0 +1,214 @@
+#include "../include/fingerprint.h"
+#include "../include/lexer.h"
+#include <cstring>
+#include <algorithm>
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <sys/stat.h>
+#endif
+
+
+namespace TDEngine2
+{
+#if defined(_WIN32)
+
+	bool GetFileStat(const std::string& filePath, TFileStat& stat) TDE2_NOEXCEPT
+	{
+		HANDLE fileHandle = CreateFileA(filePath.c_str(), 0, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (INVALID_HANDLE_VALUE == fileHandle)
+		{
+			return false;
+		}
+
+		BY_HANDLE_FILE_INFORMATION info;
+		const bool result = GetFileInformationByHandle(fileHandle, &info);
+
+		CloseHandle(fileHandle);
+
+		if (!result)
+		{
+			return false;
+		}
+
+		stat.mSize = (static_cast<uint64_t>(info.nFileSizeHigh) << 32) | info.nFileSizeLow;
+		stat.mLastWriteTime = static_cast<int64_t>((static_cast<uint64_t>(info.ftLastWriteTime.dwHighDateTime) << 32) | info.ftLastWriteTime.dwLowDateTime);
+		stat.mInode = (static_cast<uint64_t>(info.nFileIndexHigh) << 32) | info.nFileIndexLow;
+
+		return true;
+	}
+
+#else
+
+	bool GetFileStat(const std::string& filePath, TFileStat& stat) TDE2_NOEXCEPT
+	{
+		struct stat info;
+		if (::stat(filePath.c_str(), &info))
+		{
+			return false;
+		}
+
+		stat.mSize = static_cast<uint64_t>(info.st_size);
+#if defined(__APPLE__)
+		stat.mLastWriteTime = static_cast<int64_t>(info.st_mtimespec.tv_sec) * 1000000000 + info.st_mtimespec.tv_nsec;
+#else
+		stat.mLastWriteTime = static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+#endif
+		stat.mInode = static_cast<uint64_t>(info.st_ino);
+
+		return true;
+	}
+
+#endif
+
+
+	std::string THash128::ToString() const
+	{
+		static const char digits[] = "0123456789abcdef";
+
+		std::string result(32, '0');
+
+		for (size_t i = 0; i < 16; ++i)
+		{
+			result[15 - i] = digits[(mHigh >> (4 * i)) & 0xF];
+			result[31 - i] = digits[(mLow >> (4 * i)) & 0xF];
+		}
+
+		return result;
+	}
+
+
+	namespace
+	{
+		inline uint64_t RotateLeft(uint64_t value, uint32_t shift)
+		{
+			return (value << shift) | (value >> (64 - shift));
+		}
+
+		inline uint64_t FinalizationMix(uint64_t value)
+		{
+			value ^= value >> 33;
+			value *= 0xff51afd7ed558ccdull;
+			value ^= value >> 33;
+			value *= 0xc4ceb9fe1a85ec53ull;
+			value ^= value >> 33;
+
+			return value;
+		}
+	}
+
+
+	THash128 ComputeContentHash(std::string_view data, uint64_t seed) TDE2_NOEXCEPT
+	{
+		constexpr uint64_t c1 = 0x87c37b91114253d5ull;
+		constexpr uint64_t c2 = 0x4cf5ad432745937full;
+
+		const uint8_t* pData = reinterpret_cast<const uint8_t*>(data.data());
+		const size_t blocksCount = data.size() / 16;
+
+		uint64_t h1 = seed;
+		uint64_t h2 = seed;
+
+		/// \note Blocks are read in the host's order, so hashes are the same only between hosts of the same endianness
+		for (size_t i = 0; i < blocksCount; ++i)
+		{
+			uint64_t k1, k2;
+
+			memcpy(&k1, pData + i * 16, sizeof(k1));
+			memcpy(&k2, pData + i * 16 + 8, sizeof(k2));
+
+			k1 *= c1; k1 = RotateLeft(k1, 31); k1 *= c2; h1 ^= k1;
+
+			h1 = RotateLeft(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+
+			k2 *= c2; k2 = RotateLeft(k2, 33); k2 *= c1; h2 ^= k2;
+
+			h2 = RotateLeft(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+		}
+
+		const uint8_t* pTail = pData + blocksCount * 16;
+		const size_t tailSize = data.size() & 15;
+
+		uint64_t k1 = 0;
+		uint64_t k2 = 0;
+
+		for (size_t i = tailSize; i > 8; --i)
+		{
+			k2 ^= static_cast<uint64_t>(pTail[i - 1]) << (8 * (i - 9));
+		}
+
+		if (tailSize > 8)
+		{
+			k2 *= c2; k2 = RotateLeft(k2, 33); k2 *= c1; h2 ^= k2;
+		}
+
+		for (size_t i = std::min<size_t>(tailSize, 8); i > 0; --i)
+		{
+			k1 ^= static_cast<uint64_t>(pTail[i - 1]) << (8 * (i - 1));
+		}
+
+		if (tailSize)
+		{
+			k1 *= c1; k1 = RotateLeft(k1, 31); k1 *= c2; h1 ^= k1;
+		}
+
+		h1 ^= static_cast<uint64_t>(data.size());
+		h2 ^= static_cast<uint64_t>(data.size());
+
+		h1 += h2;
+		h2 += h1;
+
+		h1 = FinalizationMix(h1);
+		h2 = FinalizationMix(h2);
+
+		h1 += h2;
+		h2 += h1;
+
+		return { h1, h2 };
+	}
+
+
+	FileFingerprint::FileFingerprint(const std::string& filePath):
+		mFilePath(filePath)
+	{
+		mIsStatValid = GetFileStat(mFilePath, mStat);
+	}
+
+	bool FileFingerprint::Matches(const TFileStat& stat, const std::string& contentHash)
+	{
+		if (mIsStatValid && stat == mStat)
+		{
+			return true;
+		}
+
+		const std::string& currContentHash = GetContentHash();
+
+		return !currContentHash.empty() && (currContentHash == contentHash);
+	}
+
+	const std::string& FileFingerprint::GetContentHash()
+	{
+		if (mIsContentHashComputed)
+		{
+			return mContentHash;
+		}
+
+		mIsContentHashComputed = true;
+
+		MappedFileInputStream fileStream(mFilePath);
+		if (!fileStream.Open())
+		{
+			return mContentHash;
+		}
+
+		if (auto&& buffer = fileStream.GetBuffer())
+		{
+			mContentHash = ComputeContentHash(*buffer).ToString();
+		}
+
+		return mContentHash;
+	}
+}
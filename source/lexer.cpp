@@ -1,5 +1,20 @@
 #include "../include/lexer.h"
-#include <cctype>
+#include "../include/atomtable.h"
+#include "../include/parsingbudget.h"
+#include <cstring>
+#include <cassert>
+#include <algorithm>
+
+#if defined(_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
 
 
 namespace TDEngine2
@@ -55,61 +70,295 @@ namespace TDEngine2
 	}
 
 
-	const Lexer::TKeywordsMap Lexer::mReservedTokens
-	{
-		{ "namespace", E_TOKEN_TYPE::TT_NAMESPACE },
-		{ "enum", E_TOKEN_TYPE::TT_ENUM },
-		{ "class", E_TOKEN_TYPE::TT_CLASS },
-		{ "struct", E_TOKEN_TYPE::TT_STRUCT },
-		{ "public", E_TOKEN_TYPE::TT_PUBLIC },
-		{ "protected", E_TOKEN_TYPE::TT_PROTECTED },
-		{ "private", E_TOKEN_TYPE::TT_PRIVATE },
-		{ "virtual", E_TOKEN_TYPE::TT_VIRTUAL },
-		{ "override", E_TOKEN_TYPE::TT_OVERRIDE },
-		{ "final", E_TOKEN_TYPE::TT_FINAL },
-		{ "template", E_TOKEN_TYPE::TT_TEMPLATE },
-		{ "ENUM_META", E_TOKEN_TYPE::TT_ENUM_META_ATTRIBUTE },
-		{ "CLASS_META", E_TOKEN_TYPE::TT_CLASS_META_ATTRIBUTE },
-		{ "INTERFACE_META", E_TOKEN_TYPE::TT_INTERFACE_META_ATTRIBUTE },
-		{ "BEGIN_IGNORE_META_SECTION", E_TOKEN_TYPE::TT_BEGIN_IGNORE_SECTION },
-		{ "END_IGNORE_META_SECTION", E_TOKEN_TYPE::TT_END_IGNORE_SECTION },
-		{ "SECTION", E_TOKEN_TYPE::TT_SECTION },
-		{ "char", E_TOKEN_TYPE::TT_CHAR },
-		{ "char16_t", E_TOKEN_TYPE::TT_CHAR16_T },
-		{ "char32_t", E_TOKEN_TYPE::TT_CHAR32_T },
-		{ "wchar_t", E_TOKEN_TYPE::TT_WCHAR_T },
-		{ "bool", E_TOKEN_TYPE::TT_BOOL },
-		{ "short", E_TOKEN_TYPE::TT_SHORT },
-		{ "int", E_TOKEN_TYPE::TT_INT },
-		{ "long", E_TOKEN_TYPE::TT_LONG },
-		{ "signed", E_TOKEN_TYPE::TT_SIGNED },
-		{ "unsigned", E_TOKEN_TYPE::TT_UNSIGNED },
-		{ "float", E_TOKEN_TYPE::TT_FLOAT },
-		{ "double", E_TOKEN_TYPE::TT_DOUBLE },
-		{ "void", E_TOKEN_TYPE::TT_VOID },
-		{ "auto", E_TOKEN_TYPE::TT_AUTO },
-		{ "decltype", E_TOKEN_TYPE::TT_DECLTYPE },
-		{ "typedef", E_TOKEN_TYPE::TT_TYPEDEF },
-		{ "{", E_TOKEN_TYPE::TT_OPEN_BRACE },
-		{ "}", E_TOKEN_TYPE::TT_CLOSE_BRACE },
-		{ "(", E_TOKEN_TYPE::TT_OPEN_PARENTHES },
-		{ ")", E_TOKEN_TYPE::TT_CLOSE_PARENTHES },
-		{ ":", E_TOKEN_TYPE::TT_COLON },
-		{ ";", E_TOKEN_TYPE::TT_SEMICOLON },
-		{ "=", E_TOKEN_TYPE::TT_ASSIGN_OP },
-		{ ",", E_TOKEN_TYPE::TT_COMMA },
-		{ "<", E_TOKEN_TYPE::TT_LESS },
-		{ ">", E_TOKEN_TYPE::TT_GREAT },
-	};
+	/*!
+		\brief MappedFileInputStream's definition
+	*/
+
+	MappedFileInputStream::MappedFileInputStream(const std::string& filename):
+		mFilename(filename)
+	{
+	}
+
+	MappedFileInputStream::~MappedFileInputStream()
+	{
+		Close();
+	}
+
+#if defined(_WIN32)
+
+	bool MappedFileInputStream::Open()
+	{
+		if (mIsOpened || mFilename.empty())
+		{
+			return false;
+		}
+
+		HANDLE fileHandle = CreateFileA(mFilename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (INVALID_HANDLE_VALUE == fileHandle)
+		{
+			return false;
+		}
+
+		mpFileHandle = fileHandle;
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(fileHandle, &fileSize))
+		{
+			Close();
+			return false;
+		}
+
+		mIsOpened = true;
+
+		const size_t size = static_cast<size_t>(fileSize.QuadPart);
+
+		if (!((size < mMinMappedFileSize) ? _readFile(size) : _mapFile(size)))
+		{
+			Close();
+			return false;
+		}
+
+		return true;
+	}
+
+	bool MappedFileInputStream::Close()
+	{
+		if (!mIsOpened && !mpFileHandle)
+		{
+			return false;
+		}
+
+		if (mIsMapped)
+		{
+			UnmapViewOfFile(mpData);
+		}
+
+		if (mpMappingHandle)
+		{
+			CloseHandle(static_cast<HANDLE>(mpMappingHandle));
+		}
+
+		if (mpFileHandle)
+		{
+			CloseHandle(static_cast<HANDLE>(mpFileHandle));
+		}
+
+		mpFileHandle = nullptr;
+		mpMappingHandle = nullptr;
+		mpData = nullptr;
+		mDataSize = 0;
+		mCurrReadPos = 0;
+		mIsMapped = false;
+		mIsOpened = false;
+
+		mFileContent.clear();
+
+		return true;
+	}
+
+	bool MappedFileInputStream::_mapFile(size_t fileSize)
+	{
+		HANDLE mappingHandle = CreateFileMappingA(static_cast<HANDLE>(mpFileHandle), nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!mappingHandle)
+		{
+			return _readFile(fileSize);
+		}
+
+		mpMappingHandle = mappingHandle;
+
+		if (!(mpData = static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0))))
+		{
+			return _readFile(fileSize);
+		}
+
+		mDataSize = fileSize;
+		mIsMapped = true;
+
+		return true;
+	}
+
+	bool MappedFileInputStream::_readFile(size_t fileSize)
+	{
+		mFileContent.resize(fileSize);
+
+		size_t totalBytesRead = 0;
+
+		while (totalBytesRead < fileSize)
+		{
+			const DWORD bytesToRead = static_cast<DWORD>((std::min<size_t>)(fileSize - totalBytesRead, static_cast<size_t>(MAXDWORD)));
+			DWORD bytesRead = 0;
+
+			if (!ReadFile(static_cast<HANDLE>(mpFileHandle), &mFileContent[totalBytesRead], bytesToRead, &bytesRead, nullptr) || !bytesRead)
+			{
+				break;
+			}
+
+			totalBytesRead += static_cast<size_t>(bytesRead);
+		}
+
+		mFileContent.resize(totalBytesRead);
+
+		mpData = mFileContent.data();
+		mDataSize = mFileContent.size();
+
+		return true;
+	}
+
+#else
+
+	bool MappedFileInputStream::Open()
+	{
+		if (mIsOpened || mFilename.empty())
+		{
+			return false;
+		}
+
+		if ((mFileDescriptor = ::open(mFilename.c_str(), O_RDONLY)) < 0)
+		{
+			return false;
+		}
+
+		struct stat fileInfo;
+
+		if (::fstat(mFileDescriptor, &fileInfo) != 0)
+		{
+			Close();
+			return false;
+		}
+
+		mIsOpened = true;
+
+		const size_t size = static_cast<size_t>(fileInfo.st_size);
+
+		const bool result = (size < mMinMappedFileSize) ? _readFile(size) : _mapFile(size);
+
+		// \note The mapping stays valid after the descriptor is closed
+		::close(mFileDescriptor);
+		mFileDescriptor = -1;
+
+		if (!result)
+		{
+			Close();
+			return false;
+		}
+
+		return true;
+	}
+
+	bool MappedFileInputStream::Close()
+	{
+		if (!mIsOpened && mFileDescriptor < 0)
+		{
+			return false;
+		}
+
+		if (mIsMapped)
+		{
+			::munmap(const_cast<char*>(mpData), mDataSize);
+		}
+
+		if (mFileDescriptor >= 0)
+		{
+			::close(mFileDescriptor);
+		}
+
+		mFileDescriptor = -1;
+		mpData = nullptr;
+		mDataSize = 0;
+		mCurrReadPos = 0;
+		mIsMapped = false;
+		mIsOpened = false;
+
+		mFileContent.clear();
+
+		return true;
+	}
+
+	bool MappedFileInputStream::_mapFile(size_t fileSize)
+	{
+		void* pMappedData = ::mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, mFileDescriptor, 0);
+		if (MAP_FAILED == pMappedData)
+		{
+			return _readFile(fileSize);
+		}
+
+#if defined(POSIX_MADV_SEQUENTIAL)
+		::posix_madvise(pMappedData, fileSize, POSIX_MADV_SEQUENTIAL);
+#endif
+
+		mpData = static_cast<const char*>(pMappedData);
+		mDataSize = fileSize;
+		mIsMapped = true;
+
+		return true;
+	}
+
+	bool MappedFileInputStream::_readFile(size_t fileSize)
+	{
+		mFileContent.resize(fileSize);
+
+		size_t totalBytesRead = 0;
+		ssize_t bytesRead = 0;
+
+		while (totalBytesRead < fileSize && (bytesRead = ::read(mFileDescriptor, &mFileContent[totalBytesRead], fileSize - totalBytesRead)) > 0)
+		{
+			totalBytesRead += static_cast<size_t>(bytesRead);
+		}
+
+		if (bytesRead < 0)
+		{
+			return false;
+		}
+
+		mFileContent.resize(totalBytesRead);
+
+		mpData = mFileContent.data();
+		mDataSize = mFileContent.size();
+
+		return true;
+	}
+
+#endif
+
+	std::string MappedFileInputStream::ReadLine()
+	{
+		if (!mIsOpened || mCurrReadPos >= mDataSize)
+		{
+			return {};
+		}
+
+		const char* pLineStart = mpData + mCurrReadPos;
+		const char* pLineEnd = static_cast<const char*>(std::memchr(pLineStart, '\n', mDataSize - mCurrReadPos));
+
+		const size_t lineLength = pLineEnd ? static_cast<size_t>(pLineEnd - pLineStart) + 1 : (mDataSize - mCurrReadPos);
+
+		mCurrReadPos += lineLength;
+
+		return std::string(pLineStart, lineLength);
+	}
+
+	std::optional<std::string_view> MappedFileInputStream::GetBuffer() const
+	{
+		if (!mIsOpened)
+		{
+			return std::nullopt;
+		}
+
+		return std::string_view(mpData, mDataSize);
+	}
+
 
 	Lexer::Lexer(IInputStream& streamSource):
-		mpStream(&streamSource), mCurrProcessedText()
+		mpStream(&streamSource), mpScanKernels(&GetScanKernels())
 	{
+		_initSourceBuffer();
+
+		mLinesIndex = LinesIndex(mSourceText);
 	}
 
 	const TToken& Lexer::GetCurrToken()
 	{
-		if (mTokensQueue.empty() && !mLastScannedToken.mIsValid)
+		if (!mLastScannedToken.mIsValid)
 		{
 			return GetNextToken();
 		}
@@ -120,12 +369,10 @@ namespace TDEngine2
 
 	TToken Lexer::_skipIgnoredTokensSection()
 	{
-		TToken currToken = _scanToken();
+		/// \note The section is skipped over raw bytes, so tokens within it aren't scanned at all
+		const size_t sectionEndPos = FindIgnoreSectionEnd(*mpScanKernels, mSourceText, mNextCharPos);
 
-		while (E_TOKEN_TYPE::TT_EOF != currToken.mType && E_TOKEN_TYPE::TT_END_IGNORE_SECTION != currToken.mType)
-		{
-			currToken = _scanToken();
-		}
+		_moveCursor(sectionEndPos - 1);
 
 		return _scanToken(); // \note Scan next token right after END_IGNORE_META_SECTION keyword
 	}
@@ -147,7 +394,7 @@ namespace TDEngine2
 		*/
 		if (E_TOKEN_TYPE::TT_BEGIN_IGNORE_SECTION == currToken.mType)
 		{
-			currToken = std::move(_skipIgnoredTokensSection());
+			currToken = _skipIgnoredTokensSection();
 		}
 
 		return currToken;
@@ -155,10 +402,12 @@ namespace TDEngine2
 
 	const TToken& Lexer::GetNextToken()
 	{
-		if (!mTokensQueue.empty())
+		if (mLookaheadTokensCount)
 		{
-			mLastScannedToken = mTokensQueue.front();
-			mTokensQueue.erase(mTokensQueue.cbegin());
+			mLastScannedToken = mLookaheadTokens[mLookaheadFirstIndex];
+
+			mLookaheadFirstIndex = (mLookaheadFirstIndex + 1) & (mMaxLookaheadTokensCount - 1);
+			--mLookaheadTokensCount;
 
 			return mLastScannedToken;
 		}
@@ -167,27 +416,94 @@ namespace TDEngine2
 		return mLastScannedToken;
 	}
 
+	static_assert(!(Lexer::mMaxLookaheadTokensCount & (Lexer::mMaxLookaheadTokensCount - 1)), "The lookahead window's size should be a power of two");
+
 	const TToken& Lexer::PeekToken(uint32_t offset)
 	{
+		const TToken& currToken = GetCurrToken();
+
 		if (!offset)
 		{
-			mTokensQueue.emplace_back(std::move(_getNextTokenImpl()));
-			return mTokensQueue.front();
+			return currToken;
+		}
+
+		assert(offset <= mMaxLookaheadTokensCount);
+		offset = (std::min)(offset, mMaxLookaheadTokensCount);
+
+		while (mLookaheadTokensCount < offset)
+		{
+			mLookaheadTokens[(mLookaheadFirstIndex + mLookaheadTokensCount) & (mMaxLookaheadTokensCount - 1)] = _getNextTokenImpl();
+			++mLookaheadTokensCount;
 		}
 
-		if (size_t pos = static_cast<size_t>(offset); pos < mTokensQueue.size())
+		return mLookaheadTokens[(mLookaheadFirstIndex + offset - 1) & (mMaxLookaheadTokensCount - 1)];
+	}
+
+	bool Lexer::SkipBalancedBlock()
+	{
+		const TToken& currToken = GetCurrToken();
+		if (E_TOKEN_TYPE::TT_OPEN_BRACE != currToken.mType)
 		{
-			return mTokensQueue[pos];
+			return false;
 		}
 
-		const size_t count = static_cast<size_t>(offset - mTokensQueue.size());
+		const size_t blockEndPos = FindBalancedBlockEnd(*mpScanKernels, mSourceText, currToken.mOffset);
+
+		/// \note Drop peeked tokens that belong to the block, the rest of them go right after it
+		while (mLookaheadTokensCount && mLookaheadTokens[mLookaheadFirstIndex].mOffset < blockEndPos)
+		{
+			mLookaheadFirstIndex = (mLookaheadFirstIndex + 1) & (mMaxLookaheadTokensCount - 1);
+			--mLookaheadTokensCount;
+		}
 
-		for (size_t i = 0; i < count; ++i)
+		if (!mLookaheadTokensCount && mNextCharPos < blockEndPos)
 		{
-			mTokensQueue.emplace_back(std::move(_getNextTokenImpl()));
+			_moveCursor(blockEndPos - 1);
 		}
 
-		return mTokensQueue.back();
+		GetNextToken();
+
+		return true;
+	}
+
+	TTokensArray Lexer::Tokenize(ParsingBudget* pBudget)
+	{
+		TTokensArray tokens;
+
+		if (!mOwnedSourceText.empty())
+		{
+			/// \note The buffer is moved into the array, so its tokens outlive the lexer. The text is heap allocated, so the views stay valid
+			tokens.mpOwnedSourceText = std::make_unique<std::string>(std::move(mOwnedSourceText));
+			mSourceText = *tokens.mpOwnedSourceText;
+			mLinesIndex = LinesIndex(mSourceText);
+		}
+
+		tokens.mSourceText = mSourceText;
+		tokens.Reserve(mSourceText.size() / 8); // \note A rough estimation for an average header
+
+		for (const TToken* pCurrToken = &GetCurrToken(); ; pCurrToken = &GetNextToken())
+		{
+			if (pBudget && !pBudget->ConsumeTokens())
+			{
+				/// \note EOF is placed right after the last scanned lexeme, so it has the same position as the lexeme
+				tokens.Add(TToken{ E_TOKEN_TYPE::TT_EOF, {}, pCurrToken->mOffset + static_cast<uint32_t>(pCurrToken->mValue.size()) });
+				break;
+			}
+
+			tokens.Add(*pCurrToken);
+
+			if (E_TOKEN_TYPE::TT_EOF == pCurrToken->mType)
+			{
+				break;
+			}
+		}
+
+		return tokens;
+	}
+
+	TToken::TCursorPos Lexer::GetCursorPos(const TToken& token)
+	{
+		return mLinesIndex.GetCursorPos(token);
 	}
 
 	TToken Lexer::_scanToken()
@@ -220,7 +536,7 @@ namespace TDEngine2
 				return *keywordToken;
 			}
 
-			return TToken(E_TOKEN_TYPE::TT_UNKNOWN, "", std::tuple<uint32_t, uint32_t>(mCurrHorPosIndex, mCurrLineIndex));
+			return TToken(E_TOKEN_TYPE::TT_UNKNOWN, mSourceText.substr(mNextCharPos - 1, 1), static_cast<uint32_t>(mNextCharPos - 1));
 		}
 
 		/*while (!eof)
@@ -236,20 +552,10 @@ namespace TDEngine2
 
 	void Lexer::_skipWhitespaces()
 	{
-		char ch = '\0';
-
-		bool skipped = false;
-
-		while (std::isspace(ch = _getCurrChar()))
+		while (IsWhitespaceChar(_getCurrChar()))
 		{
-			while (std::isspace(ch = _getCurrChar()))
+			while (IsWhitespaceChar(_getCurrChar()))
 			{
-				if (ch == '\n' || ch == '\r')
-				{
-					mCurrHorPosIndex = 0;
-					++mCurrLineIndex;
-				}
-
 				_getNextChar();
 			}
 
@@ -267,61 +573,31 @@ namespace TDEngine2
 			return false;
 		}
 		
-		int depth = 1;
-
-		while (depth > 0)
-		{
-			char ch = _getNextChar();
-
-			if (ch == '\\')
-			{
-				++depth;
-			}
-
-			if ((ch == '\n') || (ch == '\r') || (ch == -1))
-			{
-				--depth;
-			}
-		}
+		_moveCursor(FindMacroDefinitionEnd(*mpScanKernels, mSourceText, mNextCharPos));
 
 		return true;
 	}
 
 	char Lexer::_getCurrChar() const
 	{
-		return mCurrProcessedText.empty() ? EOF : mCurrProcessedText.front();
+		return (mNextCharPos > 0 && mNextCharPos <= mSourceText.size()) ? mSourceText[mNextCharPos - 1] : EOF;
 	}
 
 	char Lexer::_getNextChar()
 	{
-		if (!mCurrProcessedText.empty())
-		{
-			mCurrProcessedText.erase(0, 1);
-		}
-
-		if (mCurrProcessedText.empty())
-		{
-			mCurrProcessedText.append(mpStream->ReadLine());
-		}
-
-		if (mCurrProcessedText.empty()) // \note if it's still empty then we've reached end of the text
+		if (mNextCharPos >= mSourceText.size()) // \note we've reached end of the text
 		{
+			mNextCharPos = mSourceText.size() + 1;
 			return EOF;
 		}
 
-		++mCurrHorPosIndex;
-
-		return mCurrProcessedText.front();
+		return mSourceText[mNextCharPos++];
 	}
 
 	char Lexer::_peekNextChar(uint32_t offset)
 	{
-		if (offset >= mCurrProcessedText.size())
-		{
-			mCurrProcessedText.append(mpStream->ReadLine());
-		}
-
-		return mCurrProcessedText[offset];
+		const size_t pos = mNextCharPos + static_cast<size_t>(offset) - 1;
+		return (mNextCharPos > 0 && pos < mSourceText.size()) ? mSourceText[pos] : EOF;
 	}
 
 	std::optional<TToken> Lexer::_parseNumbers()
@@ -333,39 +609,39 @@ namespace TDEngine2
 	{
 		char ch = _getCurrChar();
 
-		std::string possibleIdentifier{ ch };
-
 		// \note try to detect identifier
-		if (std::isalpha(ch) || ch == '_')
+		if (IsIdentifierStartChar(ch))
 		{
-			while (((ch = _peekNextChar(1)) != EOF) && (std::isalnum(ch) || ch == '_'))
-			{
-				possibleIdentifier.push_back(ch);
-				_getNextChar();
-			}
+			const size_t identifierStartPos = mNextCharPos - 1;
 
-			auto&& iter = mReservedTokens.find(possibleIdentifier);
-			if (iter != mReservedTokens.cend())
+			mNextCharPos = mpScanKernels->mpFindIdentifierEnd(mSourceText, mNextCharPos);
+
+			const std::string_view identifier = mSourceText.substr(identifierStartPos, mNextCharPos - identifierStartPos);
+			const uint32_t offset = static_cast<uint32_t>(identifierStartPos);
+
+			TToken token{ GetKeywordTokenType(identifier), identifier, offset };
+
+			if (E_TOKEN_TYPE::TT_IDENTIFIER == token.mType)
 			{
-				return TToken{ iter->second, possibleIdentifier, { mCurrHorPosIndex, mCurrLineIndex } };
+				token.mAtomId = AtomTable::Get().Intern(identifier);
 			}
-			
-			return TToken{ E_TOKEN_TYPE::TT_IDENTIFIER, possibleIdentifier, { mCurrHorPosIndex, mCurrLineIndex } };
+
+			return token;
 		}
 
 		// \note try to detect symbol
-		auto&& iter = mReservedTokens.find(possibleIdentifier);
-		if (iter == mReservedTokens.cend())
+		const E_TOKEN_TYPE symbolType = GetSymbolTokenType(ch);
+		if (E_TOKEN_TYPE::TT_UNKNOWN == symbolType)
 		{
 			if (_getCurrChar() == EOF)
 			{
-				return TToken{ E_TOKEN_TYPE::TT_EOF, "", std::tuple<uint32_t, uint32_t>(mCurrHorPosIndex, mCurrLineIndex)};
+				return TToken{ E_TOKEN_TYPE::TT_EOF, "", static_cast<uint32_t>(mSourceText.size()) };
 			}
 
 			return std::nullopt;
 		}
 
-		return TToken{ iter->second, "", std::tuple<uint32_t, uint32_t>(mCurrHorPosIndex, mCurrLineIndex) };
+		return TToken{ symbolType, mSourceText.substr(mNextCharPos - 1, 1), static_cast<uint32_t>(mNextCharPos - 1) };
 	}
 
 	bool Lexer::_skipComments()
@@ -377,7 +653,7 @@ namespace TDEngine2
 
 		char ch = _peekNextChar(1);
 
-		if (std::isspace(ch))
+		if (IsWhitespaceChar(ch))
 		{
 			// increment counter of lines
 			return false;
@@ -404,45 +680,54 @@ namespace TDEngine2
 
 	void Lexer::_skipSingleLineComment()
 	{
-		char ch = ' ';
-
-		while ((ch = _getNextChar()) != EOF && ch != '\n') {}
-
-		// \todo increment counter of lines
+		/// \note The current char is the first one after "//"
+		_moveCursor(mpScanKernels->mpFindNewLine(mSourceText, mNextCharPos - 1));
 	}
 
 	void Lexer::_skipMultiLineComment()
 	{
-		char currCh = ' ';
-		char nextCh = ' ';
+		/// \note Comments could be nested, the current char is the first one after the opening "/*"
+		uint32_t depth = 1;
 
-		/*uint32_t x = mCurrPos;
-		uint32_t y = mCurrLine;*/
+		size_t pos = mNextCharPos - 1;
 
-		while (((currCh = _getNextChar()) != EOF && currCh != '*') ||
-			(currCh == '*' && (nextCh = _peekNextChar(1)) != '/'))
-		{
-			_skipComments();
-		}
-
-		switch (currCh)
+		while (depth > 0)
 		{
-			case EOF:
+			pos = mpScanKernels->mpFindCommentDelimiter(mSourceText, pos);
+			if (pos >= mSourceText.size())
+			{
 				// the end of the file was reached, but there is no end of the comment
-				//OnErrorOutput.Invoke({ LE_INVALID_END_OF_MULTILINE_COMMENT, x, y });
 				break;
+			}
 
-			case '*':
-				// try to read '/'
-				currCh = _getNextChar();
+			depth = (mSourceText[pos] == '/') ? (depth + 1) : (depth - 1);
+			pos += (depth > 0) ? 2 : 1; // \note The last '/' becomes the current char
+		}
 
-				if (currCh != '/')
-				{
-					// invalid end of the multi-line comment
-					//OnErrorOutput.Invoke({ LE_INVALID_END_OF_MULTILINE_COMMENT, x, y });
-				}
+		_moveCursor(pos);
+	}
 
-				break;
+	void Lexer::_moveCursor(size_t pos)
+	{
+		/// \note The character at pos becomes the current one, so the position right after the text means EOF
+		mNextCharPos = (std::min)(pos, mSourceText.size()) + 1;
+	}
+
+	void Lexer::_initSourceBuffer()
+	{
+		if (auto&& buffer = mpStream->GetBuffer())
+		{
+			mSourceText = *buffer;
+			return;
+		}
+
+		std::string line;
+
+		while (!(line = mpStream->ReadLine()).empty())
+		{
+			mOwnedSourceText.append(line);
 		}
+
+		mSourceText = mOwnedSourceText;
 	}
 }
\ No newline at end of file
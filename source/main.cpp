@@ -6,6 +6,7 @@
 #include "../include/symtable.h"
 #include "../include/codegenerator.h"
 #include "../include/jobmanager.h"
+#include "../include/fingerprint.h"
 #include "../deps/archive/archive.h"
 #include "../deps/Wrench/source/stringUtils.hpp"
 #include "../deps/Wrench/source/deferOperation.hpp"
@@ -35,6 +36,34 @@ int main(int argc, const char** argv)
 		std::cout.clear();
 	});
 
+	TCacheData::TEvictionPolicy evictionPolicy;
+	evictionPolicy.mSizeLimit = static_cast<uint64_t>(options.mCacheSizeLimit) << 20;
+	evictionPolicy.mMaxAge = static_cast<uint64_t>(options.mCacheMaxAge) * 24 * 60 * 60;
+
+	if (options.mIsCacheGCModeEnabled)
+	{
+		if (!fs::exists(options.mCacheDirname))
+		{
+			WriteOutput("Nothing to collect... Exit\n");
+			return 0;
+		}
+
+		/// \note Nothing is parsed, the index is loaded and saved back, so Save drops stale entries, evicts ones that don't fit into the limits and compacts the pack
+		TCacheData cachedData;
+		cachedData.Load(options.mCacheDirname, options.mCacheIndexFilename);
+		cachedData.SetOptionsDigest(GetOptionsDigest(options));
+		cachedData.SetEvictionPolicy(evictionPolicy);
+
+		if (!cachedData.Save(options.mCacheDirname, options.mCacheIndexFilename))
+		{
+			WriteOutput("Error: the cache couldn't be saved\n");
+			return -1;
+		}
+
+		WriteOutput(std::string("Cache contains ").append(std::to_string(cachedData.GetSymTablesIndex().size())).append(" tables\n"));
+		return 0;
+	}
+
 	// \note Scan given directory for cpp header files
 	const std::vector<std::string>& filesToProcess = GetHeaderFiles(options.mInputSources, options.mPathsToExclude);
 	if (filesToProcess.empty())
@@ -55,14 +84,13 @@ int main(int argc, const char** argv)
 	createDirectoryIfDoesntExist(options.mCacheDirname);
 	createDirectoryIfDoesntExist(options.mOutputDirname);
 
+	const std::string optionsDigest = GetOptionsDigest(options);
+
+	/// \note Entries are valid per file, so runs over other sets of headers reuse them too
 	TCacheData cachedData;
 	cachedData.Load(options.mCacheDirname, options.mCacheIndexFilename);
-
-	if (cachedData.GetInputHash() != GetHashFromInputFiles(options.mInputSources)) // \note Reset cache if we introspect another headers pack
-	{
-		// \todo Remove all cached files
-		cachedData.Reset();
-	}
+	cachedData.SetOptionsDigest(optionsDigest);
+	cachedData.SetEvictionPolicy(evictionPolicy);
 
 	CodeGenerator::TSymbolTablesArray symbolsPerFile { filesToProcess.size() };
 
@@ -74,45 +102,38 @@ int main(int argc, const char** argv)
 		// \note Build symbol tables for each header file
 		for (size_t i = 0; i < filesToProcess.size(); ++i)
 		{
-			jobManager.SubmitJob(std::function<void()>([&filesToProcess, &symbolsPerFile, &cachedData, i, &options, cacheDirectory = options.mCacheDirname, isForceModeEnabled]
+			jobManager.SubmitJob(std::function<void()>([&filesToProcess, &symbolsPerFile, &cachedData, i, &options, isForceModeEnabled, optionsDigest]
 			{
 				const std::string& filename = filesToProcess[i];
-				const std::string hash = GetHashFromFilePath(filename);
-
-				const auto& cachePath = fs::path(cacheDirectory).concat(hash).string();
+				FileFingerprint fingerprint(filename);
 
-				if (cachedData.Contains(filename, hash) && !isForceModeEnabled)
+				if (!isForceModeEnabled)
 				{
-					// \note If the specified file exists then reuse data inside it
-					std::ifstream symTableSourceFile(cachePath, std::ios::binary);
-
-					if (symTableSourceFile.is_open())
+					// \note If the table is within the cache then reuse it, tables that were saved with another layout are parsed again
+					if (auto pCachedSymTable = cachedData.LoadSymTable(filename, fingerprint))
 					{
 						WriteOutput(std::string("\n").append("Reuse cached version of ").append(filename).append(" file... "));
 
-						Archive<std::ifstream> symTableSourceArchive(symTableSourceFile);
+						if (pCachedSymTable->IsSkipped())
+						{
+							WriteOutput("skipped (budget exceeded)\n");
+						}
 
-						symbolsPerFile[i] = std::make_unique<SymTable>();
-						symbolsPerFile[i]->Load(symTableSourceArchive);
-
-						symTableSourceFile.close();
+						symbolsPerFile[i] = std::move(pCachedSymTable);
 
 						return;
-					}					
+					}
 				}
 
+				/// \note The content is hashed before it's parsed, so changes that happen meanwhile are caught by the next run
+				const std::string contentHash = fingerprint.GetContentHash();
+
 				symbolsPerFile[i] = std::move(ProcessHeaderFile(options, filename));
 
-				// \note Serialize data
+				// \note Serialize data, images are appended into the pack when the cache is saved
+				if (symbolsPerFile[i] && !contentHash.empty())
 				{
-					std::ofstream symTableOutputFile(cachePath, std::ios::binary);
-					Archive<std::ofstream> symTableOutputArchive(symTableOutputFile);
-
-					symbolsPerFile[i]->Save(symTableOutputArchive);
-
-					symTableOutputFile.close();
-
-					cachedData.AddSymTableEntity(filename, hash);
+					cachedData.AddSymTableEntity(filename, contentHash, fingerprint.GetStat(), symbolsPerFile[i]->SaveImage(optionsDigest));
 				}
 			}));
 		}
@@ -135,7 +156,6 @@ int main(int argc, const char** argv)
 	}
 
 	// \note Update cache if the feature isn't disabled
-	cachedData.SetInputHash(GetHashFromInputFiles(options.mInputSources));
 	cachedData.Save(options.mCacheDirname, options.mCacheIndexFilename);
 
 	return 0;
@@ -0,0 +1,138 @@
+#include "../include/memoryarena.h"
+#include <cstdlib>
+#include <cassert>
+#include <array>
+#include <algorithm>
+
+
+namespace TDEngine2
+{
+	namespace
+	{
+		constexpr size_t MaxCachedChunksCount = 64;
+
+
+		/*!
+			\brief The cache keeps chunks of the default size that were released on the current thread
+		*/
+
+		struct TThreadLocalChunksCache
+		{
+			std::array<void*, MaxCachedChunksCount> mpChunks {};
+			size_t                                  mChunksCount = 0;
+
+			~TThreadLocalChunksCache()
+			{
+				for (size_t i = 0; i < mChunksCount; ++i)
+				{
+					std::free(mpChunks[i]);
+				}
+			}
+		};
+
+
+		thread_local TThreadLocalChunksCache ChunksCache;
+
+
+		uintptr_t AlignPos(uintptr_t pos, size_t alignment)
+		{
+			return (pos + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+		}
+	}
+
+
+	MemoryArena::~MemoryArena()
+	{
+		Reset();
+	}
+
+	void* MemoryArena::Allocate(size_t size, size_t alignment)
+	{
+		assert(alignment && !(alignment & (alignment - 1)));
+
+		uintptr_t pos = AlignPos(mCurrPos, alignment);
+
+		if (!mpChunks || pos + size > mEndPos)
+		{
+			_allocateChunk(size + alignment);
+			pos = AlignPos(mCurrPos, alignment);
+		}
+
+		mCurrPos = pos + size;
+		mUsedBytes += size;
+
+		return reinterpret_cast<void*>(pos);
+	}
+
+	void MemoryArena::Reset()
+	{
+		for (TDestructorRecord* pCurrRecord = mpDestructors; pCurrRecord; pCurrRecord = pCurrRecord->mpNext)
+		{
+			pCurrRecord->mpDestructor(pCurrRecord->mpObject);
+		}
+
+		while (mpChunks)
+		{
+			TChunkHeader* pNextChunk = mpChunks->mpNext;
+			_releaseChunk(mpChunks);
+			mpChunks = pNextChunk;
+		}
+
+		mpDestructors = nullptr;
+		mCurrPos = mEndPos = 0;
+		mUsedBytes = 0;
+	}
+
+	void MemoryArena::_registerDestructor(void* pObject, void (*pDestructor)(void*))
+	{
+		TDestructorRecord* pRecord = new (Allocate(sizeof(TDestructorRecord), alignof(TDestructorRecord))) TDestructorRecord { pDestructor, pObject, mpDestructors };
+		mpDestructors = pRecord;
+	}
+
+	void MemoryArena::_allocateChunk(size_t minSize)
+	{
+		TChunkHeader* pChunk = _acquireChunk((std::max)(mDefaultChunkSize, minSize + sizeof(TChunkHeader)));
+
+		pChunk->mpNext = mpChunks;
+		mpChunks = pChunk;
+
+		mCurrPos = reinterpret_cast<uintptr_t>(pChunk) + sizeof(TChunkHeader);
+		mEndPos = reinterpret_cast<uintptr_t>(pChunk) + pChunk->mSize;
+	}
+
+	MemoryArena::TChunkHeader* MemoryArena::_acquireChunk(size_t size)
+	{
+		void* pMemory = nullptr;
+
+		if (mDefaultChunkSize == size && ChunksCache.mChunksCount)
+		{
+			pMemory = ChunksCache.mpChunks[--ChunksCache.mChunksCount];
+		}
+		else
+		{
+			pMemory = std::malloc(size);
+		}
+
+		if (!pMemory)
+		{
+			throw std::bad_alloc();
+		}
+
+		TChunkHeader* pChunk = static_cast<TChunkHeader*>(pMemory);
+		pChunk->mpNext = nullptr;
+		pChunk->mSize = size;
+
+		return pChunk;
+	}
+
+	void MemoryArena::_releaseChunk(TChunkHeader* pChunk)
+	{
+		if (mDefaultChunkSize == pChunk->mSize && ChunksCache.mChunksCount < MaxCachedChunksCount)
+		{
+			ChunksCache.mpChunks[ChunksCache.mChunksCount++] = pChunk;
+			return;
+		}
+
+		std::free(pChunk);
+	}
+}
@@ -2,18 +2,109 @@
 #include "../include/lexer.h"
 #include "../include/tokens.h"
 #include "../include/symtable.h"
+#include "../include/parsingbudget.h"
 #include "../include/common.h"
+#include "../include/prefilter.h"
 #define STR_UTILS_IMPLEMENTATION
 #include "../deps/Wrench/source/stringUtils.hpp"
 #define DEFER_IMPLEMENTATION
 #include "../deps/Wrench/source/deferOperation.hpp"
 #include <cassert>
-#include <unordered_set>
-#include <stack>
+#include <algorithm>
 
 
 namespace TDEngine2
 {
+	namespace
+	{
+		TAtom GetTokenAtom(const TToken& token)
+		{
+			return (TToken::mInvalidAtomId == token.mAtomId) ? TAtom{ token.mValue } : TAtom::FromId(token.mAtomId); // \note Identifiers are interned by the lexer
+		}
+
+
+		/*!
+			\brief Every token type is mapped onto a class byte, the lowest bits contain a kind of brackets
+			and the flags tell whether the token opens or closes them
+		*/
+
+		constexpr uint8_t BalancedTokenKindMask = 0x3;
+		constexpr uint8_t OpenBalancedTokenFlag = 0x4;
+		constexpr uint8_t CloseBalancedTokenFlag = 0x8;
+
+		constexpr size_t TokenTypesCount = static_cast<size_t>(E_TOKEN_TYPE::TT_UNKNOWN) + 1;
+
+		constexpr std::array<E_TOKEN_TYPE, 3> CloseBalancedTokens { E_TOKEN_TYPE::TT_CLOSE_BRACE, E_TOKEN_TYPE::TT_CLOSE_PARENTHES, E_TOKEN_TYPE::TT_GREAT };
+
+
+		constexpr std::array<uint8_t, TokenTypesCount> BuildBalancedTokenClasses()
+		{
+			std::array<uint8_t, TokenTypesCount> classes {};
+
+			classes[static_cast<size_t>(E_TOKEN_TYPE::TT_OPEN_BRACE)]      = OpenBalancedTokenFlag | 0;
+			classes[static_cast<size_t>(E_TOKEN_TYPE::TT_OPEN_PARENTHES)]  = OpenBalancedTokenFlag | 1;
+			classes[static_cast<size_t>(E_TOKEN_TYPE::TT_LESS)]            = OpenBalancedTokenFlag | 2;
+			classes[static_cast<size_t>(E_TOKEN_TYPE::TT_CLOSE_BRACE)]     = CloseBalancedTokenFlag | 0;
+			classes[static_cast<size_t>(E_TOKEN_TYPE::TT_CLOSE_PARENTHES)] = CloseBalancedTokenFlag | 1;
+			classes[static_cast<size_t>(E_TOKEN_TYPE::TT_GREAT)]           = CloseBalancedTokenFlag | 2;
+
+			return classes;
+		}
+
+
+		constexpr std::array<uint8_t, TokenTypesCount> BalancedTokenClasses = BuildBalancedTokenClasses();
+
+
+		constexpr uint8_t GetBalancedTokenClass(E_TOKEN_TYPE type)
+		{
+			return BalancedTokenClasses[static_cast<size_t>(type)];
+		}
+
+
+		/*!
+			\brief The stack keeps kinds of opened brackets as 2-bit entries within a fixed bitset. Levels that are
+			deeper than mMaxTrackedDepth are only counted, any closing bracket matches them
+		*/
+
+		class TBalancedTokensStack
+		{
+			public:
+				static constexpr uint32_t mMaxTrackedDepth = 512;
+				static constexpr uint8_t  mAnyKind = 0xFF;
+			public:
+				void Push(uint8_t kind) TDE2_NOEXCEPT
+				{
+					if (mDepth < mMaxTrackedDepth)
+					{
+						const uint32_t shift = (mDepth & 31) << 1;
+						uint64_t& word = mKinds[mDepth >> 5];
+
+						word = (word & ~(static_cast<uint64_t>(BalancedTokenKindMask) << shift)) | (static_cast<uint64_t>(kind) << shift);
+					}
+
+					++mDepth;
+				}
+
+				uint8_t Pop() TDE2_NOEXCEPT
+				{
+					assert(mDepth > 0);
+
+					if (--mDepth >= mMaxTrackedDepth)
+					{
+						return mAnyKind;
+					}
+
+					return static_cast<uint8_t>((mKinds[mDepth >> 5] >> ((mDepth & 31) << 1)) & BalancedTokenKindMask);
+				}
+
+				bool IsEmpty() const TDE2_NOEXCEPT { return !mDepth; }
+			private:
+				std::array<uint64_t, mMaxTrackedDepth / 32> mKinds;
+				uint32_t                                    mDepth = 0;
+		};
+	}
+
+
 	std::string TParserError::ToString() const
 	{
 		std::string result = "";
@@ -39,6 +130,17 @@ namespace TDEngine2
 					.append("\'");
 			}
 				break;
+			case TParserError::E_PARSER_ERROR_CODE::BUDGET_EXCEEDED:
+			{
+				result
+					.append(std::to_string(mData.mBudgetExceededErrData.mTokensCount))
+					.append(" tokens were scanned in ")
+					.append(std::to_string(mData.mBudgetExceededErrData.mElapsedTime))
+					.append(" ms");
+			}
+				break;
+			default:
+				break;
 		}
 
 		return result;
@@ -50,22 +152,224 @@ namespace TDEngine2
 		{
 			case TParserError::E_PARSER_ERROR_CODE::UNEXPECTED_SYMBOL:
 				return "Unexpected symbol found";
+			case TParserError::E_PARSER_ERROR_CODE::BUDGET_EXCEEDED:
+				return "File skipped: budget exceeded";
+			default:
+				break;
 		}
 
 		return "";
 	}
 
 
-	Parser::Parser(Lexer& lexer, SymTable& symTable, const TIntrospectorOptions& options, const TOnErrorCallback& onErrorCallback):
-		mpLexer(&lexer), mpSymTable(&symTable), mOnErrorCallback(onErrorCallback), mOptions(options)
+	std::vector<TDeclarationsChunk> SplitIntoDeclarationsChunks(const TTokensArray& tokens, size_t minTokensCount)
+	{
+		std::vector<TDeclarationsChunk> chunks;
+
+		const size_t tokensCount = tokens.GetSize() ? (tokens.GetSize() - 1) : 0; // \note EOF doesn't belong to any chunk
+
+		auto&& types = tokens.mTypes;
+
+		auto getType = [&types, tokensCount](size_t index)
+		{
+			return (index < tokensCount) ? types[index] : E_TOKEN_TYPE::TT_EOF;
+		};
+
+		TDeclarationsChunk currChunk;
+
+		std::string currSectionId;
+
+		uint32_t depth = 0;
+
+		bool hasPendingEnumTag = false; ///< ENUM_META or CLASS_META were met but a declaration that takes them wasn't
+		bool hasPendingClassTag = false;
+		bool isNestedDeclaration = false; ///< True for a declaration after typedef or template's parameters, it doesn't take tags
+
+		auto cutChunk = [&chunks, &currChunk](size_t endTokenIndex, size_t nextChunkFirstTokenIndex)
+		{
+			currChunk.mEndTokenIndex = endTokenIndex;
+			chunks.push_back(currChunk);
+
+			currChunk.mFirstTokenIndex = nextChunkFirstTokenIndex;
+		};
+
+		for (size_t i = 0; i < tokensCount; ++i)
+		{
+			const E_TOKEN_TYPE currType = types[i];
+
+			/// \note The parser skips closing braces of namespaces as unknown tokens, so only other blocks are counted
+			if (E_TOKEN_TYPE::TT_OPEN_BRACE == currType)
+			{
+				++depth;
+				continue;
+			}
+
+			if (E_TOKEN_TYPE::TT_CLOSE_BRACE == currType)
+			{
+				depth -= (depth > 0) ? 1 : 0;
+				continue;
+			}
+
+			if (depth > 0)
+			{
+				continue;
+			}
+
+			const bool isTagTaken = !isNestedDeclaration;
+			isNestedDeclaration = false;
+
+			switch (currType)
+			{
+				case E_TOKEN_TYPE::TT_NAMESPACE:
+				{
+					const bool isNamed = (E_TOKEN_TYPE::TT_IDENTIFIER == getType(i + 1));
+					const size_t openBraceIndex = i + (isNamed ? 2 : 1);
+
+					if (!isTagTaken || E_TOKEN_TYPE::TT_OPEN_BRACE != getType(openBraceIndex))
+					{
+						return {};
+					}
+
+					/// \note A body of a namespace is parsed as a new declarations sequence that lasts up to the end of the file
+					cutChunk(i, openBraceIndex + 1);
+
+					if (isNamed)
+					{
+						currChunk.mNamespaces.push_back(GetTokenAtom(tokens.GetToken(i + 1)));
+					}
+
+					currChunk.mIsWithinNamespace = true;
+					currChunk.mSectionId.clear();
+					currSectionId.clear();
+
+					hasPendingEnumTag = hasPendingClassTag = false;
+
+					i = openBraceIndex;
+					break;
+				}
+
+				case E_TOKEN_TYPE::TT_TEMPLATE:
+					while (i + 1 < tokensCount && E_TOKEN_TYPE::TT_GREAT != types[i + 1]) // \note Template's parameters are skipped up to the first >
+					{
+						++i;
+					}
+
+					++i;
+					isNestedDeclaration = true;
+					break;
+
+				case E_TOKEN_TYPE::TT_TYPEDEF:
+					isNestedDeclaration = true;
+					break;
+
+				case E_TOKEN_TYPE::TT_ENUM:
+					hasPendingEnumTag &= !isTagTaken;
+
+					if (E_TOKEN_TYPE::TT_CLASS == getType(i + 1) || E_TOKEN_TYPE::TT_STRUCT == getType(i + 1))
+					{
+						++i;
+					}
+
+					break;
+
+				case E_TOKEN_TYPE::TT_CLASS:
+				case E_TOKEN_TYPE::TT_STRUCT:
+					hasPendingClassTag &= !isTagTaken;
+					break;
+
+				case E_TOKEN_TYPE::TT_ENUM_META_ATTRIBUTE:
+					hasPendingEnumTag = true;
+
+					if (E_TOKEN_TYPE::TT_OPEN_PARENTHES == getType(i + 1) && E_TOKEN_TYPE::TT_SECTION == getType(i + 2) &&
+						E_TOKEN_TYPE::TT_ASSIGN_OP == getType(i + 3) && E_TOKEN_TYPE::TT_IDENTIFIER == getType(i + 4))
+					{
+						currSectionId = tokens.GetToken(i + 4).mValue;
+					}
+
+					break;
+
+				case E_TOKEN_TYPE::TT_CLASS_META_ATTRIBUTE:
+					hasPendingClassTag = true;
+					break;
+
+				case E_TOKEN_TYPE::TT_SEMICOLON:
+					if (!hasPendingEnumTag && !hasPendingClassTag && (i + 1 < tokensCount) && (i + 1 - currChunk.mFirstTokenIndex >= minTokensCount))
+					{
+						cutChunk(i + 1, i + 1);
+						currChunk.mSectionId = currSectionId;
+					}
+
+					break;
+
+				default:
+					break;
+			}
+		}
+
+		cutChunk(tokensCount, tokensCount);
+
+		return chunks;
+	}
+
+
+	Parser::Parser(Lexer& lexer, SymTable& symTable, const TIntrospectorOptions& options, const TOnErrorCallback& onErrorCallback, ParsingBudget* pBudget):
+		mpLexer(&lexer), mpSymTable(&symTable), mOnErrorCallback(onErrorCallback), mOptions(options), mpBudget(pBudget)
 	{
 	}
 
+	Parser::Parser(const TTokensArray& tokens, SymTable& symTable, const TIntrospectorOptions& options, const TOnErrorCallback& onErrorCallback, ParsingBudget* pBudget):
+		mpLexer(nullptr), mpTokens(&tokens), mpSymTable(&symTable), mOnErrorCallback(onErrorCallback), mOptions(options), mpBudget(pBudget)
+	{
+		mTokensEndIndex = mpTokens->GetSize() ? (mpTokens->GetSize() - 1) : 0;
+		mLinesIndex = LinesIndex(mpTokens->mSourceText);
+		mCurrToken = _getTokenAt(mCurrTokenIndex);
+	}
+
 	void Parser::Parse()
 	{
+		if (mpBudget && mpBudget->IsExceeded()) // \note The lexer could cut the file off while tokenizing it
+		{
+			_onBudgetExceeded();
+			return;
+		}
+
 		_parseDeclarationSequence();
 	}
 
+	bool Parser::ParseChunk(const TDeclarationsChunk& chunk, bool isLastChunk)
+	{
+		assert(mpTokens);
+
+		for (auto&& currNamespaceId : chunk.mNamespaces)
+		{
+			if (!mpSymTable->CreateScope(currNamespaceId))
+			{
+				return false;
+			}
+
+			_setNamespaceType(currNamespaceId);
+		}
+
+		const TType* pChunkScopeType = mpSymTable->GetCurrScopeType();
+
+		mCurrTokenIndex = chunk.mFirstTokenIndex;
+		mTokensEndIndex = chunk.mEndTokenIndex;
+		mCurrToken = _getTokenAt(mCurrTokenIndex);
+
+		/// \note Redeclared enums leave their parent's scope silently, then the rest of the file depends on the chunk
+		if (!_parseDeclarationSequence(false, E_DECL_TYPE::ALL, chunk.mSectionId) || (pChunkScopeType != mpSymTable->GetCurrScopeType()))
+		{
+			return false;
+		}
+
+		if (isLastChunk && chunk.mIsWithinNamespace)
+		{
+			_expect(E_TOKEN_TYPE::TT_CLOSE_BRACE, _getCurrToken());
+		}
+
+		return true;
+	}
+
 
 	inline Parser::E_DECL_TYPE operator& (Parser::E_DECL_TYPE left, Parser::E_DECL_TYPE right)
 	{
@@ -78,7 +382,7 @@ namespace TDEngine2
 	}
 
 
-	bool Parser::_parseDeclarationSequence(bool isInvokedFromTemplateDecl, E_DECL_TYPE allowedDeclTypes)
+	bool Parser::_parseDeclarationSequence(bool isInvokedFromTemplateDecl, E_DECL_TYPE allowedDeclTypes, const std::string& sectionId)
 	{
 		const TToken* pCurrToken = nullptr;
 
@@ -87,9 +391,9 @@ namespace TDEngine2
 		bool enumerationTagFound = false; /// ENUM_META 
 		bool classTagFound = false;		  /// or CLASS_META was found
 
-		std::string currSectionIdentifier = Wrench::StringUtils::GetEmptyStr();
+		std::string currSectionIdentifier = sectionId;
 
-		while ((pCurrToken = &mpLexer->GetCurrToken())->mType != E_TOKEN_TYPE::TT_EOF)
+		while ((pCurrToken = &_getCurrToken())->mType != E_TOKEN_TYPE::TT_EOF)
 		{
 			switch (pCurrToken->mType)
 			{
@@ -120,12 +424,12 @@ namespace TDEngine2
 					
 					if (!isInvokedFromTemplateDecl)
 					{
-						if (!_expect(E_TOKEN_TYPE::TT_SEMICOLON, mpLexer->GetCurrToken()))
+						if (!_expect(E_TOKEN_TYPE::TT_SEMICOLON, _getCurrToken()))
 						{
 							return false;
 						}
 
-						mpLexer->GetNextToken();
+						_getNextToken();
 					}
 
 					break;
@@ -136,12 +440,12 @@ namespace TDEngine2
 
 					if (!isInvokedFromTemplateDecl)
 					{
-						if (!_expect(E_TOKEN_TYPE::TT_SEMICOLON, mpLexer->GetCurrToken()))
+						if (!_expect(E_TOKEN_TYPE::TT_SEMICOLON, _getCurrToken()))
 						{
 							return false;
 						}
 
-						mpLexer->GetNextToken();
+						_getNextToken();
 					}
 
 					break;
@@ -149,89 +453,89 @@ namespace TDEngine2
 					result = _parseCompoundStatement(); // \fixme temprorary solution to skip any { .. } compound block in listings
 					break;
 				case E_TOKEN_TYPE::TT_ENUM_META_ATTRIBUTE:
-					mpLexer->GetNextToken();
+					_getNextToken();
 
-					if (!_expect(E_TOKEN_TYPE::TT_OPEN_PARENTHES, mpLexer->GetCurrToken()))
+					if (!_expect(E_TOKEN_TYPE::TT_OPEN_PARENTHES, _getCurrToken()))
 					{
 						return false;
 					}
 
-					mpLexer->GetNextToken();
+					_getNextToken();
 
-					if (E_TOKEN_TYPE::TT_SECTION == mpLexer->GetCurrToken().mType) /// \note Try to read SECTION=id construction
+					if (E_TOKEN_TYPE::TT_SECTION == _getCurrToken().mType) /// \note Try to read SECTION=id construction
 					{
-						mpLexer->GetNextToken();
+						_getNextToken();
 
 						// eat =
-						if (!_expect(E_TOKEN_TYPE::TT_ASSIGN_OP, mpLexer->GetCurrToken()))
+						if (!_expect(E_TOKEN_TYPE::TT_ASSIGN_OP, _getCurrToken()))
 						{
 							return false;
 						}
 
-						mpLexer->GetNextToken();
+						_getNextToken();
 
 						// eat identifier
-						if (!_expect(E_TOKEN_TYPE::TT_IDENTIFIER, mpLexer->GetCurrToken()))
+						if (!_expect(E_TOKEN_TYPE::TT_IDENTIFIER, _getCurrToken()))
 						{
 							return false;
 						}
 
-						currSectionIdentifier = mpLexer->GetCurrToken().mValue;
+						currSectionIdentifier = _getCurrToken().mValue;
 
-						mpLexer->GetNextToken();
+						_getNextToken();
 					}
 
-					if (!_expect(E_TOKEN_TYPE::TT_CLOSE_PARENTHES, mpLexer->GetCurrToken()))
+					if (!_expect(E_TOKEN_TYPE::TT_CLOSE_PARENTHES, _getCurrToken()))
 					{
 						return false;
 					}
 
-					mpLexer->GetNextToken();
+					_getNextToken();
 
 					enumerationTagFound = true;
 
 					break;
 				case E_TOKEN_TYPE::TT_CLASS_META_ATTRIBUTE:
-					mpLexer->GetNextToken();
+					_getNextToken();
 
-					if (!_expect(E_TOKEN_TYPE::TT_OPEN_PARENTHES, mpLexer->GetCurrToken()))
+					if (!_expect(E_TOKEN_TYPE::TT_OPEN_PARENTHES, _getCurrToken()))
 					{
 						return false;
 					}
 
-					mpLexer->GetNextToken();
+					_getNextToken();
 
-					if (!_expect(E_TOKEN_TYPE::TT_CLOSE_PARENTHES, mpLexer->GetCurrToken()))
+					if (!_expect(E_TOKEN_TYPE::TT_CLOSE_PARENTHES, _getCurrToken()))
 					{
 						return false;
 					}
 
-					mpLexer->GetNextToken();
+					_getNextToken();
 
 					classTagFound = true;
 
 					break;
 				case E_TOKEN_TYPE::TT_TYPEDEF:
-					mpLexer->GetNextToken(); // consume typedef keyword
+					_getNextToken(); // consume typedef keyword
 
 					_parseTypeSpecifier();
 
 					// skip all declarators
-					while (mpLexer->GetCurrToken().mType != E_TOKEN_TYPE::TT_SEMICOLON)
+					while (_getCurrToken().mType != E_TOKEN_TYPE::TT_SEMICOLON && _getCurrToken().mType != E_TOKEN_TYPE::TT_EOF)
 					{
-						mpLexer->GetNextToken();
+						_getNextToken();
 					}
 
-					if (!_expect(E_TOKEN_TYPE::TT_SEMICOLON, mpLexer->GetCurrToken()))
+					if (!_expect(E_TOKEN_TYPE::TT_SEMICOLON, _getCurrToken()))
 					{
 						return false;
 					}
 
-					mpLexer->GetNextToken();
+					_getNextToken();
 
 					break;
 				default:
-					mpLexer->GetNextToken(); // just skip unknown tokens
+					_getNextToken(); // just skip unknown tokens
 					break;
 			}
 
@@ -246,48 +550,40 @@ namespace TDEngine2
 
 	bool Parser::_parseNamespaceDefinition()
 	{
-		if (mpLexer->GetCurrToken().mType != E_TOKEN_TYPE::TT_NAMESPACE)
+		if (_getCurrToken().mType != E_TOKEN_TYPE::TT_NAMESPACE)
 		{
 			return false;
 		}
 
-		mpLexer->GetNextToken();
+		_getNextToken();
 
 		return _parseAnonymusNamespaceDefinition() || _parseNamedNamespaceDefinition();
 	}
 
 	bool Parser::_parseNamedNamespaceDefinition()
 	{
-		if (!_expect(E_TOKEN_TYPE::TT_IDENTIFIER, mpLexer->GetCurrToken()))
+		if (!_expect(E_TOKEN_TYPE::TT_IDENTIFIER, _getCurrToken()))
 		{
 			return false;
 		}
 
-		std::string namespaceId = mpLexer->GetCurrToken().mValue;
+		const TAtom namespaceId = GetTokenAtom(_getCurrToken());
 		if (!mpSymTable->CreateScope(namespaceId))
 		{
 			assert(false);
 			return false;
 		}
 
-		mpLexer->GetNextToken();
+		_getNextToken();
 
-		if (!_expect(E_TOKEN_TYPE::TT_OPEN_BRACE, mpLexer->GetCurrToken()))
+		if (!_expect(E_TOKEN_TYPE::TT_OPEN_BRACE, _getCurrToken()))
 		{
 			return false;
 		}
 
-		if (auto pNamespaceScope = mpSymTable->LookUpNamedScope(namespaceId))
-		{
-			if (auto pNamespaceType = std::make_unique<TNamespaceType>())
-			{
-				pNamespaceType->mId = namespaceId;
-
-				pNamespaceScope->mpType = std::move(pNamespaceType);
-			}			
-		}
+		_setNamespaceType(namespaceId);
 
-		mpLexer->GetNextToken();
+		_getNextToken();
 
 		// \note parse the body of the namespace
 		if (!_parseDeclarationSequence())
@@ -295,26 +591,39 @@ namespace TDEngine2
 			return false;
 		}
 
-		if (!_expect(E_TOKEN_TYPE::TT_CLOSE_BRACE, mpLexer->GetCurrToken()))
+		if (!_expect(E_TOKEN_TYPE::TT_CLOSE_BRACE, _getCurrToken()))
 		{
 			return false;
 		}
 
 		mpSymTable->ExitScope();
 
-		mpLexer->GetNextToken();
+		_getNextToken();
 
 		return true;
 	}
 
+	void Parser::_setNamespaceType(const TAtom& namespaceId)
+	{
+		if (auto pNamespaceScope = mpSymTable->LookUpNamedScope(namespaceId))
+		{
+			if (auto pNamespaceType = mpSymTable->CreateType<TNamespaceType>())
+			{
+				pNamespaceType->mId = namespaceId;
+
+				mpSymTable->SetScopeType(*pNamespaceScope, pNamespaceType);
+			}			
+		}
+	}
+
 	bool Parser::_parseAnonymusNamespaceDefinition()
 	{
-		if (mpLexer->GetCurrToken().mType != E_TOKEN_TYPE::TT_OPEN_BRACE)
+		if (_getCurrToken().mType != E_TOKEN_TYPE::TT_OPEN_BRACE)
 		{
 			return false;
 		}
 
-		auto&& currToken = mpLexer->GetNextToken(); // eat {
+		auto&& currToken = _getNextToken(); // eat {
 
 		// \note parse the body of the namespace
 		if (!_parseDeclarationSequence())
@@ -322,12 +631,12 @@ namespace TDEngine2
 			return false;
 		}
 
-		if (!_expect(E_TOKEN_TYPE::TT_CLOSE_BRACE, mpLexer->GetCurrToken()))
+		if (!_expect(E_TOKEN_TYPE::TT_CLOSE_BRACE, _getCurrToken()))
 		{
 			return false;
 		}
 
-		mpLexer->GetNextToken();
+		_getNextToken();
 
 		return true;
 	}
@@ -341,12 +650,12 @@ namespace TDEngine2
 	{
 		auto checkAndEat = [this](E_TOKEN_TYPE type)
 		{
-			if (!_expect(type, mpLexer->GetCurrToken()))
+			if (!_expect(type, _getCurrToken()))
 			{
 				return false;
 			}
 
-			mpLexer->GetNextToken();
+			_getNextToken();
 			return true;
 		};
 
@@ -358,9 +667,9 @@ namespace TDEngine2
 
 		const TToken* pCurrToken = nullptr;
 
-		while ((E_TOKEN_TYPE::TT_GREAT != (pCurrToken = &mpLexer->GetCurrToken())->mType) && (E_TOKEN_TYPE::TT_EOF != pCurrToken->mType))
+		while ((E_TOKEN_TYPE::TT_GREAT != (pCurrToken = &_getCurrToken())->mType) && (E_TOKEN_TYPE::TT_EOF != pCurrToken->mType))
 		{
-			mpLexer->GetNextToken();
+			_getNextToken();
 		}
 
 		if (!checkAndEat(E_TOKEN_TYPE::TT_GREAT))
@@ -373,40 +682,40 @@ namespace TDEngine2
 
 	bool Parser::_parseEnumDeclaration(E_ACCESS_SPECIFIER_TYPE accessModifier, bool isTagged, const std::string& sectionId)
 	{
-		if (E_TOKEN_TYPE::TT_ENUM != mpLexer->GetCurrToken().mType)
+		if (E_TOKEN_TYPE::TT_ENUM != _getCurrToken().mType)
 		{
 			return false;
 		}
 
-		mpLexer->GetNextToken();
+		_getNextToken();
 
 		bool isStronglyTypedEnum = false;
 
 		// \note enum class case
-		if (mpLexer->GetCurrToken().mType == E_TOKEN_TYPE::TT_CLASS || mpLexer->GetCurrToken().mType == E_TOKEN_TYPE::TT_STRUCT)
+		if (_getCurrToken().mType == E_TOKEN_TYPE::TT_CLASS || _getCurrToken().mType == E_TOKEN_TYPE::TT_STRUCT)
 		{
 			isStronglyTypedEnum = true;
-			mpLexer->GetNextToken();
+			_getNextToken();
 		}
 
-		if (!_expect(E_TOKEN_TYPE::TT_IDENTIFIER, mpLexer->GetCurrToken()))
+		if (!_expect(E_TOKEN_TYPE::TT_IDENTIFIER, _getCurrToken()))
 		{
 			return false;
 		}
 
-		std::string enumName = mpLexer->GetCurrToken().mValue;
+		const TAtom enumName = GetTokenAtom(_getCurrToken());
 
 		bool result = mpSymTable->CreateScope(enumName);
 		assert(result);
 
-		mpLexer->GetNextToken();
+		_getNextToken();
 
 		std::string underlyingTypeStr;
 
 		// \note parse enumeration's underlying type
-		if (mpLexer->GetCurrToken().mType == E_TOKEN_TYPE::TT_COLON)
+		if (_getCurrToken().mType == E_TOKEN_TYPE::TT_COLON)
 		{
-			mpLexer->GetNextToken();
+			_getNextToken();
 
 			// \note Parse base type of the enumeration
 			/*if (!_parseTypeSpecifiers())
@@ -414,41 +723,45 @@ namespace TDEngine2
 				return false;
 			}*/
 			// \todo replace it
-			while (mpLexer->GetCurrToken().mType != E_TOKEN_TYPE::TT_SEMICOLON && mpLexer->GetCurrToken().mType != E_TOKEN_TYPE::TT_OPEN_BRACE)
+			while (_getCurrToken().mType != E_TOKEN_TYPE::TT_SEMICOLON && _getCurrToken().mType != E_TOKEN_TYPE::TT_OPEN_BRACE &&
+			   _getCurrToken().mType != E_TOKEN_TYPE::TT_EOF)
 			{
-				mpLexer->GetNextToken();
+				_getNextToken();
 			}
 		}
 
 		if (auto pEnumScopeEntity = mpSymTable->LookUpNamedScope(enumName))
 		{			
-			auto pEnumTypeDesc = std::make_unique<TEnumType>();
+			auto pEnumTypeDesc = mpSymTable->CreateType<TEnumType>();
 
 			pEnumTypeDesc->mId = enumName;
 			pEnumTypeDesc->mMangledId = mpSymTable->GetMangledNameForNamedScope(enumName);
 			pEnumTypeDesc->mIsStronglyTyped = isStronglyTypedEnum;
-			pEnumTypeDesc->mIsForwardDeclaration = (mpLexer->GetCurrToken().mType == E_TOKEN_TYPE::TT_SEMICOLON);
-			pEnumTypeDesc->mpOwner = mpSymTable;
+			pEnumTypeDesc->mIsForwardDeclaration = (_getCurrToken().mType == E_TOKEN_TYPE::TT_SEMICOLON);
 			pEnumTypeDesc->mpParentType = mpSymTable->GetCurrScopeType();
 			pEnumTypeDesc->mAccessModifier = accessModifier;
 			pEnumTypeDesc->mIsMarkedWithAttribute = isTagged;
 			pEnumTypeDesc->mSectionId = sectionId;
 
-			if (mpLexer->GetCurrToken().mType == E_TOKEN_TYPE::TT_OPEN_BRACE)
+			if (_getCurrToken().mType == E_TOKEN_TYPE::TT_OPEN_BRACE && !_isEnumEmittable(*pEnumTypeDesc))
+			{
+				_skipBalancedBlock(); // \note Enumerators of the type are never written, so the body is skipped without parsing
+			}
+			else if (_getCurrToken().mType == E_TOKEN_TYPE::TT_OPEN_BRACE)
 			{
-				mpLexer->GetNextToken(); // eat {
+				_getNextToken(); // eat {
 
-				_parseEnumBody(pEnumTypeDesc.get());
+				_parseEnumBody(pEnumTypeDesc);
 
-				if (!_expect(E_TOKEN_TYPE::TT_CLOSE_BRACE, mpLexer->GetCurrToken()))
+				if (!_expect(E_TOKEN_TYPE::TT_CLOSE_BRACE, _getCurrToken()))
 				{
 					return false;
 				}
 
-				mpLexer->GetNextToken(); // eat }
+				_getNextToken(); // eat }
 			}
 
-			pEnumScopeEntity->mpType = std::move(pEnumTypeDesc);
+			mpSymTable->SetScopeType(*pEnumScopeEntity, pEnumTypeDesc);
 		}
 
 		mpSymTable->ExitScope();
@@ -458,9 +771,9 @@ namespace TDEngine2
 
 	bool Parser::_parseEnumBody(TEnumType* pEnumType)
 	{
-		while (_parseEnumeratorDefinition(pEnumType) && mpLexer->GetCurrToken().mType == E_TOKEN_TYPE::TT_COMMA) 
+		while (_parseEnumeratorDefinition(pEnumType) && _getCurrToken().mType == E_TOKEN_TYPE::TT_COMMA) 
 		{
-			mpLexer->GetNextToken(); // eat ',' token
+			_getNextToken(); // eat ',' token
 		}
 
 		return true;
@@ -468,34 +781,34 @@ namespace TDEngine2
 
 	bool Parser::_parseEnumeratorDefinition(TEnumType* pEnumType)
 	{
-		if (E_TOKEN_TYPE::TT_IDENTIFIER != mpLexer->GetCurrToken().mType)
+		if (E_TOKEN_TYPE::TT_IDENTIFIER != _getCurrToken().mType)
 		{
 			return false;
 		}
 
 		if (pEnumType)
 		{
-			pEnumType->mEnumerators.emplace_back(mpLexer->GetCurrToken().mValue);
+			pEnumType->mEnumerators.emplace_back(GetTokenAtom(_getCurrToken()));
 		}
 
-		mpLexer->GetNextToken();
+		_getNextToken();
 
-		if (mpLexer->GetCurrToken().mType == E_TOKEN_TYPE::TT_ASSIGN_OP) /// \note try to parse value of the enumerator
+		if (_getCurrToken().mType == E_TOKEN_TYPE::TT_ASSIGN_OP) /// \note try to parse value of the enumerator
 		{
-			mpLexer->GetNextToken();
+			_getNextToken();
 
 			// \todo for now we just skip this part
-			while (mpLexer->GetCurrToken().mType != E_TOKEN_TYPE::TT_COMMA &&
-				   mpLexer->GetCurrToken().mType != E_TOKEN_TYPE::TT_CLOSE_BRACE &&
-				   mpLexer->GetCurrToken().mType != E_TOKEN_TYPE::TT_EOF)
+			while (_getCurrToken().mType != E_TOKEN_TYPE::TT_COMMA &&
+				   _getCurrToken().mType != E_TOKEN_TYPE::TT_CLOSE_BRACE &&
+				   _getCurrToken().mType != E_TOKEN_TYPE::TT_EOF)
 			{
-				if (mpLexer->GetCurrToken().mType != E_TOKEN_TYPE::TT_CLOSE_BRACE) // \note the close brase will be eaten in caller method
+				if (_getCurrToken().mType != E_TOKEN_TYPE::TT_CLOSE_BRACE) // \note the close brase will be eaten in caller method
 				{
-					mpLexer->GetNextToken();
+					_getNextToken();
 				}
 			}
 
-			if (mpLexer->GetCurrToken().mType == E_TOKEN_TYPE::TT_EOF)
+			if (_getCurrToken().mType == E_TOKEN_TYPE::TT_EOF)
 			{
 				mOnErrorCallback({}); // \todo add correct error handling here
 				return false;
@@ -509,7 +822,7 @@ namespace TDEngine2
 	{
 		bool result = true;
 
-		switch (mpLexer->GetCurrToken().mType)
+		switch (_getCurrToken().mType)
 		{
 			case E_TOKEN_TYPE::TT_TEMPLATE:
 				if ((E_DECL_TYPE::TEMPLATE & allowedDeclTypes) != E_DECL_TYPE::TEMPLATE)
@@ -539,9 +852,10 @@ namespace TDEngine2
 	std::unique_ptr<TType> Parser::_parseTypeSpecifiers()
 	{
 		// \todo replace it
-		while (mpLexer->GetCurrToken().mType != E_TOKEN_TYPE::TT_SEMICOLON && mpLexer->GetCurrToken().mType != E_TOKEN_TYPE::TT_OPEN_BRACE)
+		while (_getCurrToken().mType != E_TOKEN_TYPE::TT_SEMICOLON && _getCurrToken().mType != E_TOKEN_TYPE::TT_OPEN_BRACE &&
+			   _getCurrToken().mType != E_TOKEN_TYPE::TT_EOF)
 		{
-			mpLexer->GetNextToken();
+			_getNextToken();
 		}
 
 		return nullptr;
@@ -549,18 +863,18 @@ namespace TDEngine2
 
 	bool Parser::_parseClassDeclaration(E_ACCESS_SPECIFIER_TYPE accessModifier, bool isTemplateDeclaration, bool isTagged)
 	{
-		const bool isStruct = (E_TOKEN_TYPE::TT_STRUCT == mpLexer->GetCurrToken().mType);
+		const bool isStruct = (E_TOKEN_TYPE::TT_STRUCT == _getCurrToken().mType);
 
-		if (E_TOKEN_TYPE::TT_CLASS != mpLexer->GetCurrToken().mType && !isStruct)
+		if (E_TOKEN_TYPE::TT_CLASS != _getCurrToken().mType && !isStruct)
 		{
 			return false;
 		}
 
-		mpLexer->GetNextToken();
+		_getNextToken();
 
-		std::string className = _parseClassIdentifier();
+		const TAtom className = _parseClassIdentifier();
 
-		if (className.empty())
+		if (className.IsEmpty())
 		{
 			mOnErrorCallback({});
 			return false;
@@ -589,7 +903,7 @@ namespace TDEngine2
 		return true;
 	}
 
-	bool Parser::_parseClassHeader(const std::string& className, E_ACCESS_SPECIFIER_TYPE accessModifier, bool isStruct, bool isTemplate, bool isTagged)
+	bool Parser::_parseClassHeader(const TAtom& className, E_ACCESS_SPECIFIER_TYPE accessModifier, bool isStruct, bool isTemplate, bool isTagged)
 	{
 		auto pClassScopeEntity = mpSymTable->LookUpNamedScope(className);
 		if (!pClassScopeEntity)
@@ -597,11 +911,10 @@ namespace TDEngine2
 			return false;
 		}
 
-		auto pClassTypeDesc = std::make_unique<TClassType>();
+		auto pClassTypeDesc = mpSymTable->CreateType<TClassType>();
 
 		pClassTypeDesc->mId                    = className;
 		pClassTypeDesc->mMangledId             = mpSymTable->GetMangledNameForNamedScope(className);
-		pClassTypeDesc->mpOwner                = mpSymTable;
 		pClassTypeDesc->mIsStruct              = isStruct;
 		pClassTypeDesc->mIsTemplate            = isTemplate;
 		pClassTypeDesc->mAccessModifier        = accessModifier;
@@ -609,23 +922,23 @@ namespace TDEngine2
 		pClassTypeDesc->mIsMarkedWithAttribute = isTagged;
 
 		// \note 'final' specifier parsing
-		pClassTypeDesc->mIsFinal = (E_TOKEN_TYPE::TT_FINAL == mpLexer->GetCurrToken().mType);
+		pClassTypeDesc->mIsFinal = (E_TOKEN_TYPE::TT_FINAL == _getCurrToken().mType);
 		if (pClassTypeDesc->mIsFinal)
 		{
-			mpLexer->GetNextToken();
+			_getNextToken();
 		}
 
-		defer([pClassScopeEntity, &pClassTypeDesc] 
+		defer([this, pClassScopeEntity, pClassTypeDesc] 
 		{
-			pClassScopeEntity->mpType = std::move(pClassTypeDesc);
+			mpSymTable->SetScopeType(*pClassScopeEntity, pClassTypeDesc);
 		});
 
-		if (E_TOKEN_TYPE::TT_COLON != mpLexer->GetCurrToken().mType)
+		if (E_TOKEN_TYPE::TT_COLON != _getCurrToken().mType)
 		{
 			return true;
 		}
 
-		mpLexer->GetNextToken();
+		_getNextToken();
 
 		/// \note Parse information about base classes
 
@@ -640,7 +953,7 @@ namespace TDEngine2
 			{
 				changed = true;
 
-				switch (mpLexer->GetCurrToken().mType)
+				switch (_getCurrToken().mType)
 				{
 					case E_TOKEN_TYPE::TT_PUBLIC:
 						info.mAccessSpecifier = E_ACCESS_SPECIFIER_TYPE::PUBLIC;
@@ -661,14 +974,13 @@ namespace TDEngine2
 
 				if (changed)
 				{
-					mpLexer->GetNextToken();
+					_getNextToken();
 				}
 			}
 
 			// \note Parse base class's identifier 
 			// \todo Refactor this to correctly parse names, now it just eats tokens and assumes that it's correct name
-			std::string& baseClassId = info.mFullName;
-			baseClassId.append(_parseClassIdentifier());
+			info.mFullName = _parseClassIdentifier();
 
 			pClassTypeDesc->mBaseClasses.emplace_back(info);
 			
@@ -677,15 +989,15 @@ namespace TDEngine2
 
 		do
 		{
-			if (!pClassTypeDesc->mBaseClasses.empty() && (E_TOKEN_TYPE::TT_COMMA == mpLexer->GetCurrToken().mType))
+			if (!pClassTypeDesc->mBaseClasses.empty() && (E_TOKEN_TYPE::TT_COMMA == _getCurrToken().mType))
 			{
-				mpLexer->GetNextToken(); // eat ,
+				_getNextToken(); // eat ,
 			}
 
 			_parseSingleBaseSpecifierClause();
-		} while (E_TOKEN_TYPE::TT_COMMA == mpLexer->GetCurrToken().mType);
+		} while (E_TOKEN_TYPE::TT_COMMA == _getCurrToken().mType);
 
-		if (!_expect(E_TOKEN_TYPE::TT_OPEN_BRACE, mpLexer->GetCurrToken()))
+		if (!_expect(E_TOKEN_TYPE::TT_OPEN_BRACE, _getCurrToken()))
 		{
 			return false;
 		}
@@ -693,7 +1005,7 @@ namespace TDEngine2
 		return true;
 	}
 
-	bool Parser::_parseClassBody(const std::string& className, bool isTagged)
+	bool Parser::_parseClassBody(const TAtom& className, bool isTagged)
 	{
 		auto pClassScopeEntity = mpSymTable->LookUpNamedScope(className);
 		if (!pClassScopeEntity)
@@ -703,13 +1015,13 @@ namespace TDEngine2
 
 		if (!pClassScopeEntity->mpType)
 		{
-			pClassScopeEntity->mpType = std::make_unique<TClassType>();
+			mpSymTable->SetScopeType(*pClassScopeEntity, mpSymTable->CreateType<TClassType>());
 		}
 
-		TClassType* pClassTypeDesc =  dynamic_cast<TClassType*>(pClassScopeEntity->mpType.get());
+		TClassType* pClassTypeDesc =  TypeCast<TClassType>(pClassScopeEntity->mpType);
 		
 		// \note Try to parse body, it starts from {
-		if (E_TOKEN_TYPE::TT_OPEN_BRACE != mpLexer->GetCurrToken().mType)
+		if (E_TOKEN_TYPE::TT_OPEN_BRACE != _getCurrToken().mType)
 		{
 			if (pClassTypeDesc)
 			{
@@ -721,26 +1033,28 @@ namespace TDEngine2
 
 		if (!isTagged && mOptions.mIsTaggedOnlyModeEnabled)
 		{
-			_consumeBalancedTokens(); // \note Skip all tokens inside class definition
+			_skipBalancedBlock(); // \note Skip the class definition without scanning its tokens
 
-			while (mpLexer->GetCurrToken().mType != E_TOKEN_TYPE::TT_SEMICOLON)
+			while (_getCurrToken().mType != E_TOKEN_TYPE::TT_SEMICOLON && _getCurrToken().mType != E_TOKEN_TYPE::TT_EOF)
 			{
-				mpLexer->GetNextToken();
+				_getNextToken();
 			}
 
 			return true;
 		}
 
-		mpLexer->GetNextToken();
+		_getNextToken();
 
-		const TToken* pCurrToken = &mpLexer->GetCurrToken();
+		const TToken* pCurrToken = &_getCurrToken();
+
+		const bool isMembersListRequired = !pClassTypeDesc || _isClassEmittable(*pClassTypeDesc);
 
 		E_ACCESS_SPECIFIER_TYPE accessModifier = (pClassTypeDesc && pClassTypeDesc->mIsStruct) ? E_ACCESS_SPECIFIER_TYPE::PUBLIC : E_ACCESS_SPECIFIER_TYPE::PRIVATE;
 		uint32_t depth = 1; // \fixme Temporary fix with indentation counter to implement correct recognition without actual parsing
 
 		while (depth > 0)
 		{
-			pCurrToken = &mpLexer->GetCurrToken();
+			pCurrToken = &_getCurrToken();
 			depth = (pCurrToken->mType == E_TOKEN_TYPE::TT_OPEN_BRACE) ? (depth + 1) : ((pCurrToken->mType == E_TOKEN_TYPE::TT_CLOSE_BRACE) ? (depth - 1) : depth);
 
 			if (E_TOKEN_TYPE::TT_PUBLIC == pCurrToken->mType ||
@@ -760,14 +1074,14 @@ namespace TDEngine2
 						break;
 					}
 
-				mpLexer->GetNextToken();
+				_getNextToken();
 
-				if (!_expect(E_TOKEN_TYPE::TT_COLON, mpLexer->GetCurrToken()))
+				if (!_expect(E_TOKEN_TYPE::TT_COLON, _getCurrToken()))
 				{
 					return false;
 				}
 
-				mpLexer->GetNextToken();
+				_getNextToken();
 				continue;
 			}
 
@@ -789,31 +1103,31 @@ namespace TDEngine2
 					_parseClassDeclaration(accessModifier, false);
 					break;
 				default:
-					_parseClassMemberDeclaration(className, accessModifier);
+					_parseClassMemberDeclaration(className, accessModifier, isMembersListRequired);
 					break;
 			}
 
-			if (!_expect(E_TOKEN_TYPE::TT_SEMICOLON, mpLexer->GetCurrToken()))
+			if (!_expect(E_TOKEN_TYPE::TT_SEMICOLON, _getCurrToken()))
 			{
 				return false;
 			}
 
-			pCurrToken = &mpLexer->GetNextToken();
+			pCurrToken = &_getNextToken();
 		}
 
-		if (!_expect(E_TOKEN_TYPE::TT_CLOSE_BRACE, mpLexer->GetCurrToken()))
+		if (!_expect(E_TOKEN_TYPE::TT_CLOSE_BRACE, _getCurrToken()))
 		{
 			return false;
 		}
 
-		mpLexer->GetNextToken();
+		_getNextToken();
 
 		return true;
 	}
 
-	bool Parser::_parseClassMemberSpecification(const std::string& className, E_ACCESS_SPECIFIER_TYPE accessModifier)
+	bool Parser::_parseClassMemberSpecification(const TAtom& className, E_ACCESS_SPECIFIER_TYPE accessModifier)
 	{
-		const TToken* pCurrToken = &mpLexer->GetCurrToken();
+		const TToken* pCurrToken = &_getCurrToken();
 
 		E_ACCESS_SPECIFIER_TYPE nextAccessModifier;
 
@@ -834,46 +1148,46 @@ namespace TDEngine2
 					break;
 			}
 
-			mpLexer->GetNextToken();
+			_getNextToken();
 		}
 
 		return _parseClassMemberDeclaration(className, accessModifier) && _parseClassMemberSpecification(className, accessModifier);
 	}
 
-	bool Parser::_parseClassMemberDeclaration(const std::string& className, E_ACCESS_SPECIFIER_TYPE accessModifier)
+	bool Parser::_parseClassMemberDeclaration(const TAtom& className, E_ACCESS_SPECIFIER_TYPE accessModifier, bool isMembersListRequired)
 	{
-		const TToken* pCurrToken = &mpLexer->GetCurrToken();
+		const TToken* pCurrToken = &_getCurrToken();
 
 		// \todo For now we just skip type specifier and parse only member's identifiers
 		while (true)
 		{
-			if (mpLexer->GetCurrToken().mType == E_TOKEN_TYPE::TT_EOF)
+			if (_getCurrToken().mType == E_TOKEN_TYPE::TT_EOF)
 			{
 				break;
 			}
 
-			const TToken& nextToken = mpLexer->PeekToken();
+			const TToken& nextToken = _peekToken();
 
-			if (mpLexer->GetCurrToken().mType == E_TOKEN_TYPE::TT_IDENTIFIER &&
+			if (_getCurrToken().mType == E_TOKEN_TYPE::TT_IDENTIFIER &&
 				(nextToken.mType == E_TOKEN_TYPE::TT_COMMA || nextToken.mType == E_TOKEN_TYPE::TT_SEMICOLON || nextToken.mType == E_TOKEN_TYPE::TT_ASSIGN_OP || nextToken.mType == E_TOKEN_TYPE::TT_OPEN_PARENTHES))
 			{
 				break;
 			}
 
-			mpLexer->GetNextToken();
+			_getNextToken();
 		}
 
-		if (mpLexer->PeekToken().mType == E_TOKEN_TYPE::TT_OPEN_PARENTHES) /// \note Skip a method
+		if (_peekToken().mType == E_TOKEN_TYPE::TT_OPEN_PARENTHES) /// \note Skip a method
 		{
-			mpLexer->GetNextToken(); // eat identifier			
+			_getNextToken(); // eat identifier			
 			_consumeBalancedTokens(); // consume arguments part
 
 			// \note Next possible token either ; or { with method's definition (qualifiers like const, override, = 0, etc are not considered yet)
-			while (mpLexer->GetCurrToken().mType != E_TOKEN_TYPE::TT_SEMICOLON)
+			while (_getCurrToken().mType != E_TOKEN_TYPE::TT_SEMICOLON && _getCurrToken().mType != E_TOKEN_TYPE::TT_EOF)
 			{
-				if (mpLexer->GetCurrToken().mType != E_TOKEN_TYPE::TT_OPEN_BRACE)
+				if (_getCurrToken().mType != E_TOKEN_TYPE::TT_OPEN_BRACE)
 				{
-					mpLexer->GetNextToken();
+					_getNextToken();
 					continue;
 				}
 
@@ -884,30 +1198,33 @@ namespace TDEngine2
 			return true;
 		}
 
-		std::shared_ptr<TClassType> pClassTypeDesc = std::dynamic_pointer_cast<TClassType>(mpSymTable->GetCurrScopeType());
+		TClassType* pClassTypeDesc = TypeCast<TClassType>(mpSymTable->GetCurrScopeType());
 		assert(pClassTypeDesc);
 
-		while (mpLexer->GetCurrToken().mType != E_TOKEN_TYPE::TT_SEMICOLON)
+		while (_getCurrToken().mType != E_TOKEN_TYPE::TT_SEMICOLON)
 		{
-			if (!_expect(E_TOKEN_TYPE::TT_IDENTIFIER, mpLexer->GetCurrToken()))
+			if (!_expect(E_TOKEN_TYPE::TT_IDENTIFIER, _getCurrToken()))
 			{
 				return false;
 			}
 
-			pClassTypeDesc->mFields.push_back(mpLexer->GetCurrToken().mValue);
+			if (isMembersListRequired)
+			{
+				pClassTypeDesc->mFields.emplace_back(GetTokenAtom(_getCurrToken()));
+			}
 
-			const TToken& delimiterToken = mpLexer->GetNextToken();
+			const TToken& delimiterToken = _getNextToken();
 
 			switch (delimiterToken.mType)
 			{
 				case E_TOKEN_TYPE::TT_COMMA:
-					mpLexer->GetNextToken(); // eat , token
+					_getNextToken(); // eat , token
 					break;
 
 				case E_TOKEN_TYPE::TT_ASSIGN_OP:
-					while (mpLexer->GetCurrToken().mType != E_TOKEN_TYPE::TT_SEMICOLON && mpLexer->GetCurrToken().mType != E_TOKEN_TYPE::TT_EOF)
+					while (_getCurrToken().mType != E_TOKEN_TYPE::TT_SEMICOLON && _getCurrToken().mType != E_TOKEN_TYPE::TT_EOF)
 					{
-						mpLexer->GetNextToken();
+						_getNextToken();
 					}
 
 					break;
@@ -919,76 +1236,79 @@ namespace TDEngine2
 
 	bool Parser::_parseCompoundStatement()
 	{
-		if (!_expect(E_TOKEN_TYPE::TT_OPEN_BRACE, mpLexer->GetCurrToken().mType))
+		if (!_expect(E_TOKEN_TYPE::TT_OPEN_BRACE, _getCurrToken().mType))
 		{
 			return false;
 		}
 
-		mpLexer->GetNextToken();
-
-		const TToken* pCurrToken = nullptr;
+		/// \note Only braces matter here, so a single counter replaces recursion over nested blocks
+		uint32_t depth = 1;
 
-		while (E_TOKEN_TYPE::TT_CLOSE_BRACE != (pCurrToken = &mpLexer->GetCurrToken())->mType && (E_TOKEN_TYPE::TT_EOF != pCurrToken->mType))
+		while (depth > 0)
 		{
-			if (E_TOKEN_TYPE::TT_OPEN_BRACE == mpLexer->GetCurrToken().mType)
+			switch (_getNextToken().mType)
 			{
-				if (!_parseCompoundStatement())
-				{
-					return false;
-				}
+				case E_TOKEN_TYPE::TT_OPEN_BRACE:
+					++depth;
+					break;
+				case E_TOKEN_TYPE::TT_CLOSE_BRACE:
+					--depth;
+					break;
+				case E_TOKEN_TYPE::TT_EOF:
+					return true;
+				default:
+					break;
 			}
-
-			mpLexer->GetNextToken();
 		}
 
-		mpLexer->GetNextToken(); // eat } token
+		_getNextToken(); // eat } token
 
 		return true;
 	}
 
-	std::string Parser::_parseClassIdentifier()
+	TAtom Parser::_parseClassIdentifier()
 	{
 		auto&& id = _parseSimpleTemplateIdentifier();
 
 		if (!id.empty())
 		{
-			return id;
+			return TAtom{ id };
 		}
 
-		const TToken& currToken = mpLexer->GetCurrToken();
+		const TToken& currToken = _getCurrToken();
 
 		if (E_TOKEN_TYPE::TT_IDENTIFIER == currToken.mType) // a simple identifier
 		{
-			defer([this] { mpLexer->GetNextToken(); });
+			defer([this] { _getNextToken(); });
 
-			return currToken.mValue;
+			return GetTokenAtom(currToken);
 		}
 		
-		return Wrench::StringUtils::GetEmptyStr();
+		return {};
 	}
 
 	std::string Parser::_parseSimpleTemplateIdentifier()
 	{
-		const TToken& currToken = mpLexer->GetCurrToken();
+		const TToken& currToken = _getCurrToken();
 
 		// could be simple identifier or simple template one
 		if (E_TOKEN_TYPE::TT_IDENTIFIER == currToken.mType)
 		{
-			std::string templateIdentifier = currToken.mValue;
+			std::string templateIdentifier { currToken.mValue };
 
-			if (E_TOKEN_TYPE::TT_LESS == mpLexer->PeekToken().mType) // a template identifier
+			if (E_TOKEN_TYPE::TT_LESS == _peekToken().mType) // a template identifier
 			{
-				mpLexer->GetNextToken(); // eat <
+				_getNextToken(); // eat <
 
 				templateIdentifier.push_back('<');
 
 				// \note \todo Parse template's arguments list
-				while (mpLexer->GetCurrToken().mType != E_TOKEN_TYPE::TT_GREAT)
+				while (_getCurrToken().mType != E_TOKEN_TYPE::TT_GREAT && _getCurrToken().mType != E_TOKEN_TYPE::TT_EOF)
 				{
-					mpLexer->GetNextToken();
+					_getNextToken();
 				}
 
-				if (!_expect(E_TOKEN_TYPE::TT_GREAT, mpLexer->GetCurrToken().mType))
+				if (!_expect(E_TOKEN_TYPE::TT_GREAT, _getCurrToken().mType))
 				{
 					return Wrench::StringUtils::GetEmptyStr();
 				}
@@ -1005,60 +1325,165 @@ namespace TDEngine2
 	}
 
 
-	static const std::unordered_map<E_TOKEN_TYPE, E_TOKEN_TYPE> BALANCED_TOKENS_TABLE
-	{
-		{ E_TOKEN_TYPE::TT_OPEN_BRACE,  E_TOKEN_TYPE::TT_CLOSE_BRACE },
-		{ E_TOKEN_TYPE::TT_OPEN_PARENTHES, E_TOKEN_TYPE::TT_CLOSE_PARENTHES },
-		{ E_TOKEN_TYPE::TT_LESS, E_TOKEN_TYPE::TT_GREAT },
-	};
-
-	static const std::unordered_set<E_TOKEN_TYPE> END_BALANCED_TOKENS_TABLE
-	{
-		E_TOKEN_TYPE::TT_CLOSE_BRACE, E_TOKEN_TYPE::TT_CLOSE_PARENTHES, E_TOKEN_TYPE::TT_GREAT
-	};
-
-
 	bool Parser::_consumeBalancedTokens()
 	{
-		TToken currToken = mpLexer->GetCurrToken();
+		const TToken* pCurrToken = &_getCurrToken();
 
-		if (BALANCED_TOKENS_TABLE.find(currToken.mType) == BALANCED_TOKENS_TABLE.cend()) // nothing to skip here
+		uint8_t tokenClass = GetBalancedTokenClass(pCurrToken->mType);
+
+		if (!(tokenClass & OpenBalancedTokenFlag)) // nothing to skip here
 		{
 			return true;
 		}
 
-		std::stack<TToken> matchedTokens { { BALANCED_TOKENS_TABLE.at(currToken.mType) }};
+		TBalancedTokensStack openedTokens;
+		openedTokens.Push(tokenClass & BalancedTokenKindMask);
 
-		while (!matchedTokens.empty())
+		while (!openedTokens.IsEmpty())
 		{
-			currToken = mpLexer->GetNextToken();
+			pCurrToken = &_getNextToken();
+
+			tokenClass = GetBalancedTokenClass(pCurrToken->mType);
 
-			if (END_BALANCED_TOKENS_TABLE.find(currToken.mType) == END_BALANCED_TOKENS_TABLE.cend())
+			if (tokenClass & OpenBalancedTokenFlag)
 			{
+				openedTokens.Push(tokenClass & BalancedTokenKindMask);
 				continue;
 			}
 
-			const TToken& expectedEndToken = matchedTokens.top();
-			matchedTokens.pop();
-
-			if (!_expect(expectedEndToken.mType, currToken))
+			if (!(tokenClass & CloseBalancedTokenFlag))
 			{
-				return false;
+				if (E_TOKEN_TYPE::TT_EOF == pCurrToken->mType) // \note The expected closing token is reported
+				{
+					const uint8_t expectedKind = openedTokens.Pop();
+					return _expect(CloseBalancedTokens[(TBalancedTokensStack::mAnyKind == expectedKind) ? 0 : expectedKind], *pCurrToken);
+				}
+
+				continue;
 			}
 
-			if (BALANCED_TOKENS_TABLE.find(currToken.mType) == BALANCED_TOKENS_TABLE.cend())
+			const uint8_t expectedKind = openedTokens.Pop();
+
+			if (TBalancedTokensStack::mAnyKind != expectedKind && !_expect(CloseBalancedTokens[expectedKind], *pCurrToken))
 			{
-				continue;
+				return false;
 			}
+		}
+
+		_getNextToken();
+
+		return true;
+	}
 
-			matchedTokens.push(BALANCED_TOKENS_TABLE.at(currToken.mType));
+	bool Parser::_skipBalancedBlock()
+	{
+		if (!mpTokens)
+		{
+			return !mIsBudgetExceeded && mpLexer->SkipBalancedBlock();
 		}
 
-		mpLexer->GetNextToken();
+		if (E_TOKEN_TYPE::TT_OPEN_BRACE != mCurrToken.mType)
+		{
+			return false;
+		}
+
+		const size_t blockEndPos = FindBalancedBlockEnd(GetScanKernels(), mpTokens->mSourceText, mCurrToken.mOffset);
+
+		/// \note Tokens are sorted by their offsets, so the first one after the block is found with a binary search
+		auto&& offsets = mpTokens->mOffsets;
+		auto it = std::lower_bound(offsets.cbegin() + mCurrTokenIndex, offsets.cbegin() + mTokensEndIndex, blockEndPos);
+
+		mCurrTokenIndex = static_cast<size_t>(it - offsets.cbegin());
+		mCurrToken = _getTokenAt(mCurrTokenIndex);
 
 		return true;
 	}
 
+	const TToken& Parser::_getCurrToken()
+	{
+		return (mpTokens || mIsBudgetExceeded) ? mCurrToken : mpLexer->GetCurrToken();
+	}
+
+	const TToken& Parser::_getNextToken()
+	{
+		if (mIsBudgetExceeded)
+		{
+			return mCurrToken;
+		}
+
+		if (mpBudget && !(mpTokens ? mpBudget->Tick() : mpBudget->ConsumeTokens())) // \note Tokens of the array were already accounted by the lexer
+		{
+			_onBudgetExceeded();
+			return mCurrToken;
+		}
+
+		if (!mpTokens)
+		{
+			return mpLexer->GetNextToken();
+		}
+
+		mCurrTokenIndex = (std::min)(mCurrTokenIndex + 1, mTokensEndIndex);
+		mCurrToken = _getTokenAt(mCurrTokenIndex);
+
+		return mCurrToken;
+	}
+
+	const TToken& Parser::_peekToken(uint32_t offset)
+	{
+		if (mIsBudgetExceeded)
+		{
+			return mCurrToken;
+		}
+
+		if (!mpTokens)
+		{
+			return mpLexer->PeekToken(offset);
+		}
+
+		const size_t tokenIndex = mCurrTokenIndex + offset;
+
+		TToken& peekedToken = mPeekedTokens[tokenIndex & (mPeekedTokens.size() - 1)];
+		peekedToken = _getTokenAt(tokenIndex);
+
+		return peekedToken;
+	}
+
+	TToken Parser::_getTokenAt(size_t index) const
+	{
+		return mpTokens->GetToken((index < mTokensEndIndex) ? index : (mpTokens->GetSize() - 1)); // \note The last token of the array is EOF
+	}
+
+	void Parser::_onBudgetExceeded()
+	{
+		if (mpTokens)
+		{
+			mTokensEndIndex = mCurrTokenIndex;
+			mCurrToken = _getTokenAt(mCurrTokenIndex);
+		}
+		else
+		{
+			const TToken& currToken = mpLexer->GetCurrToken();
+			mCurrToken = TToken{ E_TOKEN_TYPE::TT_EOF, {}, currToken.mOffset + static_cast<uint32_t>(currToken.mValue.size()) };
+		}
+
+		mIsBudgetExceeded = true;
+
+		if (mOnErrorCallback)
+		{
+			TParserError error;
+			error.mCode = TParserError::E_PARSER_ERROR_CODE::BUDGET_EXCEEDED;
+			error.mPos  = _getCursorPos(mCurrToken);
+			error.mData.mBudgetExceededErrData = { mpBudget->GetTokensCount(), mpBudget->GetElapsedTime() };
+
+			mOnErrorCallback(error);
+		}
+	}
+
+	TToken::TCursorPos Parser::_getCursorPos(const TToken& token)
+	{
+		return mpTokens ? mLinesIndex.GetCursorPos(token) : mpLexer->GetCursorPos(token);
+	}
+
 	bool Parser::_expect(E_TOKEN_TYPE expectedType, const TToken& token)
 	{
 		if (expectedType == token.mType)
@@ -1070,7 +1495,7 @@ namespace TDEngine2
 		{
 			TParserError error;
 			error.mCode = TParserError::E_PARSER_ERROR_CODE::UNEXPECTED_SYMBOL;
-			error.mPos  = token.mPos;
+			error.mPos  = _getCursorPos(token);
 			error.mData.mUnexpectedTokenErrData = { token.mType, expectedType };
 
 			mOnErrorCallback(error);
@@ -1078,4 +1503,51 @@ namespace TDEngine2
 
 		return false;
 	}
-}
\ No newline at end of file
+
+	bool Parser::_isEnumEmittable(const TEnumType& enumType) const
+	{
+		if (!mOptions.mpTypesFilter)
+		{
+			return true;
+		}
+
+		if (E_ACCESS_SPECIFIER_TYPE::PUBLIC != enumType.mAccessModifier ||
+			(mOptions.mIsTaggedOnlyModeEnabled && !enumType.mIsMarkedWithAttribute))
+		{
+			return false;
+		}
+
+		if (auto pParentType = TypeCast<TClassType>(enumType.mpParentType))
+		{
+			if (pParentType->mIsTemplate)
+			{
+				return false;
+			}
+		}
+
+		return mOptions.mpTypesFilter->IsEnumEmittable(enumType.mId.GetString());
+	}
+
+	bool Parser::_isClassEmittable(const TClassType& classType) const
+	{
+		if (!mOptions.mpTypesFilter)
+		{
+			return true;
+		}
+
+		if (E_ACCESS_SPECIFIER_TYPE::PUBLIC != classType.mAccessModifier || classType.mIsTemplate)
+		{
+			return false;
+		}
+
+		if (const TType* pParentType = classType.mpParentType)
+		{
+			if (E_ACCESS_SPECIFIER_TYPE::PUBLIC != pParentType->mAccessModifier)
+			{
+				return false;
+			}
+		}
+
+		return mOptions.mpTypesFilter->IsClassEmittable(classType.mId.GetString(), classType.mIsStruct);
+	}
+}
@@ -0,0 +1,25 @@
+#include "../include/parsingbudget.h"
+
+
+namespace TDEngine2
+{
+	ParsingBudget::ParsingBudget(uint64_t maxTokensCount, uint32_t maxTime):
+		mMaxTokensCount(maxTokensCount), mMaxTime(maxTime), mStartTime(TClock::now())
+	{
+	}
+
+	ParsingBudget ParsingBudget::CreateFromOptions(const TIntrospectorOptions& options)
+	{
+		return ParsingBudget(options.mMaxTokensPerFile, options.mMaxParsingTimePerFile);
+	}
+
+	uint32_t ParsingBudget::GetElapsedTime() const
+	{
+		return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(TClock::now() - mStartTime).count());
+	}
+
+	void ParsingBudget::_checkTime()
+	{
+		mIsExceeded = (GetElapsedTime() > mMaxTime);
+	}
+}
@@ -0,0 +1,120 @@
+#include "../include/prefilter.h"
+#include "../include/tokens.h"
+
+
+namespace TDEngine2
+{
+	KeywordsPrefilter::KeywordsPrefilter(const std::vector<std::string_view>& keywords, const TScanKernels& kernels):
+		mpKernels(&kernels)
+	{
+		for (auto&& currKeyword : keywords)
+		{
+			if (currKeyword.empty())
+			{
+				continue;
+			}
+
+			mKeywords.push_back(currKeyword);
+			mHasAllFirstChars &= mFirstChars.Add(currKeyword.front());
+		}
+	}
+
+	KeywordsPrefilter KeywordsPrefilter::CreateFromOptions(const TIntrospectorOptions& options)
+	{
+		if (options.mIsTaggedOnlyModeEnabled)
+		{
+			return KeywordsPrefilter(
+				{
+					GetKeywordValue(E_TOKEN_TYPE::TT_ENUM_META_ATTRIBUTE),
+					GetKeywordValue(E_TOKEN_TYPE::TT_CLASS_META_ATTRIBUTE),
+					GetKeywordValue(E_TOKEN_TYPE::TT_INTERFACE_META_ATTRIBUTE),
+				});
+		}
+
+		return KeywordsPrefilter(
+			{
+				GetKeywordValue(E_TOKEN_TYPE::TT_ENUM),
+				GetKeywordValue(E_TOKEN_TYPE::TT_CLASS),
+				GetKeywordValue(E_TOKEN_TYPE::TT_STRUCT),
+			});
+	}
+
+	bool KeywordsPrefilter::HasAnyKeyword(std::string_view text) const TDE2_NOEXCEPT
+	{
+		size_t pos = 0;
+
+		while (pos < text.size())
+		{
+			if (mHasAllFirstChars)
+			{
+				pos = mpKernels->mpFindAnyOfChars(text, pos, mFirstChars);
+				if (pos >= text.size())
+				{
+					break;
+				}
+			}
+
+			if (pos > 0 && IsIdentifierChar(text[pos - 1])) // \note The candidate is in the middle of another identifier
+			{
+				++pos;
+				continue;
+			}
+
+			for (auto&& currKeyword : mKeywords)
+			{
+				if (text.compare(pos, currKeyword.size(), currKeyword) != 0)
+				{
+					continue;
+				}
+
+				const size_t keywordEndPos = pos + currKeyword.size();
+
+				if (keywordEndPos >= text.size() || !IsIdentifierChar(text[keywordEndPos]))
+				{
+					return true;
+				}
+			}
+
+			++pos;
+		}
+
+		return false;
+	}
+
+
+	TypesFilter::TypesFilter(E_EMIT_FLAGS emitFlags, const std::vector<std::string>& typenamesPatternsToExclude):
+		mEmitFlags(emitFlags)
+	{
+		mDigest.append("emit:").append(std::to_string(static_cast<uint32_t>(emitFlags))).append("\n");
+
+		for (auto&& currPatternStr : typenamesPatternsToExclude)
+		{
+			mTypenamesPatternsToExclude.emplace_back(currPatternStr);
+			mDigest.append("exclude:").append(currPatternStr).append("\n");
+		}
+	}
+
+	bool TypesFilter::IsEnumEmittable(const std::string& id) const
+	{
+		return (mEmitFlags & E_EMIT_FLAGS::ENUMS) == E_EMIT_FLAGS::ENUMS && !_isExcluded(id);
+	}
+
+	bool TypesFilter::IsClassEmittable(const std::string& id, bool isStruct) const
+	{
+		const E_EMIT_FLAGS requiredFlag = isStruct ? E_EMIT_FLAGS::STRUCTS : E_EMIT_FLAGS::CLASSES;
+		return (mEmitFlags & requiredFlag) == requiredFlag && !_isExcluded(id);
+	}
+
+	bool TypesFilter::_isExcluded(const std::string& id) const
+	{
+		for (auto&& currPattern : mTypenamesPatternsToExclude)
+		{
+			if (std::regex_match(id, currPattern))
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+}
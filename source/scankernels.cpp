@@ -0,0 +1,712 @@
+#include "../include/scankernels.h"
+#include <cstring>
+#include <cassert>
+#include <cctype>
+#include <bitset>
+#include <algorithm>
+
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+	#define TDE2_SCAN_KERNELS_X86 1
+
+	#include <immintrin.h>
+
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+		#define TDE2_TARGET_SSE2
+		#define TDE2_TARGET_AVX2
+	#else
+		#define TDE2_TARGET_SSE2 __attribute__((target("sse2")))
+		#define TDE2_TARGET_AVX2 __attribute__((target("avx2")))
+	#endif
+#else
+	#define TDE2_SCAN_KERNELS_X86 0
+#endif
+
+
+namespace TDEngine2
+{
+	static inline uint32_t CountTrailingZeros(uint32_t mask)
+	{
+#if defined(_MSC_VER)
+		unsigned long index = 0;
+		_BitScanForward(&index, mask);
+		return static_cast<uint32_t>(index);
+#else
+		return static_cast<uint32_t>(__builtin_ctz(mask));
+#endif
+	}
+
+	static inline size_t CountBits(uint32_t mask)
+	{
+		return std::bitset<32>(mask).count();
+	}
+
+
+	/*!
+		\brief Scalar kernels, they're used on every platform as a fallback and to process tails of the buffer
+	*/
+
+	static size_t FindNewLineScalar(std::string_view text, size_t pos)
+	{
+		if (pos >= text.size())
+		{
+			return text.size();
+		}
+
+		const void* pFoundChar = std::memchr(text.data() + pos, '\n', text.size() - pos);
+		return pFoundChar ? static_cast<size_t>(static_cast<const char*>(pFoundChar) - text.data()) : text.size();
+	}
+
+	static size_t FindCommentDelimiterScalar(std::string_view text, size_t pos)
+	{
+		for (; pos + 1 < text.size(); ++pos)
+		{
+			const char currCh = text[pos];
+			const char nextCh = text[pos + 1];
+
+			if ((currCh == '/' && nextCh == '*') || (currCh == '*' && nextCh == '/'))
+			{
+				return pos;
+			}
+		}
+
+		return text.size();
+	}
+
+	static size_t FindIdentifierEndScalar(std::string_view text, size_t pos)
+	{
+		while (pos < text.size() && IsIdentifierChar(text[pos]))
+		{
+			++pos;
+		}
+
+		return (std::min)(pos, text.size());
+	}
+
+	static size_t CountNewLinesScalar(std::string_view text, size_t pos, size_t end)
+	{
+		size_t count = 0;
+
+		for (end = (std::min)(end, text.size()); pos < end; ++pos)
+		{
+			count += (text[pos] == '\n') ? 1 : 0;
+		}
+
+		return count;
+	}
+
+
+	static size_t FindAnyOfCharsScalar(std::string_view text, size_t pos, const TCharsSet& chars)
+	{
+		for (; pos < text.size(); ++pos)
+		{
+			if (chars.Contains(text[pos]))
+			{
+				return pos;
+			}
+		}
+
+		return text.size();
+	}
+
+
+#if TDE2_SCAN_KERNELS_X86
+
+	/*!
+		\brief SSE2 kernels
+	*/
+
+	TDE2_TARGET_SSE2 static size_t FindNewLineSSE2(std::string_view text, size_t pos)
+	{
+		const __m128i newLine = _mm_set1_epi8('\n');
+
+		for (; pos + 16 <= text.size(); pos += 16)
+		{
+			const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + pos));
+
+			if (const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chars, newLine))))
+			{
+				return pos + CountTrailingZeros(mask);
+			}
+		}
+
+		return FindNewLineScalar(text, pos);
+	}
+
+	TDE2_TARGET_SSE2 static size_t FindCommentDelimiterSSE2(std::string_view text, size_t pos)
+	{
+		const __m128i slash = _mm_set1_epi8('/');
+		const __m128i star = _mm_set1_epi8('*');
+
+		for (; pos + 17 <= text.size(); pos += 16)
+		{
+			const __m128i currChars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + pos));
+			const __m128i nextChars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + pos + 1));
+
+			const __m128i openings = _mm_and_si128(_mm_cmpeq_epi8(currChars, slash), _mm_cmpeq_epi8(nextChars, star));
+			const __m128i closings = _mm_and_si128(_mm_cmpeq_epi8(currChars, star), _mm_cmpeq_epi8(nextChars, slash));
+
+			if (const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(openings, closings))))
+			{
+				return pos + CountTrailingZeros(mask);
+			}
+		}
+
+		return FindCommentDelimiterScalar(text, pos);
+	}
+
+	TDE2_TARGET_SSE2 static size_t FindIdentifierEndSSE2(std::string_view text, size_t pos)
+	{
+		const __m128i caseBit = _mm_set1_epi8(0x20);
+		const __m128i lowerA = _mm_set1_epi8('a');
+		const __m128i lettersRange = _mm_set1_epi8('z' - 'a');
+		const __m128i zero = _mm_set1_epi8('0');
+		const __m128i digitsRange = _mm_set1_epi8('9' - '0');
+		const __m128i underscore = _mm_set1_epi8('_');
+
+		for (; pos + 16 <= text.size(); pos += 16)
+		{
+			const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + pos));
+
+			/// \note (x - low) <= range as unsigned bytes is checked with min(x - low, range) == x - low
+			const __m128i letters = _mm_sub_epi8(_mm_or_si128(chars, caseBit), lowerA);
+			const __m128i digits = _mm_sub_epi8(chars, zero);
+
+			__m128i identifierChars = _mm_cmpeq_epi8(_mm_min_epu8(letters, lettersRange), letters);
+			identifierChars = _mm_or_si128(identifierChars, _mm_cmpeq_epi8(_mm_min_epu8(digits, digitsRange), digits));
+			identifierChars = _mm_or_si128(identifierChars, _mm_cmpeq_epi8(chars, underscore));
+
+			if (const uint32_t mask = ~static_cast<uint32_t>(_mm_movemask_epi8(identifierChars)) & 0xFFFF)
+			{
+				return pos + CountTrailingZeros(mask);
+			}
+		}
+
+		return FindIdentifierEndScalar(text, pos);
+	}
+
+	TDE2_TARGET_SSE2 static size_t CountNewLinesSSE2(std::string_view text, size_t pos, size_t end)
+	{
+		const __m128i newLine = _mm_set1_epi8('\n');
+
+		end = (std::min)(end, text.size());
+
+		size_t count = 0;
+
+		for (; pos + 16 <= end; pos += 16)
+		{
+			const __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + pos));
+			count += CountBits(static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chars, newLine))));
+		}
+
+		return count + CountNewLinesScalar(text, pos, end);
+	}
+
+
+	TDE2_TARGET_SSE2 static size_t FindAnyOfCharsSSE2(std::string_view text, size_t pos, const TCharsSet& chars)
+	{
+		if (!chars.mCharsCount)
+		{
+			return text.size();
+		}
+
+		__m128i patterns[TCharsSet::mMaxCharsCount];
+
+		for (size_t i = 0; i < chars.mCharsCount; ++i)
+		{
+			patterns[i] = _mm_set1_epi8(chars.mChars[i]);
+		}
+
+		for (; pos + 16 <= text.size(); pos += 16)
+		{
+			const __m128i textChars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + pos));
+
+			__m128i matches = _mm_cmpeq_epi8(textChars, patterns[0]);
+
+			for (size_t i = 1; i < chars.mCharsCount; ++i)
+			{
+				matches = _mm_or_si128(matches, _mm_cmpeq_epi8(textChars, patterns[i]));
+			}
+
+			if (const uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(matches)))
+			{
+				return pos + CountTrailingZeros(mask);
+			}
+		}
+
+		return FindAnyOfCharsScalar(text, pos, chars);
+	}
+
+
+	/*!
+		\brief AVX2 kernels
+	*/
+
+	TDE2_TARGET_AVX2 static size_t FindNewLineAVX2(std::string_view text, size_t pos)
+	{
+		const __m256i newLine = _mm256_set1_epi8('\n');
+
+		for (; pos + 32 <= text.size(); pos += 32)
+		{
+			const __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text.data() + pos));
+
+			if (const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, newLine))))
+			{
+				return pos + CountTrailingZeros(mask);
+			}
+		}
+
+		return FindNewLineSSE2(text, pos);
+	}
+
+	TDE2_TARGET_AVX2 static size_t FindCommentDelimiterAVX2(std::string_view text, size_t pos)
+	{
+		const __m256i slash = _mm256_set1_epi8('/');
+		const __m256i star = _mm256_set1_epi8('*');
+
+		for (; pos + 33 <= text.size(); pos += 32)
+		{
+			const __m256i currChars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text.data() + pos));
+			const __m256i nextChars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text.data() + pos + 1));
+
+			const __m256i openings = _mm256_and_si256(_mm256_cmpeq_epi8(currChars, slash), _mm256_cmpeq_epi8(nextChars, star));
+			const __m256i closings = _mm256_and_si256(_mm256_cmpeq_epi8(currChars, star), _mm256_cmpeq_epi8(nextChars, slash));
+
+			if (const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(openings, closings))))
+			{
+				return pos + CountTrailingZeros(mask);
+			}
+		}
+
+		return FindCommentDelimiterSSE2(text, pos);
+	}
+
+	TDE2_TARGET_AVX2 static size_t FindIdentifierEndAVX2(std::string_view text, size_t pos)
+	{
+		const __m256i caseBit = _mm256_set1_epi8(0x20);
+		const __m256i lowerA = _mm256_set1_epi8('a');
+		const __m256i lettersRange = _mm256_set1_epi8('z' - 'a');
+		const __m256i zero = _mm256_set1_epi8('0');
+		const __m256i digitsRange = _mm256_set1_epi8('9' - '0');
+		const __m256i underscore = _mm256_set1_epi8('_');
+
+		for (; pos + 32 <= text.size(); pos += 32)
+		{
+			const __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text.data() + pos));
+
+			const __m256i letters = _mm256_sub_epi8(_mm256_or_si256(chars, caseBit), lowerA);
+			const __m256i digits = _mm256_sub_epi8(chars, zero);
+
+			__m256i identifierChars = _mm256_cmpeq_epi8(_mm256_min_epu8(letters, lettersRange), letters);
+			identifierChars = _mm256_or_si256(identifierChars, _mm256_cmpeq_epi8(_mm256_min_epu8(digits, digitsRange), digits));
+			identifierChars = _mm256_or_si256(identifierChars, _mm256_cmpeq_epi8(chars, underscore));
+
+			if (const uint32_t mask = ~static_cast<uint32_t>(_mm256_movemask_epi8(identifierChars)))
+			{
+				return pos + CountTrailingZeros(mask);
+			}
+		}
+
+		return FindIdentifierEndSSE2(text, pos);
+	}
+
+	TDE2_TARGET_AVX2 static size_t CountNewLinesAVX2(std::string_view text, size_t pos, size_t end)
+	{
+		const __m256i newLine = _mm256_set1_epi8('\n');
+
+		end = (std::min)(end, text.size());
+
+		size_t count = 0;
+
+		for (; pos + 32 <= end; pos += 32)
+		{
+			const __m256i chars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text.data() + pos));
+			count += CountBits(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chars, newLine))));
+		}
+
+		return count + CountNewLinesSSE2(text, pos, end);
+	}
+
+
+	TDE2_TARGET_AVX2 static size_t FindAnyOfCharsAVX2(std::string_view text, size_t pos, const TCharsSet& chars)
+	{
+		if (!chars.mCharsCount)
+		{
+			return text.size();
+		}
+
+		__m256i patterns[TCharsSet::mMaxCharsCount];
+
+		for (size_t i = 0; i < chars.mCharsCount; ++i)
+		{
+			patterns[i] = _mm256_set1_epi8(chars.mChars[i]);
+		}
+
+		for (; pos + 32 <= text.size(); pos += 32)
+		{
+			const __m256i textChars = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text.data() + pos));
+
+			__m256i matches = _mm256_cmpeq_epi8(textChars, patterns[0]);
+
+			for (size_t i = 1; i < chars.mCharsCount; ++i)
+			{
+				matches = _mm256_or_si256(matches, _mm256_cmpeq_epi8(textChars, patterns[i]));
+			}
+
+			if (const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(matches)))
+			{
+				return pos + CountTrailingZeros(mask);
+			}
+		}
+
+		return FindAnyOfCharsSSE2(text, pos, chars);
+	}
+
+
+	static bool IsAVX2Supported()
+	{
+#if defined(_MSC_VER)
+		int cpuInfo[4] = { 0 };
+		__cpuid(cpuInfo, 0);
+
+		if (cpuInfo[0] < 7)
+		{
+			return false;
+		}
+
+		__cpuid(cpuInfo, 1);
+
+		const bool isOSXSaveEnabled = (cpuInfo[2] & (1 << 27)) != 0;
+		const bool isAVXSupported = (cpuInfo[2] & (1 << 28)) != 0;
+
+		if (!isOSXSaveEnabled || !isAVXSupported || (_xgetbv(0) & 0x6) != 0x6) // \note The OS should save YMM registers
+		{
+			return false;
+		}
+
+		__cpuidex(cpuInfo, 7, 0);
+		return (cpuInfo[1] & (1 << 5)) != 0;
+#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+
+
+	static bool IsSSE2Supported()
+	{
+#if defined(_M_X64) || defined(__x86_64__)
+		return true;
+#elif defined(_MSC_VER)
+		int cpuInfo[4] = { 0 };
+		__cpuid(cpuInfo, 1);
+		return (cpuInfo[3] & (1 << 26)) != 0;
+#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("sse2");
+#endif
+	}
+
+#endif
+
+
+	static const TScanKernels ScalarKernels
+	{
+		E_SCAN_KERNELS_TYPE::SCALAR, &FindNewLineScalar, &FindCommentDelimiterScalar, &FindIdentifierEndScalar, &CountNewLinesScalar, &FindAnyOfCharsScalar
+	};
+
+#if TDE2_SCAN_KERNELS_X86
+	static const TScanKernels SSE2Kernels
+	{
+		E_SCAN_KERNELS_TYPE::SSE2, &FindNewLineSSE2, &FindCommentDelimiterSSE2, &FindIdentifierEndSSE2, &CountNewLinesSSE2, &FindAnyOfCharsSSE2
+	};
+
+	static const TScanKernels AVX2Kernels
+	{
+		E_SCAN_KERNELS_TYPE::AVX2, &FindNewLineAVX2, &FindCommentDelimiterAVX2, &FindIdentifierEndAVX2, &CountNewLinesAVX2, &FindAnyOfCharsAVX2
+	};
+#endif
+
+
+	bool TCharsSet::Add(char ch) TDE2_NOEXCEPT
+	{
+		if (Contains(ch))
+		{
+			return true;
+		}
+
+		if (mCharsCount >= mMaxCharsCount)
+		{
+			return false;
+		}
+
+		mChars[mCharsCount++] = ch;
+
+		return true;
+	}
+
+	bool TCharsSet::Contains(char ch) const TDE2_NOEXCEPT
+	{
+		for (size_t i = 0; i < mCharsCount; ++i)
+		{
+			if (mChars[i] == ch)
+			{
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+
+	bool IsScanKernelsTypeSupported(E_SCAN_KERNELS_TYPE type) TDE2_NOEXCEPT
+	{
+		switch (type)
+		{
+			case E_SCAN_KERNELS_TYPE::SCALAR:
+				return true;
+#if TDE2_SCAN_KERNELS_X86
+			case E_SCAN_KERNELS_TYPE::SSE2:
+				return IsSSE2Supported();
+			case E_SCAN_KERNELS_TYPE::AVX2:
+				return IsAVX2Supported();
+#endif
+			default:
+				break;
+		}
+
+		return false;
+	}
+
+
+	const TScanKernels& GetScanKernels(E_SCAN_KERNELS_TYPE type) TDE2_NOEXCEPT
+	{
+#if TDE2_SCAN_KERNELS_X86
+		if (E_SCAN_KERNELS_TYPE::AVX2 == type && IsScanKernelsTypeSupported(E_SCAN_KERNELS_TYPE::AVX2))
+		{
+			return AVX2Kernels;
+		}
+
+		if (E_SCAN_KERNELS_TYPE::SCALAR != type && IsScanKernelsTypeSupported(E_SCAN_KERNELS_TYPE::SSE2))
+		{
+			return SSE2Kernels;
+		}
+#endif
+
+		return ScalarKernels;
+	}
+
+
+	const TScanKernels& GetScanKernels() TDE2_NOEXCEPT
+	{
+		static const TScanKernels& kernels = GetScanKernels(E_SCAN_KERNELS_TYPE::AVX2);
+		return kernels;
+	}
+
+
+	size_t FindMacroDefinitionEnd(const TScanKernels& kernels, std::string_view text, size_t pos) TDE2_NOEXCEPT
+	{
+		while (pos < text.size())
+		{
+			const size_t newLinePos = kernels.mpFindNewLine(text, pos);
+			if (newLinePos >= text.size())
+			{
+				break;
+			}
+
+			size_t lastCharPos = newLinePos;
+
+			if (lastCharPos > pos && text[lastCharPos - 1] == '\r')
+			{
+				--lastCharPos;
+			}
+
+			if (lastCharPos == pos || text[lastCharPos - 1] != '\\') // \note The line isn't continued
+			{
+				return newLinePos;
+			}
+
+			pos = newLinePos + 1;
+		}
+
+		return text.size();
+	}
+
+
+	namespace
+	{
+		constexpr std::string_view BeginIgnoreSectionKeyword = "BEGIN_IGNORE_META_SECTION";
+		constexpr std::string_view EndIgnoreSectionKeyword = "END_IGNORE_META_SECTION";
+
+
+		bool IsKeywordAt(std::string_view text, size_t pos, std::string_view keyword)
+		{
+			if (pos > 0 && IsIdentifierChar(text[pos - 1]))
+			{
+				return false;
+			}
+
+			const size_t endPos = pos + keyword.size();
+
+			return (text.compare(pos, keyword.size(), keyword) == 0) && (endPos >= text.size() || !IsIdentifierChar(text[endPos]));
+		}
+
+
+		size_t SkipQuotedLiteral(std::string_view text, size_t pos)
+		{
+			const char quoteCh = text[pos];
+
+			for (++pos; pos < text.size(); ++pos)
+			{
+				const char ch = text[pos];
+
+				if ('\\' == ch)
+				{
+					++pos;
+					continue;
+				}
+
+				if (quoteCh == ch)
+				{
+					return pos + 1;
+				}
+
+				if ('\n' == ch) // \note An unterminated literal ends with its line
+				{
+					return pos;
+				}
+			}
+
+			return text.size();
+		}
+
+
+		/*!
+			\brief The function returns a position right after a comment, a string or char literal or a preprocessor
+			directive that starts at pos. If there is no one, pos + 1 is returned. Comments are nested as the lexer treats them
+		*/
+
+		size_t SkipNonCodeRegion(const TScanKernels& kernels, std::string_view text, size_t pos)
+		{
+			const char ch = text[pos];
+			const char nextCh = (pos + 1 < text.size()) ? text[pos + 1] : '\0';
+
+			switch (ch)
+			{
+				case '/':
+					if ('/' == nextCh)
+					{
+						return kernels.mpFindNewLine(text, pos + 2);
+					}
+
+					if ('*' == nextCh)
+					{
+						uint32_t depth = 1;
+
+						for (pos += 2; depth > 0; pos += 2)
+						{
+							pos = kernels.mpFindCommentDelimiter(text, pos);
+							if (pos >= text.size())
+							{
+								return text.size();
+							}
+
+							depth = (text[pos] == '/') ? (depth + 1) : (depth - 1);
+						}
+
+						return pos;
+					}
+
+					break;
+				case '"':
+					return SkipQuotedLiteral(text, pos);
+				case '\'':
+					/// \note A quote between digits is a separator of a number like 1'000, not a literal
+					if (pos > 0 && std::isdigit(static_cast<unsigned char>(text[pos - 1])) &&
+						IsIdentifierChar(nextCh) && (pos + 2 >= text.size() || text[pos + 2] != '\''))
+					{
+						break;
+					}
+
+					return SkipQuotedLiteral(text, pos);
+				case '#':
+					return FindMacroDefinitionEnd(kernels, text, pos + 1);
+			}
+
+			return pos + 1;
+		}
+	}
+
+
+	size_t FindIgnoreSectionEnd(const TScanKernels& kernels, std::string_view text, size_t pos) TDE2_NOEXCEPT
+	{
+		TCharsSet chars;
+		chars.Add(EndIgnoreSectionKeyword.front());
+		chars.Add('/');
+		chars.Add('"');
+		chars.Add('\'');
+		chars.Add('#');
+
+		while ((pos = kernels.mpFindAnyOfChars(text, pos, chars)) < text.size())
+		{
+			if (text[pos] != EndIgnoreSectionKeyword.front())
+			{
+				pos = SkipNonCodeRegion(kernels, text, pos);
+				continue;
+			}
+
+			if (IsKeywordAt(text, pos, EndIgnoreSectionKeyword))
+			{
+				return pos + EndIgnoreSectionKeyword.size();
+			}
+
+			++pos;
+		}
+
+		return text.size();
+	}
+
+	size_t FindBalancedBlockEnd(const TScanKernels& kernels, std::string_view text, size_t openBracePos) TDE2_NOEXCEPT
+	{
+		assert(openBracePos < text.size() && text[openBracePos] == '{');
+
+		TCharsSet chars;
+		chars.Add('{');
+		chars.Add('}');
+		chars.Add(BeginIgnoreSectionKeyword.front());
+		chars.Add('/');
+		chars.Add('"');
+		chars.Add('\'');
+		chars.Add('#');
+
+		size_t depth = 1;
+
+		for (size_t pos = openBracePos + 1; (pos = kernels.mpFindAnyOfChars(text, pos, chars)) < text.size(); )
+		{
+			switch (text[pos])
+			{
+				case '{':
+					++depth;
+					++pos;
+					break;
+				case '}':
+					if (!--depth)
+					{
+						return pos + 1;
+					}
+
+					++pos;
+					break;
+				case BeginIgnoreSectionKeyword.front():
+					pos = IsKeywordAt(text, pos, BeginIgnoreSectionKeyword) ? FindIgnoreSectionEnd(kernels, text, pos + BeginIgnoreSectionKeyword.size()) : (pos + 1);
+					break;
+				default:
+					pos = SkipNonCodeRegion(kernels, text, pos);
+					break;
+			}
+		}
+
+		return text.size();
+	}
+}
@@ -1,7 +1,9 @@
 #include "../include/symtable.h"
+#include "../include/cacheformat.h"
 #include "../deps/archive/archive.h"
 #include <algorithm>
 #include <cassert>
+#include <cstring>
 
 
 namespace TDEngine2
@@ -17,26 +19,26 @@ namespace TDEngine2
 		return pType->Save(archive);
 	}
 
-	std::unique_ptr<TType> TType::Deserialize(FileReaderArchive& archive, SymTable* pSymTable)
+	TType* TType::Deserialize(FileReaderArchive& archive, MemoryArena& arena, SymTable* pSymTable)
 	{
 		uint32_t subtypeValue = 0;
 		archive >> subtypeValue;
 
-		std::unique_ptr<TType> pType = nullptr;
+		TType* pType = nullptr;
 
 		switch (static_cast<TType::E_SUBTYPE>(subtypeValue))
 		{
 			case TType::E_SUBTYPE::BASE:
-				pType = std::make_unique<TType>();
+				pType = arena.Create<TType>();
 				break;
 			case TType::E_SUBTYPE::ENUM:
-				pType = std::make_unique<TEnumType>();
+				pType = arena.Create<TEnumType>();
 				break;
 			case TType::E_SUBTYPE::CLASS:
-				pType = std::make_unique<TClassType>();
+				pType = arena.Create<TClassType>();
 				break;
 			case TType::E_SUBTYPE::NAMESPACE:
-				pType = std::make_unique<TNamespaceType>();
+				pType = arena.Create<TNamespaceType>();
 				break;
 			case TType::E_SUBTYPE::UNKNOWN:
 				break;
@@ -53,319 +55,810 @@ namespace TDEngine2
 		return pType;
 	}
 
+	namespace
+	{
+		void LoadEnumFields(TEnumType& type, FileReaderArchive& archive)
+		{
+			archive >> type.mIsStronglyTyped >> type.mIsIntrospectable >> type.mIsForwardDeclaration;
+			archive >> type.mUnderlyingTypeStr;
+
+			uint32_t enumeratorsCount = 0;
+			archive >> enumeratorsCount;
+
+			std::string currEnumeratorValue;
+
+			for (size_t i = 0; i < enumeratorsCount; ++i)
+			{
+				archive >> currEnumeratorValue;
+				type.mEnumerators.push_back(currEnumeratorValue);
+			}
+		}
+
+		void SaveEnumFields(const TEnumType& type, FileWriterArchive& archive)
+		{
+			archive << type.mIsStronglyTyped << type.mIsIntrospectable << type.mIsForwardDeclaration;
+			archive << type.mUnderlyingTypeStr;
+
+			archive << static_cast<uint32_t>(type.mEnumerators.size());
+
+			for (auto&& currEnumeratorStr : type.mEnumerators)
+			{
+				archive << currEnumeratorStr.GetString();
+			}
+		}
+
+		void LoadClassFields(TClassType& type, FileReaderArchive& archive)
+		{
+			archive >> type.mIsFinal >> type.mIsForwardDeclaration >> type.mIsStruct >> type.mIsTemplate;
+
+			size_t baseClassesCount = 0;
+			archive >> baseClassesCount;
+
+			std::string fullNameStr;
+			bool isVirtualInherited;
+			uint32_t accessSpecifier;
+
+			for (size_t i = 0; i < baseClassesCount; ++i)
+			{
+				archive >> fullNameStr;
+				archive >> isVirtualInherited;
+				archive >> accessSpecifier;
+
+				type.mBaseClasses.push_back({ fullNameStr, isVirtualInherited, static_cast<E_ACCESS_SPECIFIER_TYPE>(accessSpecifier) });
+			}
+		}
+
+		void SaveClassFields(const TClassType& type, FileWriterArchive& archive)
+		{
+			archive << type.mIsFinal << type.mIsForwardDeclaration << type.mIsStruct << type.mIsTemplate;
+
+			archive << type.mBaseClasses.size();
+
+			for (auto&& baseClassEntity : type.mBaseClasses)
+			{
+				archive << baseClassEntity.mFullName.GetString();
+				archive << baseClassEntity.mIsVirtualInherited;
+				archive << static_cast<uint32_t>(baseClassEntity.mAccessSpecifier);
+			}
+		}
+	}
+
+
 	bool TType::Load(FileReaderArchive& archive)
 	{
-		archive >> mId >> mMangledId;
+		std::string id, mangledId;
+		archive >> id >> mangledId;
+
+		mId = id;
+		mMangledId = mangledId;
+
+		switch (mSubtype)
+		{
+			case E_SUBTYPE::ENUM:
+				LoadEnumFields(*static_cast<TEnumType*>(this), archive);
+				break;
+			case E_SUBTYPE::CLASS:
+				LoadClassFields(*static_cast<TClassType*>(this), archive);
+				break;
+			default:
+				break;
+		}
+
 		return true;
 	}
 
 	bool TType::Save(FileWriterArchive& archive)
 	{
-		archive << static_cast<uint32_t>(GetSubtype());
-		archive << mId << mMangledId;
+		archive << static_cast<uint32_t>(mSubtype);
+		archive << mId.GetString() << mMangledId.GetString();
+
+		switch (mSubtype)
+		{
+			case E_SUBTYPE::ENUM:
+				SaveEnumFields(*static_cast<const TEnumType*>(this), archive);
+				break;
+			case E_SUBTYPE::CLASS:
+				SaveClassFields(*static_cast<const TClassType*>(this), archive);
+				break;
+			default:
+				break;
+		}
 
 		return true;
 	}
 
 	void TType::Visit(ITypeVisitor& visitor) const
 	{
-		visitor.VisitBaseType(*this);
+		switch (mSubtype)
+		{
+			case E_SUBTYPE::NAMESPACE:
+				visitor.VisitNamespaceType(*static_cast<const TNamespaceType*>(this));
+				break;
+			case E_SUBTYPE::ENUM:
+				visitor.VisitEnumType(*static_cast<const TEnumType*>(this));
+				break;
+			case E_SUBTYPE::CLASS:
+				visitor.VisitClassType(*static_cast<const TClassType*>(this));
+				break;
+			default:
+				visitor.VisitBaseType(*this);
+				break;
+		}
 	}
 
-	void TNamespaceType::Visit(ITypeVisitor& visitor) const
-	{
-		visitor.VisitNamespaceType(*this);
-	}
 
-	bool TEnumType::Load(FileReaderArchive& archive)
+	namespace
 	{
-		bool result = TType::Load(archive);
+		template <typename T>
+		TType* CopyType(SymTable& symTable, const TType& type)
+		{
+			T* pType = symTable.CreateType<T>();
 
-		archive >> mIsStronglyTyped >> mIsIntrospectable >> mIsForwardDeclaration;
-		archive >> mUnderlyingTypeStr;
+			*pType = static_cast<const T&>(type);
+			pType->mpOwner = &symTable;
 
-		uint32_t enumeratorsCount = 0;
-		archive >> enumeratorsCount;
+			return pType;
+		}
+	}
 
-		std::string currEnumeratorValue;
 
-		for (size_t i = 0; i < enumeratorsCount; ++i)
-		{
-			archive >> currEnumeratorValue;
-			mEnumerators.push_back(currEnumeratorValue);
-		}
+	const TSymbolDesc TSymbolDesc::mInvalid { "", nullptr };
 
-		return result;
+	bool operator!= (const TSymbolDesc& leftSymbol, const TSymbolDesc& rightSymbol)
+	{
+		return (leftSymbol.mName != rightSymbol.mName); // \todo add comparison of types
 	}
 
-	bool TEnumType::Save(FileWriterArchive& archive)
+	bool operator== (const TSymbolDesc& leftSymbol, const TSymbolDesc& rightSymbol)
 	{
-		bool result = TType::Save(archive);
-
-		archive << mIsStronglyTyped << mIsIntrospectable << mIsForwardDeclaration;
-		archive << mUnderlyingTypeStr;
+		return (leftSymbol.mName == rightSymbol.mName); // \todo add comparison of types
+	}
 
-		archive << static_cast<uint32_t>(mEnumerators.size());
 
-		for (auto&& currEnumeratorStr : mEnumerators)
+	SymTable::TScopeIndex SymTable::TScopeEntity::FindNamedScope(const TAtom& name) const
+	{
+		if (!mNamedScopesCount)
 		{
-			archive << currEnumeratorStr;
+			return mInvalidScopeIndex;
 		}
 
-		return result;
-	}
+		const size_t mask = mNamedScopesSlots.size() - 1;
 
-	void TEnumType::Visit(ITypeVisitor& visitor) const
-	{
-		visitor.VisitEnumType(*this);
+		for (size_t slotIndex = name.GetHash() & mask; ; slotIndex = (slotIndex + 1) & mask)
+		{
+			const TNamedScopeSlot& currSlot = mNamedScopesSlots[slotIndex];
+
+			if (mInvalidScopeIndex == currSlot.mIndex || currSlot.mName == name)
+			{
+				return currSlot.mIndex;
+			}
+		}
 	}
 
-	bool TClassType::Load(FileReaderArchive& archive)
+	bool SymTable::TScopeEntity::AddNamedScope(const TAtom& name, TScopeIndex index)
 	{
-		bool result = TType::Load(archive);
+		if (mInvalidScopeIndex != FindNamedScope(name))
+		{
+			return false;
+		}
 
-		archive >> mIsFinal >> mIsForwardDeclaration >> mIsStruct >> mIsTemplate;
+		/// \note Keep the table at most half full, so probe sequences are short and always end with an empty slot
+		if (2 * (mNamedScopesCount + 1) > mNamedScopesSlots.size())
+		{
+			std::vector<TNamedScopeSlot> prevSlots(std::max<size_t>(4, 2 * mNamedScopesSlots.size()));
+			std::swap(prevSlots, mNamedScopesSlots);
 
-		size_t baseClassesCount = 0;
-		archive >> baseClassesCount;
+			mNamedScopesCount = 0;
 
-		std::string fullNameStr;
-		bool isVirtualInherited;
-		uint32_t accessSpecifier;
+			for (auto&& currSlot : prevSlots)
+			{
+				if (mInvalidScopeIndex != currSlot.mIndex)
+				{
+					AddNamedScope(currSlot.mName, currSlot.mIndex);
+				}
+			}
+		}
 
-		for (size_t i = 0; i < baseClassesCount; ++i)
-		{
-			archive >> fullNameStr;
-			archive >> isVirtualInherited;
-			archive >> accessSpecifier;
+		const size_t mask = mNamedScopesSlots.size() - 1;
 
-			mBaseClasses.push_back({ fullNameStr, isVirtualInherited, static_cast<E_ACCESS_SPECIFIER_TYPE>(accessSpecifier) });
+		size_t slotIndex = name.GetHash() & mask;
+		while (mInvalidScopeIndex != mNamedScopesSlots[slotIndex].mIndex)
+		{
+			slotIndex = (slotIndex + 1) & mask;
 		}
 
-		return result;
+		mNamedScopesSlots[slotIndex] = { name, index };
+		++mNamedScopesCount;
+
+		return true;
 	}
 
-	bool TClassType::Save(FileWriterArchive& archive)
+
+	uint32_t SymTable::TScopeEntity::FindSymbol(const TAtom& name) const
 	{
-		bool result = TType::Save(archive);
+		const uint32_t symbolsCount = static_cast<uint32_t>(mVariables.size());
 
-		archive << mIsFinal << mIsForwardDeclaration << mIsStruct << mIsTemplate;
+		if (symbolsCount < mSymbolsIndexThreshold)
+		{
+			for (uint32_t i = 0; i < symbolsCount; ++i)
+			{
+				if (mVariables[i].mName == name)
+				{
+					return i;
+				}
+			}
 
-		archive << mBaseClasses.size();
+			return mInvalidSymbolIndex;
+		}
 
-		for (auto&& baseClassEntity : mBaseClasses)
+		/// \note Append variables that were added since the last lookup, so the index is built once per scope
+		for (; mIndexedSymbolsCount < symbolsCount; ++mIndexedSymbolsCount)
 		{
-			archive << baseClassEntity.mFullName;
-			archive << baseClassEntity.mIsVirtualInherited;
-			archive << static_cast<uint32_t>(baseClassEntity.mAccessSpecifier);
+			mSymbolsIndex.emplace(mVariables[mIndexedSymbolsCount].mName, mIndexedSymbolsCount);
 		}
 
-		return result;
+		auto it = mSymbolsIndex.find(name);
+		return (it == mSymbolsIndex.cend()) ? mInvalidSymbolIndex : it->second;
 	}
 
-	void TClassType::Visit(ITypeVisitor& visitor) const
+	void SymTable::TScopeEntity::AddSymbol(TSymbolDesc&& desc)
 	{
-		visitor.VisitClassType(*this);
+		const uint32_t symbolIndex = FindSymbol(desc.mName);
+		if (mInvalidSymbolIndex != symbolIndex) // \note there is already symbol with the same name than update it
+		{
+			mVariables[symbolIndex].mpType = desc.mpType;
+			return;
+		}
+
+		mVariables.emplace_back(std::forward<TSymbolDesc>(desc));
 	}
 
 
-	const TSymbolDesc TSymbolDesc::mInvalid { "", nullptr };
-
-	bool operator!= (const TSymbolDesc& leftSymbol, const TSymbolDesc& rightSymbol)
+	SymTable::SymTable()
 	{
-		return (leftSymbol.mName != rightSymbol.mName); // \todo add comparison of types
+		_reset();
 	}
 
-	bool operator== (const TSymbolDesc& leftSymbol, const TSymbolDesc& rightSymbol)
+	SymTable::~SymTable()
 	{
-		return (leftSymbol.mName == rightSymbol.mName); // \todo add comparison of types
 	}
 
-
-	SymTable::SymTable():
-		mpGlobalScope(new TScopeEntity), mpCurrScope(mpGlobalScope.get()), mpPrevScope(nullptr)
+	bool SymTable::Save(FileWriterArchive& archive)
 	{
-		mpGlobalScope->mpParentScope = nullptr;
+		archive << mArchiveTag;
+		archive << static_cast<uint32_t>(mScopes.size());
+
+		for (auto&& currScope : mScopes)
+		{
+			archive << currScope.mParentIndex << currScope.mName.GetString() << currScope.mIndex;
+
+			// \note Save variables
+			archive << static_cast<uint32_t>(currScope.mVariables.size());
+
+			for (auto&& currVariableInfo : currScope.mVariables)
+			{
+				archive << currVariableInfo.mName.GetString();
+
+				TType::SafeSerialize(archive, currVariableInfo.mpType);
+			}
+
+			TType::SafeSerialize(archive, currScope.mpType);
+		}
+
+		archive << mSourceFilename << mIsSkipped;
+
+		return true;
 	}
 
-	SymTable::~SymTable()
+	bool SymTable::Load(FileReaderArchive& archive)
 	{
+		_reset();
+
+		uint32_t tag = 0;
+		archive >> tag;
+
+		if (mArchiveTag != tag)
+		{
+			return false;
+		}
+
+		uint32_t scopesCount = 0;
+		archive >> scopesCount;
+
+		std::string name;
+		uint32_t variablesCount = 0;
+
+		mScopes.reserve(scopesCount);
+
+		for (uint32_t i = 0; i < scopesCount; ++i)
+		{
+			TScopeIndex parentIndex = mInvalidScopeIndex;
+			int32_t index = -1;
+
+			archive >> parentIndex >> name >> index;
+
+			if (i > 0 && parentIndex >= i) // \note Parents always precede their children
+			{
+				return false;
+			}
+
+			TScopeEntity& currScope = (0 == i) ? mScopes.front() : mScopes[_addScope(parentIndex, name)];
+			currScope.mIndex = index;
+
+			archive >> variablesCount;
+
+			currScope.mVariables.resize(variablesCount);
+
+			for (auto&& currVariableInfo : currScope.mVariables)
+			{
+				archive >> name;
+
+				currVariableInfo.mName = name;
+				currVariableInfo.mpType = TType::Deserialize(archive, mArena, this);
+			}
+
+			SetScopeType(currScope, TType::Deserialize(archive, mArena, this));
+		}
+
+		archive >> mSourceFilename >> mIsSkipped;
+
+		return true;
 	}
 
-	bool SymTable::TScopeEntity::Save(FileWriterArchive& archive)
+	std::string SymTable::SaveImage(const std::string& optionsDigest) const
 	{
-		archive << mpNestedScopes.size();
+		using namespace CacheFormat;
+
+		std::vector<TStringRecord> strings;
+		std::string stringsData;
+		std::unordered_map<std::string, uint32_t> stringsIndices;
 
-		for (auto&& pCurrScope : mpNestedScopes)
+		auto addString = [&strings, &stringsData, &stringsIndices](const std::string& value)
 		{
-			if (!pCurrScope)
+			auto it = stringsIndices.find(value);
+			if (it != stringsIndices.cend())
 			{
-				continue; 
+				return it->second;
 			}
 
-			pCurrScope->Save(archive);
-		}
+			const uint32_t index = static_cast<uint32_t>(strings.size());
+
+			strings.push_back({ static_cast<uint32_t>(stringsData.size()), static_cast<uint32_t>(value.size()) });
+			stringsData.append(value);
+			stringsIndices.emplace(value, index);
+
+			return index;
+		};
 
-		archive << mpNamedScopes.size();
+		std::vector<const TType*> pTypes;
+		std::unordered_map<const TType*, uint32_t> typesIndices;
 
-		for (auto&& currScopeEntity : mpNamedScopes)
+		auto addType = [&pTypes, &typesIndices](const TType* pType)
 		{
-			archive << currScopeEntity.first;
+			if (!pType)
+			{
+				return mInvalidIndex;
+			}
 
-			if (!currScopeEntity.second)
+			auto it = typesIndices.find(pType);
+			if (it != typesIndices.cend())
 			{
-				continue;
+				return it->second;
 			}
 
-			currScopeEntity.second->Save(archive);
+			const uint32_t index = static_cast<uint32_t>(pTypes.size());
+
+			pTypes.push_back(pType);
+			typesIndices.emplace(pType, index);
+
+			return index;
+		};
+
+		std::vector<TScopeRecord> scopes;
+		std::vector<TSymbolRecord> symbols;
+
+		scopes.reserve(mScopes.size());
+
+		for (auto&& currScope : mScopes)
+		{
+			scopes.push_back({ currScope.mParentIndex, addString(currScope.mName.GetString()), static_cast<uint32_t>(currScope.mIndex), addType(currScope.mpType),
+							   currScope.mTypeSlotIndex, static_cast<uint32_t>(symbols.size()), static_cast<uint32_t>(currScope.mVariables.size()) });
+
+			for (auto&& currVariable : currScope.mVariables)
+			{
+				symbols.push_back({ addString(currVariable.mName.GetString()), addType(currVariable.mpType) });
+			}
 		}
 
-		// \note Save variables
-		archive << mVariables.size();
+		/// \note Parents are appended to the end of the array, so they're written too
+		for (size_t i = 0; i < pTypes.size(); ++i)
+		{
+			addType(pTypes[i]->mpParentType);
+		}
+
+		std::vector<TTypeRecord> types;
+		std::vector<TAtomRecord> atoms;
+		std::vector<TBaseClassRecord> baseClasses;
+
+		types.reserve(pTypes.size());
 
-		for (auto&& currVariableInfo : mVariables)
+		for (const TType* pType : pTypes)
 		{
-			archive << currVariableInfo.mName;
-			
-			TType::SafeSerialize(archive, currVariableInfo.mpType.get());
+			TTypeRecord record { static_cast<uint32_t>(pType->GetSubtype()), addString(pType->mId.GetString()), addString(pType->mMangledId.GetString()),
+								 addString(pType->mSectionId), addType(pType->mpParentType), static_cast<uint32_t>(pType->mAccessModifier),
+								 pType->mIsMarkedWithAttribute ? TF_MARKED_WITH_ATTRIBUTE : 0u, mInvalidIndex, static_cast<uint32_t>(atoms.size()), 0,
+								 static_cast<uint32_t>(baseClasses.size()), 0 };
+
+			if (const TEnumType* pEnumType = TypeCast<TEnumType>(pType))
+			{
+				record.mFlags |= (pEnumType->mIsStronglyTyped ? TF_STRONGLY_TYPED : 0u) | (pEnumType->mIsIntrospectable ? TF_INTROSPECTABLE : 0u) |
+								 (pEnumType->mIsForwardDeclaration ? TF_FORWARD_DECLARATION : 0u);
+				record.mUnderlyingTypeIndex = addString(pEnumType->mUnderlyingTypeStr);
+
+				for (auto&& currEnumerator : pEnumType->mEnumerators)
+				{
+					atoms.push_back({ addString(currEnumerator.GetString()) });
+				}
+			}
+			else if (const TClassType* pClassType = TypeCast<TClassType>(pType))
+			{
+				record.mFlags |= (pClassType->mIsFinal ? TF_FINAL : 0u) | (pClassType->mIsStruct ? TF_STRUCT : 0u) | (pClassType->mIsTemplate ? TF_TEMPLATE : 0u) |
+								 (pClassType->mIsForwardDeclaration ? TF_FORWARD_DECLARATION : 0u);
+
+				for (auto&& currField : pClassType->mFields)
+				{
+					atoms.push_back({ addString(currField.GetString()) });
+				}
+
+				for (auto&& currBaseClass : pClassType->mBaseClasses)
+				{
+					baseClasses.push_back({ addString(currBaseClass.mFullName.GetString()), currBaseClass.mIsVirtualInherited ? 1u : 0u,
+											static_cast<uint32_t>(currBaseClass.mAccessSpecifier) });
+				}
+			}
+
+			record.mAtomsCount = static_cast<uint32_t>(atoms.size()) - record.mFirstAtomIndex;
+			record.mBaseClassesCount = static_cast<uint32_t>(baseClasses.size()) - record.mFirstBaseClassIndex;
+
+			types.push_back(record);
 		}
 
-		archive << (mIndex >= 0 ? mIndex : (std::numeric_limits<int>::max)());
+		const uint64_t optionsDigestHash = ComputeOptionsDigestHash(optionsDigest);
 
-		TType::SafeSerialize(archive, mpType.get());
+		THeader header { mMagic, mVersion, ToolVersion.mMajor, ToolVersion.mMinor, static_cast<uint32_t>(optionsDigestHash), static_cast<uint32_t>(optionsDigestHash >> 32),
+						 mIsSkipped ? IF_SKIPPED : 0u, addString(mSourceFilename) };
 
-		return true;
+		header.mStringsCount     = static_cast<uint32_t>(strings.size());
+		header.mScopesCount      = static_cast<uint32_t>(scopes.size());
+		header.mSymbolsCount     = static_cast<uint32_t>(symbols.size());
+		header.mTypesCount       = static_cast<uint32_t>(types.size());
+		header.mAtomsCount       = static_cast<uint32_t>(atoms.size());
+		header.mBaseClassesCount = static_cast<uint32_t>(baseClasses.size());
+		header.mStringsDataSize  = static_cast<uint32_t>(stringsData.size());
+		header.mReserved         = 0;
+
+		const TLayout layout = GetLayout(header);
+
+		std::vector<uint32_t> words(layout.mStringsDataOffset / sizeof(uint32_t));
+
+		auto writeRecords = [&words](size_t offset, const void* pRecords, size_t size)
+		{
+			if (size)
+			{
+				memcpy(reinterpret_cast<uint8_t*>(words.data()) + offset, pRecords, size);
+			}
+		};
+
+		writeRecords(0, &header, sizeof(header));
+		writeRecords(layout.mStringsOffset, strings.data(), strings.size() * sizeof(TStringRecord));
+		writeRecords(layout.mScopesOffset, scopes.data(), scopes.size() * sizeof(TScopeRecord));
+		writeRecords(layout.mSymbolsOffset, symbols.data(), symbols.size() * sizeof(TSymbolRecord));
+		writeRecords(layout.mTypesOffset, types.data(), types.size() * sizeof(TTypeRecord));
+		writeRecords(layout.mAtomsOffset, atoms.data(), atoms.size() * sizeof(TAtomRecord));
+		writeRecords(layout.mBaseClassesOffset, baseClasses.data(), baseClasses.size() * sizeof(TBaseClassRecord));
+
+		SwapWordsIfBigEndian(words.data(), words.size());
+
+		std::string image(reinterpret_cast<const char*>(words.data()), layout.mStringsDataOffset);
+		image.append(stringsData);
+
+		return image;
 	}
 
-	bool SymTable::TScopeEntity::Load(FileReaderArchive& archive, SymTable* symTable)
+	bool SymTable::LoadImage(std::string_view image, const std::string& optionsDigest)
 	{
-		size_t nestedScopesCount = 0;
-		archive >> nestedScopesCount;
+		using namespace CacheFormat;
+
+		_reset();
 
-		for (size_t i = 0; i < nestedScopesCount; ++i)
+		if (!IsImage(image))
 		{
-			mpNestedScopes.emplace_back(std::make_unique<TScopeEntity>());
+			return false;
+		}
+
+		THeader header;
+		memcpy(&header, image.data(), sizeof(header));
+		SwapWordsIfBigEndian(reinterpret_cast<uint32_t*>(&header), sizeof(header) / sizeof(uint32_t));
 
-			auto pCurrScope = mpNestedScopes.back().get();
+		const uint64_t optionsDigestHash = ComputeOptionsDigestHash(optionsDigest);
 
-			pCurrScope->Load(archive, symTable);
-			pCurrScope->mpParentScope = this;
+		if (ToolVersion.mMajor != header.mToolVersionMajor || ToolVersion.mMinor != header.mToolVersionMinor ||
+			static_cast<uint32_t>(optionsDigestHash) != header.mOptionsDigestLow || static_cast<uint32_t>(optionsDigestHash >> 32) != header.mOptionsDigestHigh)
+		{
+			return false;
 		}
 
-		size_t namedScopesCount = 0;
-		archive >> namedScopesCount;
+		const TLayout layout = GetLayout(header);
+		if (layout.mSize != image.size() || !header.mScopesCount) // \note The global scope is always written
+		{
+			return false;
+		}
+
+		/// \note Records are read in place unless the image is misaligned or the host is big-endian, then they're copied once
+		std::vector<uint32_t> words;
 
-		std::string scopeName;
+		const uint8_t* pRecordsData = reinterpret_cast<const uint8_t*>(image.data());
 
-		for (size_t i = 0; i < namedScopesCount; ++i)
+		if (!IsLittleEndianHost() || (reinterpret_cast<uintptr_t>(pRecordsData) % alignof(uint32_t)))
 		{
-			archive >> scopeName;
+			words.resize(layout.mStringsDataOffset / sizeof(uint32_t));
+			memcpy(words.data(), pRecordsData, layout.mStringsDataOffset);
+			SwapWordsIfBigEndian(words.data(), words.size());
+
+			pRecordsData = reinterpret_cast<const uint8_t*>(words.data());
+		}
 
-			mpNamedScopes.emplace(scopeName, std::make_unique<TScopeEntity>());
-			
-			auto pCurrScope = mpNamedScopes[scopeName].get();
+		const TStringRecord* pStrings = reinterpret_cast<const TStringRecord*>(pRecordsData + layout.mStringsOffset);
+		const TScopeRecord* pScopes = reinterpret_cast<const TScopeRecord*>(pRecordsData + layout.mScopesOffset);
+		const TSymbolRecord* pSymbols = reinterpret_cast<const TSymbolRecord*>(pRecordsData + layout.mSymbolsOffset);
+		const TTypeRecord* pTypeRecords = reinterpret_cast<const TTypeRecord*>(pRecordsData + layout.mTypesOffset);
+		const TAtomRecord* pAtoms = reinterpret_cast<const TAtomRecord*>(pRecordsData + layout.mAtomsOffset);
+		const TBaseClassRecord* pBaseClasses = reinterpret_cast<const TBaseClassRecord*>(pRecordsData + layout.mBaseClassesOffset);
 
-			pCurrScope->Load(archive, symTable);
-			pCurrScope->mpParentScope = this;
+		const std::string_view stringsData = image.substr(layout.mStringsDataOffset);
+
+		auto isInRange = [](uint32_t first, uint32_t count, uint32_t size)
+		{
+			return first <= size && count <= size - first;
+		};
+
+		std::vector<TAtom> strings(header.mStringsCount);
+
+		for (uint32_t i = 0; i < header.mStringsCount; ++i)
+		{
+			if (!isInRange(pStrings[i].mOffset, pStrings[i].mLength, header.mStringsDataSize))
+			{
+				return false;
+			}
+
+			strings[i] = stringsData.substr(pStrings[i].mOffset, pStrings[i].mLength);
 		}
 
-		// \note Save variables
-		size_t variablesCount = 0;
-		archive >> variablesCount;
+		bool isDamaged = false;
+
+		auto getString = [&strings, &isDamaged](uint32_t index)
+		{
+			if (index < strings.size())
+			{
+				return strings[index];
+			}
 
-		mVariables.resize(variablesCount);
+			isDamaged |= (mInvalidIndex != index);
 
-		std::string variableId;
+			return TAtom{};
+		};
 
-		for (size_t i = 0; i < variablesCount; ++i)
+		/// \note Types are created first, so scopes, symbols and other types refer to them by pointers
+		std::vector<TType*> pTypes(header.mTypesCount, nullptr);
+
+		for (uint32_t i = 0; i < header.mTypesCount; ++i)
 		{
-			archive >> variableId;
+			const TTypeRecord& record = pTypeRecords[i];
 
-			mVariables[i].mName = variableId;
-			mVariables[i].mpType = std::move(TType::Deserialize(archive, symTable));
+			if (!isInRange(record.mFirstAtomIndex, record.mAtomsCount, header.mAtomsCount) ||
+				!isInRange(record.mFirstBaseClassIndex, record.mBaseClassesCount, header.mBaseClassesCount))
+			{
+				return false;
+			}
+
+			TType* pType = nullptr;
+
+			switch (static_cast<TType::E_SUBTYPE>(record.mSubtype))
+			{
+				case TType::E_SUBTYPE::BASE:
+					pType = CreateType<TType>();
+					break;
+				case TType::E_SUBTYPE::NAMESPACE:
+					pType = CreateType<TNamespaceType>();
+					break;
+				case TType::E_SUBTYPE::ENUM:
+					{
+						TEnumType* pEnumType = CreateType<TEnumType>();
+
+						pEnumType->mIsStronglyTyped      = (0 != (record.mFlags & TF_STRONGLY_TYPED));
+						pEnumType->mIsIntrospectable     = (0 != (record.mFlags & TF_INTROSPECTABLE));
+						pEnumType->mIsForwardDeclaration = (0 != (record.mFlags & TF_FORWARD_DECLARATION));
+						pEnumType->mUnderlyingTypeStr    = getString(record.mUnderlyingTypeIndex).GetString();
+
+						pEnumType->mEnumerators.reserve(record.mAtomsCount);
+
+						for (uint32_t j = 0; j < record.mAtomsCount; ++j)
+						{
+							pEnumType->mEnumerators.push_back(getString(pAtoms[record.mFirstAtomIndex + j].mStringIndex));
+						}
+
+						pType = pEnumType;
+					}
+					break;
+				case TType::E_SUBTYPE::CLASS:
+					{
+						TClassType* pClassType = CreateType<TClassType>();
+
+						pClassType->mIsFinal              = (0 != (record.mFlags & TF_FINAL));
+						pClassType->mIsStruct             = (0 != (record.mFlags & TF_STRUCT));
+						pClassType->mIsTemplate           = (0 != (record.mFlags & TF_TEMPLATE));
+						pClassType->mIsForwardDeclaration = (0 != (record.mFlags & TF_FORWARD_DECLARATION));
+
+						pClassType->mFields.reserve(record.mAtomsCount);
+
+						for (uint32_t j = 0; j < record.mAtomsCount; ++j)
+						{
+							pClassType->mFields.push_back(getString(pAtoms[record.mFirstAtomIndex + j].mStringIndex));
+						}
+
+						pClassType->mBaseClasses.reserve(record.mBaseClassesCount);
+
+						for (uint32_t j = 0; j < record.mBaseClassesCount; ++j)
+						{
+							const TBaseClassRecord& baseClassRecord = pBaseClasses[record.mFirstBaseClassIndex + j];
+
+							pClassType->mBaseClasses.push_back({ getString(baseClassRecord.mFullNameIndex), 0 != baseClassRecord.mIsVirtualInherited,
+																 static_cast<E_ACCESS_SPECIFIER_TYPE>(baseClassRecord.mAccessSpecifier) });
+						}
+
+						pType = pClassType;
+					}
+					break;
+				default:
+					return false;
+			}
+
+			pType->mId                    = getString(record.mIdIndex);
+			pType->mMangledId             = getString(record.mMangledIdIndex);
+			pType->mSectionId             = getString(record.mSectionIdIndex).GetString();
+			pType->mAccessModifier        = static_cast<E_ACCESS_SPECIFIER_TYPE>(record.mAccessModifier);
+			pType->mIsMarkedWithAttribute = (0 != (record.mFlags & TF_MARKED_WITH_ATTRIBUTE));
+
+			pTypes[i] = pType;
 		}
 
-		archive >> mIndex;
+		auto getType = [&pTypes, &isDamaged](uint32_t index)
+		{
+			if (index < pTypes.size())
+			{
+				return pTypes[index];
+			}
 
-		mIndex = (mIndex == (std::numeric_limits<int>::max)()) ? -1 : mIndex;
+			isDamaged |= (mInvalidIndex != index);
 
-		mpType = std::move(TType::Deserialize(archive, symTable));
+			return static_cast<TType*>(nullptr);
+		};
 
-		return true;
-	}
+		for (uint32_t i = 0; i < header.mTypesCount; ++i)
+		{
+			pTypes[i]->mpParentType = getType(pTypeRecords[i].mParentTypeIndex);
+		}
 
-	bool SymTable::Save(FileWriterArchive& archive)
-	{
-		bool result = mpGlobalScope->Save(archive);
+		std::vector<TScopeIndex> slottedScopes;
 
-		archive << mSourceFilename;
+		mScopes.reserve(header.mScopesCount);
 
-		return result;
-	}
+		for (uint32_t i = 0; i < header.mScopesCount; ++i)
+		{
+			const TScopeRecord& record = pScopes[i];
 
-	bool SymTable::Load(FileReaderArchive& archive)
-	{
-		_reset();
+			if ((i > 0 && record.mParentIndex >= i) || !isInRange(record.mFirstSymbolIndex, record.mSymbolsCount, header.mSymbolsCount)) // \note Parents always precede their children
+			{
+				return false;
+			}
 
-		mpGlobalScope = std::make_unique<TScopeEntity>();
-		mpCurrScope = mpGlobalScope.get();
+			const TScopeIndex scopeIndex = (0 == i) ? mGlobalScopeIndex : _addScope(record.mParentIndex, getString(record.mNameIndex));
+			if (mInvalidScopeIndex == scopeIndex)
+			{
+				return false;
+			}
 
-		bool result = mpGlobalScope->Load(archive, this);
+			TScopeEntity& currScope = mScopes[scopeIndex];
+			currScope.mIndex = static_cast<int32_t>(record.mIndex);
 
-		archive >> mSourceFilename;
+			currScope.mVariables.reserve(record.mSymbolsCount);
 
-		return result;
-	}
+			for (uint32_t j = 0; j < record.mSymbolsCount; ++j)
+			{
+				const TSymbolRecord& symbolRecord = pSymbols[record.mFirstSymbolIndex + j];
+				currScope.mVariables.push_back({ getString(symbolRecord.mNameIndex), getType(symbolRecord.mTypeIndex) });
+			}
 
-	void SymTable::Visit(ISymTableVisitor& visitor)
-	{
-		visitor.VisitScope(*mpGlobalScope);
-	}
+			if (mInvalidTypeSlotIndex != record.mTypeSlotIndex)
+			{
+				currScope.mpType = getType(record.mTypeIndex); // \note The type is registered below in order of slots
+				slottedScopes.push_back(scopeIndex);
 
-	void SymTable::AddSymbol(TSymbolDesc&& desc)
-	{
-		assert(mpCurrScope);
+				continue;
+			}
 
-		auto& symbols = mpCurrScope->mVariables;
+			SetScopeType(currScope, getType(record.mTypeIndex));
+		}
 
-		auto iter = std::find_if(symbols.begin(), symbols.end(), [&desc](const TSymbolDesc& entity) { return desc.mName == entity.mName; });
-		if (iter != symbols.end()) // \note there is already symbol with the same name than update it
+		/// \note Enums and classes have separate slots, the stable sort keeps order within each of these sequences
+		std::stable_sort(slottedScopes.begin(), slottedScopes.end(), [pScopes](TScopeIndex left, TScopeIndex right)
 		{
-			iter->mpType = std::move(desc.mpType);
-			return;
+			return pScopes[left].mTypeSlotIndex < pScopes[right].mTypeSlotIndex;
+		});
+
+		for (const TScopeIndex currScopeIndex : slottedScopes)
+		{
+			TScopeEntity& currScope = mScopes[currScopeIndex];
+
+			TType* pType = currScope.mpType;
+			currScope.mpType = nullptr;
+
+			SetScopeType(currScope, pType);
 		}
 
-		symbols.emplace_back(std::forward<TSymbolDesc>(desc));
+		mSourceFilename = getString(header.mSourceFilenameIndex).GetString();
+		mIsSkipped = (0 != (header.mFlags & IF_SKIPPED));
+
+		if (isDamaged)
+		{
+			_reset();
+			return false;
+		}
+
+		return true;
+	}
+
+	void SymTable::Visit(ISymTableVisitor& visitor)
+	{
+		for (auto&& currScope : mScopes)
+		{
+			visitor.VisitScope(currScope);
+		}
 	}
 
-	bool SymTable::CreateScope(const std::string& name)
+	void SymTable::AddSymbol(TSymbolDesc&& desc)
 	{
-		assert(mpCurrScope);
+		mScopes[mCurrScopeIndex].AddSymbol(std::forward<TSymbolDesc>(desc));
+	}
 
+	bool SymTable::CreateScope(const TAtom& name)
+	{
 		mIsReadOnlyMode = false;
 
-		return name.empty() ? _createAnonymousScope() : _createNamedScope(name);
+		return name.IsEmpty() ? _createAnonymousScope() : _createNamedScope(name);
 	}
 
-	bool SymTable::EnterScope(const std::string& name)
+	bool SymTable::EnterScope(const TAtom& name)
 	{
-		assert(mpCurrScope);
-
 		mIsReadOnlyMode = true;
 
-		return name.empty() ? _visitAnonymousScope() : _visitNamedScope(name);
+		return name.IsEmpty() ? _visitAnonymousScope() : _visitNamedScope(name);
 	}
 
 	void SymTable::ExitScope()
 	{
-		int32_t currScopeIndex = mpCurrScope->mIndex;
+		const TScopeEntity& currScope = mScopes[mCurrScopeIndex];
+
+		assert(mInvalidScopeIndex != currScope.mParentIndex);
+
+		int32_t currScopeIndex = currScope.mIndex;
 
 		bool isUnnamedScope = currScopeIndex >= 0;
 
-		mpCurrScope = mpCurrScope->mpParentScope;
+		mCurrScopeIndex = currScope.mParentIndex;
 
 		// \note move to next neighbour scope if we currently stay in unnamed one and there is this next neighbour
-		if (mIsReadOnlyMode && isUnnamedScope && (mpCurrScope->mpNestedScopes.size() > currScopeIndex))
+		if (mIsReadOnlyMode && isUnnamedScope && (mScopes[mCurrScopeIndex].mNestedScopes.size() > static_cast<size_t>(currScopeIndex)))
 		{
 			mLastVisitedScopeIndex = currScopeIndex;
 		}
@@ -378,72 +871,41 @@ namespace TDEngine2
 		}
 	}
 
-	const TSymbolDesc& SymTable::LookUpSymbol(const std::string& id) const
+	const TSymbolDesc& SymTable::LookUpSymbol(const TAtom& id) const
 	{
 		return _lookUpInternal(id);
 	}
 
-	SymTable::TScopeEntity* SymTable::LookUpNamedScope(const std::string& name)
+	SymTable::TScopeEntity* SymTable::LookUpNamedScope(const TAtom& name)
 	{
-		auto findScope = [name](TScopeEntity* pScope) -> TScopeEntity*
+		for (TScopeIndex currScopeIndex = mCurrScopeIndex; mInvalidScopeIndex != currScopeIndex; currScopeIndex = mScopes[currScopeIndex].mParentIndex)
 		{
-			auto&& namedScopes = pScope->mpNamedScopes;
-
-			auto&& iter = namedScopes.find(name);
-			if (iter == namedScopes.cend())
+			const TScopeIndex namedScopeIndex = mScopes[currScopeIndex].FindNamedScope(name);
+			if (mInvalidScopeIndex != namedScopeIndex)
 			{
-				return nullptr;
-			}
-
-			return (iter->second).get();
-		};
-		
-		if (TScopeEntity* pResult = findScope(mpCurrScope))
-		{
-			return pResult;
-		}
-		
-		TScopeEntity* pCurrScope = mpCurrScope;
-		while (pCurrScope->mpParentScope)
-		{
-			pCurrScope = pCurrScope->mpParentScope;
-
-			if (TScopeEntity* pResult = findScope(pCurrScope))
-			{
-				return pResult;
+				return &mScopes[namedScopeIndex];
 			}
 		}
 
 		return nullptr;
 	}
 
-	std::string SymTable::GetMangledNameForNamedScope(const std::string& id)
+	SymTable::TScopeEntity* SymTable::GetScope(TScopeIndex index)
+	{
+		return (index < mScopes.size()) ? &mScopes[index] : nullptr;
+	}
+
+	TAtom SymTable::GetMangledNameForNamedScope(const TAtom& id)
 	{
 		TScopeEntity* pNamedScope = LookUpNamedScope(id);
 		if (!pNamedScope)
 		{
-			return "";
+			return {};
 		}
 
-		std::string mangledId = id;
+		const TAtom& prefix = _getMangledPrefix(pNamedScope->mParentIndex);
 
-		TScopeEntity* pCurrScope = pNamedScope;
-		while (pCurrScope->mpParentScope)
-		{
-			pCurrScope = pCurrScope->mpParentScope;
-
-			if (pCurrScope->mIndex != -1 || !pCurrScope->mpType) // \note only named scopes influences onto the result id
-			{
-				continue;
-			}
-
-			if (auto pType = pCurrScope->mpType.get())
-			{
-				mangledId = pType->mId + "@" + mangledId;
-			}
-		}
-
-		return mangledId;
+		return prefix.IsEmpty() ? id : TAtom{ std::string(prefix.GetString()).append("@").append(id.GetString()) };
 	}
 
 	void SymTable::SetSourceFilename(const std::string& filename)
@@ -456,23 +918,168 @@ namespace TDEngine2
 		return mSourceFilename;
 	}
 
-	TType::Ptr SymTable::GetCurrScopeType() const
+	TType* SymTable::GetCurrScopeType() const
 	{
-		return mpCurrScope->mpType;
+		return mScopes[mCurrScopeIndex].mpType;
 	}
 
-	TType::Ptr SymTable::GetParentScopeType() const
+	TType* SymTable::GetParentScopeType() const
 	{
-		auto pParentScope = mpCurrScope->mpParentScope;
+		const TScopeIndex parentIndex = mScopes[mCurrScopeIndex].mParentIndex;
+
+		return (mInvalidScopeIndex != parentIndex) ? mScopes[parentIndex].mpType : nullptr;
+	}
+
+	void SymTable::SetScopeType(TScopeEntity& scope, TType* pType)
+	{
+		const TType* pPrevType = scope.mpType;
+		const uint32_t prevSlotIndex = scope.mTypeSlotIndex;
+
+		scope.mpType = pType;
+		scope.mTypeSlotIndex = mInvalidTypeSlotIndex;
 
-		return pParentScope ? pParentScope->mpType : nullptr;
+		const bool isSameSubtype = pPrevType && pType && (pPrevType->GetSubtype() == pType->GetSubtype());
+
+		if (mInvalidTypeSlotIndex != prevSlotIndex && !isSameSubtype) // \note Release a slot of the previous type
+		{
+			switch (pPrevType->GetSubtype())
+			{
+				case TType::E_SUBTYPE::ENUM:
+					mpEnums[prevSlotIndex] = nullptr;
+					break;
+				case TType::E_SUBTYPE::CLASS:
+					mpClasses[prevSlotIndex] = nullptr;
+					break;
+				default:
+					break;
+			}
+		}
+
+		if (!pType)
+		{
+			return;
+		}
+
+		auto registerType = [&scope, prevSlotIndex, isSameSubtype](auto& types, auto pTypedType)
+		{
+			if (isSameSubtype && mInvalidTypeSlotIndex != prevSlotIndex)
+			{
+				types[prevSlotIndex] = pTypedType;
+				scope.mTypeSlotIndex = prevSlotIndex;
+
+				return;
+			}
+
+			scope.mTypeSlotIndex = static_cast<uint32_t>(types.size());
+			types.push_back(pTypedType);
+		};
+
+		switch (pType->GetSubtype())
+		{
+			case TType::E_SUBTYPE::ENUM:
+				registerType(mpEnums, static_cast<const TEnumType*>(pType));
+				break;
+			case TType::E_SUBTYPE::CLASS:
+				registerType(mpClasses, static_cast<const TClassType*>(pType));
+				break;
+			default:
+				break;
+		}
+	}
+
+	bool SymTable::Merge(const SymTable& table)
+	{
+		std::vector<TScopeIndex> scopesMapping(table.mScopes.size(), mInvalidScopeIndex);
+		std::unordered_map<const TType*, TType*> typesMapping;
+
+		scopesMapping[mGlobalScopeIndex] = mGlobalScopeIndex;
+
+		for (TScopeIndex i = mGlobalScopeIndex + 1; i < table.mScopes.size(); ++i)
+		{
+			const TScopeEntity& currScope = table.mScopes[i];
+			const TScopeIndex parentIndex = scopesMapping[currScope.mParentIndex];
+
+			const TScopeIndex existingScopeIndex = currScope.mName.IsEmpty() ? mInvalidScopeIndex : mScopes[parentIndex].FindNamedScope(currScope.mName);
+			if (mInvalidScopeIndex == existingScopeIndex)
+			{
+				scopesMapping[i] = _addScope(parentIndex, currScope.mName);
+				continue;
+			}
+
+			TType* pExistingType = mScopes[existingScopeIndex].mpType;
+			const TType* pType = currScope.mpType;
+
+			if (!pExistingType || !pType || (pExistingType->GetSubtype() != pType->GetSubtype()))
+			{
+				return false;
+			}
+
+			switch (pType->GetSubtype())
+			{
+				case TType::E_SUBTYPE::NAMESPACE:
+					typesMapping.emplace(pType, pExistingType); // \note A reopened namespace keeps its first type as the parser does
+					break;
+				case TType::E_SUBTYPE::CLASS: // \note The class's type is replaced below, it takes the slot of the previous declaration
+					break;
+				default:
+					return false;
+			}
+
+			scopesMapping[i] = existingScopeIndex;
+		}
+
+		/// \note Enums and classes are registered in order of their slots, so the arrays keep order of the first declarations
+		std::vector<TScopeIndex> enumsScopes(table.mpEnums.size(), mInvalidScopeIndex);
+		std::vector<TScopeIndex> classesScopes(table.mpClasses.size(), mInvalidScopeIndex);
+
+		for (TScopeIndex i = mGlobalScopeIndex; i < table.mScopes.size(); ++i)
+		{
+			const TScopeEntity& currScope = table.mScopes[i];
+
+			for (auto&& currVariable : currScope.mVariables)
+			{
+				mScopes[scopesMapping[i]].AddSymbol({ currVariable.mName, _cloneType(currVariable.mpType, typesMapping) });
+			}
+
+			if (!currScope.mpType)
+			{
+				continue;
+			}
+
+			if (mInvalidTypeSlotIndex != currScope.mTypeSlotIndex)
+			{
+				(TType::E_SUBTYPE::ENUM == currScope.mpType->GetSubtype() ? enumsScopes : classesScopes)[currScope.mTypeSlotIndex] = i;
+				continue;
+			}
+
+			SetScopeType(mScopes[scopesMapping[i]], _cloneType(currScope.mpType, typesMapping));
+		}
+
+		for (auto pScopesIndices : { &enumsScopes, &classesScopes })
+		{
+			for (const TScopeIndex currScopeIndex : *pScopesIndices)
+			{
+				if (mInvalidScopeIndex != currScopeIndex)
+				{
+					SetScopeType(mScopes[scopesMapping[currScopeIndex]], _cloneType(table.mScopes[currScopeIndex].mpType, typesMapping));
+				}
+			}
+		}
+
+		return true;
 	}
 
 	void SymTable::_reset()
 	{
-		mpGlobalScope = nullptr;
-		mpCurrScope = nullptr;
-		mpPrevScope = nullptr;
+		mArena.Reset();
+
+		mpEnums.clear();
+		mpClasses.clear();
+
+		mScopes.clear();
+		mScopes.emplace_back(); // \note The global scope
+
+		mCurrScopeIndex = mGlobalScopeIndex;
 
 		mIsReadOnlyMode = false;
 
@@ -480,111 +1087,128 @@ namespace TDEngine2
 		mPrevVisitedScopeIndex = -1;
 
 		mSourceFilename = "";
+		mIsSkipped = false;
 	}
 
-	bool SymTable::_createAnonymousScope()
+	SymTable::TScopeIndex SymTable::_addScope(TScopeIndex parentIndex, const TAtom& name)
 	{
-		int32_t nextScopeIndex = static_cast<int32_t>(mpCurrScope->mpNestedScopes.size());
+		const TScopeIndex scopeIndex = static_cast<TScopeIndex>(mScopes.size());
+
+		TScopeEntity& parentScope = mScopes[parentIndex];
+
+		if (name.IsEmpty())
+		{
+			parentScope.mNestedScopes.push_back(scopeIndex);
+		}
+		else if (!parentScope.AddNamedScope(name, scopeIndex))
+		{
+			return mInvalidScopeIndex;
+		}
 
-		mpCurrScope->mpNestedScopes.emplace_back(std::make_unique<TScopeEntity>());
+		TScopeEntity& newScope = mScopes.emplace_back();
 
-		TScopeEntity* pNewScope = mpCurrScope->mpNestedScopes.back().get();
-		
-		pNewScope->mpParentScope = mpCurrScope;
-		pNewScope->mIndex        = nextScopeIndex;
+		newScope.mParentIndex = parentIndex;
+		newScope.mName        = name;
+		newScope.mIndex       = name.IsEmpty() ? static_cast<int32_t>(mScopes[parentIndex].mNestedScopes.size() - 1) : -1;
 
-		mpCurrScope = pNewScope;
+		return scopeIndex;
+	}
+
+	bool SymTable::_createAnonymousScope()
+	{
+		mCurrScopeIndex = _addScope(mCurrScopeIndex, {});
 
 		return true;
 	}
 
-	bool SymTable::_createNamedScope(const std::string& name)
+	bool SymTable::_createNamedScope(const TAtom& name)
 	{
-		if (mpCurrScope->mpNamedScopes.find(name) != mpCurrScope->mpNamedScopes.cend())
+		const TScopeIndex scopeIndex = _addScope(mCurrScopeIndex, name);
+		if (mInvalidScopeIndex == scopeIndex)
 		{
 			return false;
 		}
 
-		mpCurrScope->mpNamedScopes.emplace(name, std::make_unique<TScopeEntity>());
-
-		TScopeEntity* pNewScope = mpCurrScope->mpNamedScopes[name].get();
-
-		pNewScope->mpParentScope = mpCurrScope;
-		pNewScope->mIndex        = -1;
-
-		mpCurrScope = pNewScope;
+		mCurrScopeIndex = scopeIndex;
 
 		return true;
 	}
 
 	bool SymTable::_visitAnonymousScope()
 	{
-		mpPrevScope = mpCurrScope;
-		mpCurrScope = mpCurrScope->mpNestedScopes[mLastVisitedScopeIndex + 1].get();
+		mCurrScopeIndex = mScopes[mCurrScopeIndex].mNestedScopes[mLastVisitedScopeIndex + 1];
 
 		mLastVisitedScopeIndex = -1;
 
 		return true;
 	}
 
-	bool SymTable::_visitNamedScope(const std::string& name)
+	bool SymTable::_visitNamedScope(const TAtom& name)
 	{
-		mpPrevScope = mpCurrScope;
-		
-		if (mpCurrScope->mIndex >= 0)
+		if (mScopes[mCurrScopeIndex].mIndex >= 0)
 		{
 			mPrevVisitedScopeIndex = mLastVisitedScopeIndex;
 		}
 
-		auto&& namedScopes = mpCurrScope->mpNamedScopes;
-
-		auto&& iter = namedScopes.find(name);
-		if (iter == namedScopes.cend())
+		const TScopeIndex scopeIndex = mScopes[mCurrScopeIndex].FindNamedScope(name);
+		if (mInvalidScopeIndex == scopeIndex)
 		{
 			return false;
 		}
 
-		mpCurrScope = (iter->second).get();
+		mCurrScopeIndex = scopeIndex;
 
 		mLastVisitedScopeIndex = -1;
 
 		return true;
 	}
 
-	const TSymbolDesc& SymTable::_lookUpInternal(const std::string& id) const
+	const TSymbolDesc& SymTable::_lookUpInternal(const TAtom& id) const
 	{
-		auto lookUp = [id](TScopeEntity* pScope) -> const TSymbolDesc*
+		for (TScopeIndex currScopeIndex = mCurrScopeIndex; mInvalidScopeIndex != currScopeIndex; currScopeIndex = mScopes[currScopeIndex].mParentIndex)
 		{
-			auto&& symbols = pScope->mVariables;
-
-			auto&& iter = std::find_if(symbols.begin(), symbols.end(), [id](const TSymbolDesc& entity) { return id == entity.mName; });
+			const TScopeEntity& currScope = mScopes[currScopeIndex];
 
-			if (iter != symbols.cend())
+			const uint32_t symbolIndex = currScope.FindSymbol(id);
+			if (mInvalidSymbolIndex != symbolIndex)
 			{
-				return &(*iter);
+				return currScope.mVariables[symbolIndex];
 			}
+		}
 
-			return nullptr;
-		};
-		
-		if (auto pResult = lookUp(mpCurrScope))
+		return TSymbolDesc::mInvalid;
+	}
+
+	const TAtom& SymTable::_getMangledPrefix(TScopeIndex index)
+	{
+		TScopeEntity& scope = mScopes[index];
+
+		if (scope.mIsMangledPrefixCached)
 		{
-			return *pResult;
+			return scope.mMangledPrefix;
 		}
 
-		TScopeEntity* pCurrScope = mpCurrScope;
+		const bool hasParent = (mInvalidScopeIndex != scope.mParentIndex);
 
-		while (pCurrScope->mpParentScope)
-		{
-			pCurrScope = pCurrScope->mpParentScope;
+		// \note only named scopes with types influence onto the result id
+		const TAtom parentPrefix = hasParent ? _getMangledPrefix(scope.mParentIndex) : TAtom{};
 
-			if (auto pResult = lookUp(pCurrScope))
-			{
-				return *pResult;
-			}
+		const bool isNamedScope = (-1 == scope.mIndex) && !scope.mName.IsEmpty();
+
+		if (!isNamedScope || !scope.mpType)
+		{
+			scope.mMangledPrefix = parentPrefix;
+		}
+		else
+		{
+			const TAtom& id = scope.mpType->mId;
+			scope.mMangledPrefix = parentPrefix.IsEmpty() ? id : TAtom{ std::string(parentPrefix.GetString()).append("@").append(id.GetString()) };
 		}
 
-		return TSymbolDesc::mInvalid;
+		/// \note A type of a named scope is assigned after the scope's creation, so the prefix isn't cached until the whole chain has types
+		scope.mIsMangledPrefixCached = (!isNamedScope || scope.mpType) && (!hasParent || mScopes[scope.mParentIndex].mIsMangledPrefixCached);
+
+		return scope.mMangledPrefix;
 	}
 
 
@@ -597,6 +1221,17 @@ namespace TDEngine2
 	{
 	}
 
+	void EnumsMetaExtractor::Extract(const SymTable& symTable)
+	{
+		for (const TEnumType* pEnumType : symTable.GetEnums())
+		{
+			if (pEnumType)
+			{
+				VisitEnumType(*pEnumType);
+			}
+		}
+	}
+
 	void EnumsMetaExtractor::VisitEnumType(const TEnumType& type)
 	{
 		if ((mEmitFlags & E_EMIT_FLAGS::ENUMS) != E_EMIT_FLAGS::ENUMS || 
@@ -605,7 +1240,7 @@ namespace TDEngine2
 			return;
 		}
 
-		if (auto pParentType = std::dynamic_pointer_cast<TClassType>(type.mpParentType.lock()))
+		if (auto pParentType = TypeCast<TClassType>(type.mpParentType))
 		{
 			if (pParentType->mIsTemplate)
 			{
@@ -642,6 +1277,17 @@ namespace TDEngine2
 	{
 	}
 
+	void ClassMetaExtractor::Extract(const SymTable& symTable)
+	{
+		for (const TClassType* pClassType : symTable.GetClasses())
+		{
+			if (pClassType)
+			{
+				VisitClassType(*pClassType);
+			}
+		}
+	}
+
 	void ClassMetaExtractor::VisitClassType(const TClassType& type)
 	{
 		if ((!type.mIsStruct && ((mEmitFlags & E_EMIT_FLAGS::CLASSES) != E_EMIT_FLAGS::CLASSES)) || 
@@ -652,9 +1298,9 @@ namespace TDEngine2
 			return;
 		}
 
-		if (TType::Ptr typePtr = type.mpParentType.lock()) /// or a type that is part of another hidden type
+		if (const TType* pParentType = type.mpParentType) /// or a type that is part of another hidden type
 		{
-			if (E_ACCESS_SPECIFIER_TYPE::PUBLIC != typePtr->mAccessModifier)
+			if (E_ACCESS_SPECIFIER_TYPE::PUBLIC != pParentType->mAccessModifier)
 			{
 				return;
 			}
@@ -673,4 +1319,42 @@ namespace TDEngine2
 
 		mpTypesInfo.push_back(&type);
 	}
-}
\ No newline at end of file
+
+	TType* SymTable::_cloneType(const TType* pType, std::unordered_map<const TType*, TType*>& typesMapping)
+	{
+		if (!pType)
+		{
+			return nullptr;
+		}
+
+		auto it = typesMapping.find(pType);
+		if (it != typesMapping.cend())
+		{
+			return it->second;
+		}
+
+		TType* pClonedType = nullptr;
+
+		switch (pType->GetSubtype())
+		{
+			case TType::E_SUBTYPE::NAMESPACE:
+				pClonedType = CopyType<TNamespaceType>(*this, *pType);
+				break;
+			case TType::E_SUBTYPE::ENUM:
+				pClonedType = CopyType<TEnumType>(*this, *pType);
+				break;
+			case TType::E_SUBTYPE::CLASS:
+				pClonedType = CopyType<TClassType>(*this, *pType);
+				break;
+			default:
+				pClonedType = CopyType<TType>(*this, *pType);
+				break;
+		}
+
+		typesMapping.emplace(pType, pClonedType);
+
+		pClonedType->mpParentType = _cloneType(pType->mpParentType, typesMapping); // \note Parents that were replaced within the source table are cloned too
+
+		return pClonedType;
+	}
+}
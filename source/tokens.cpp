@@ -1,14 +1,88 @@
 #include "../include/tokens.h"
+#include "../include/scankernels.h"
+#include <algorithm>
 
 
 namespace TDEngine2
 {
-	TToken::TToken(E_TOKEN_TYPE type, const std::string& value, const TCursorPos& pos):
-		mType(type), mPos(pos), mValue(value), mIsValid(true)
+	TToken::TToken(E_TOKEN_TYPE type, std::string_view value, uint32_t offset):
+		mType(type), mIsValid(true), mOffset(offset), mValue(value)
 	{
 	}
 
 
+	void TTokensArray::Reserve(size_t tokensCount)
+	{
+		mTypes.reserve(tokensCount);
+		mOffsets.reserve(tokensCount);
+		mLengths.reserve(tokensCount);
+		mAtomIds.reserve(tokensCount);
+	}
+
+	void TTokensArray::Add(const TToken& token)
+	{
+		mTypes.push_back(token.mType);
+		mOffsets.push_back(token.mOffset);
+		mLengths.push_back(static_cast<uint32_t>(token.mValue.size()));
+		mAtomIds.push_back(token.mAtomId);
+	}
+
+	TToken TTokensArray::GetToken(size_t index) const
+	{
+		if (mTypes.empty())
+		{
+			return TToken(E_TOKEN_TYPE::TT_EOF);
+		}
+
+		index = (std::min)(index, mTypes.size() - 1);
+
+		const uint32_t offset = mOffsets[index];
+
+		TToken token(mTypes[index], mSourceText.substr((std::min)(static_cast<size_t>(offset), mSourceText.size()), mLengths[index]), offset);
+		token.mAtomId = mAtomIds[index];
+
+		return token;
+	}
+
+
+	LinesIndex::LinesIndex(std::string_view text):
+		mText(text)
+	{
+	}
+
+	TToken::TCursorPos LinesIndex::GetCursorPos(const TToken& token)
+	{
+		if (TToken::mInvalidOffset == token.mOffset)
+		{
+			return { 0, 0 };
+		}
+
+		if (mLinesStarts.empty())
+		{
+			_build();
+		}
+
+		const size_t pos = (std::min)(static_cast<size_t>(token.mOffset) + token.mValue.size(), mText.size());
+
+		/// \note The line's start is the last one that is not greater than pos, the first line always starts at 0
+		auto it = std::upper_bound(mLinesStarts.cbegin(), mLinesStarts.cend(), static_cast<uint32_t>(pos)) - 1;
+
+		return { static_cast<uint32_t>(pos - *it), static_cast<uint32_t>(std::distance(mLinesStarts.cbegin(), it) + 1) };
+	}
+
+	void LinesIndex::_build()
+	{
+		const TScanKernels& scanKernels = GetScanKernels();
+
+		mLinesStarts.push_back(0);
+
+		for (size_t pos = scanKernels.mpFindNewLine(mText, 0); pos < mText.size(); pos = scanKernels.mpFindNewLine(mText, pos + 1))
+		{
+			mLinesStarts.push_back(static_cast<uint32_t>(pos + 1));
+		}
+	}
+
+
 	std::string TokenTypeToString(const E_TOKEN_TYPE& type)
 	{
 		switch (type)
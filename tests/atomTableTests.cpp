@@ -0,0 +1,114 @@
+#include <atomtable.h>
+#include <lexer.h>
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+#include <vector>
+#include <thread>
+#include <unordered_map>
+#include "mockInputStream.h"
+
+
+using namespace TDEngine2;
+
+
+TEST_CASE("Atom table tests")
+{
+	SECTION("TestIntern_PassSameStrings_ReturnsSameIds")
+	{
+		AtomTable table;
+
+		const uint32_t fooId = table.Intern("Foo");
+
+		REQUIRE(table.Intern(std::string("Foo")) == fooId);
+		REQUIRE(table.Intern("Bar") != fooId);
+		REQUIRE(table.Intern("") == AtomTable::mEmptyAtomId);
+
+		REQUIRE(table.GetString(fooId) == "Foo");
+		REQUIRE(table.GetHash(fooId) == std::hash<std::string>{}("Foo"));
+	}
+
+	SECTION("TestIntern_PassManyStringsFromSeveralThreads_AllThreadsGetSameIds")
+	{
+		AtomTable table;
+
+		const size_t stringsCount = 2 * AtomTable::mEntriesPerBlock * AtomTable::mShardsCount;
+		const size_t threadsCount = 4;
+
+		std::vector<std::vector<uint32_t>> ids(threadsCount);
+		std::vector<std::thread> threads;
+
+		for (size_t i = 0; i < threadsCount; ++i)
+		{
+			threads.emplace_back([&table, &ids, i, stringsCount]
+			{
+				for (size_t j = 0; j < stringsCount; ++j)
+				{
+					ids[i].push_back(table.Intern("Identifier" + std::to_string((j + i * 997) % stringsCount)));
+				}
+			});
+		}
+
+		for (auto&& currThread : threads)
+		{
+			currThread.join();
+		}
+
+		for (size_t i = 0; i < threadsCount; ++i)
+		{
+			for (size_t j = 0; j < stringsCount; ++j)
+			{
+				const size_t stringIndex = (j + i * 997) % stringsCount;
+
+				REQUIRE(ids[i][j] == ids[0][stringIndex]);
+				REQUIRE(table.GetString(ids[i][j]) == "Identifier" + std::to_string(stringIndex));
+			}
+		}
+	}
+
+	SECTION("TestAtom_UseAsKeyOfUnorderedMap_IteratesInSameOrderAsStringKeys")
+	{
+		std::unordered_map<TAtom, int> atomsMap;
+		std::unordered_map<std::string, int> stringsMap;
+
+		for (int i = 0; i < 100; ++i)
+		{
+			const std::string key = "Type" + std::to_string(i * 31 % 100);
+
+			atomsMap.emplace(key, i);
+			stringsMap.emplace(key, i);
+		}
+
+		auto stringsIt = stringsMap.cbegin();
+
+		for (auto&& currEntry : atomsMap)
+		{
+			REQUIRE(currEntry.first == stringsIt->first);
+			REQUIRE(currEntry.second == stringsIt->second);
+
+			++stringsIt;
+		}
+
+		REQUIRE(TAtom{}.IsEmpty());
+		REQUIRE(TAtom{ "" }.IsEmpty());
+		REQUIRE(TAtom{ "Type1" } == TAtom{ std::string("Type1") });
+	}
+
+	SECTION("TestLexer_PassIdentifiersAndKeywords_OnlyIdentifiersAreInterned")
+	{
+		MockInputStream stream({ "class Foo { int Foo; };" });
+
+		Lexer lexer(stream);
+
+		REQUIRE(lexer.GetCurrToken().mAtomId == TToken::mInvalidAtomId);
+
+		const TToken& identifierToken = lexer.GetNextToken();
+		REQUIRE(identifierToken.mType == E_TOKEN_TYPE::TT_IDENTIFIER);
+		REQUIRE(TAtom::FromId(identifierToken.mAtomId) == "Foo");
+
+		const uint32_t classNameAtomId = identifierToken.mAtomId;
+
+		REQUIRE(lexer.GetNextToken().mAtomId == TToken::mInvalidAtomId); // {
+		REQUIRE(lexer.GetNextToken().mAtomId == TToken::mInvalidAtomId); // int
+		REQUIRE(lexer.GetNextToken().mAtomId == classNameAtomId);
+	}
+}
@@ -4,31 +4,28 @@
 
 using namespace TDEngine2;
 
-using Scope = SymTable::TScopeEntity;
-using ScopePtr = std::unique_ptr<SymTable::TScopeEntity>;
-
 
 TEST_CASE("EnumExtractor's tests")
 {
 	SECTION("TestVisitScope_PassRootNode_ExtractsAllEnumsInRootNode")
 	{
-		ScopePtr pEnumScope = std::make_unique<Scope>();
-		pEnumScope->mpType = std::make_unique<TEnumType>();
-		if (TEnumType* pEnumType = dynamic_cast<TEnumType*>(pEnumScope->mpType.get()))
-		{
-			pEnumType->mId = "TestEnum";
-			pEnumType->mIsStronglyTyped = true;
+		SymTable symTable;
+
+		symTable.CreateScope("TestEnum");
+
+		TEnumType* pEnumType = symTable.CreateType<TEnumType>();
+		pEnumType->mId = "TestEnum";
+		pEnumType->mIsStronglyTyped = true;
 
-			pEnumType->mEnumerators.push_back("FIRST");
-			pEnumType->mEnumerators.push_back("SECOND");
-			pEnumType->mEnumerators.push_back("THIRD");
-		}
+		pEnumType->mEnumerators.push_back("FIRST");
+		pEnumType->mEnumerators.push_back("SECOND");
+		pEnumType->mEnumerators.push_back("THIRD");
 
-		ScopePtr pRootScope = std::make_unique<Scope>();
-		pRootScope->mpNamedScopes["TestEnum"] = std::move(pEnumScope);
+		symTable.SetScopeType(*symTable.LookUpNamedScope("TestEnum"), pEnumType);
+		symTable.ExitScope();
 
 		EnumsMetaExtractor extractor(E_EMIT_FLAGS::ALL);
-		extractor.VisitScope(*pRootScope.get());
+		extractor.Extract(symTable);
 
 		auto&& enums = extractor.GetTypesInfo();
 		REQUIRE((enums.size() == 1 && enums[0]->mId == "TestEnum" && enums[0]->mEnumerators.size() == 3));
@@ -36,26 +33,57 @@ TEST_CASE("EnumExtractor's tests")
 
 	SECTION("TestVisitScope_PassEnumThatHasNonpublicAccessModifier_ExtractorHasNoOutput")
 	{
-		ScopePtr pEnumScope = std::make_unique<Scope>();
-		pEnumScope->mpType = std::make_unique<TEnumType>();
-		if (TEnumType* pEnumType = dynamic_cast<TEnumType*>(pEnumScope->mpType.get()))
-		{
-			pEnumType->mId = "TestEnum";
-			pEnumType->mIsStronglyTyped = true;
-			pEnumType->mAccessModifier = E_ACCESS_SPECIFIER_TYPE::PROTECTED;
-
-			pEnumType->mEnumerators.push_back("FIRST");
-			pEnumType->mEnumerators.push_back("SECOND");
-			pEnumType->mEnumerators.push_back("THIRD");
-		}
-
-		ScopePtr pRootScope = std::make_unique<Scope>();
-		pRootScope->mpNamedScopes["TestEnum"] = std::move(pEnumScope);
+		SymTable symTable;
+
+		symTable.CreateScope("TestEnum");
+
+		TEnumType* pEnumType = symTable.CreateType<TEnumType>();
+		pEnumType->mId = "TestEnum";
+		pEnumType->mIsStronglyTyped = true;
+		pEnumType->mAccessModifier = E_ACCESS_SPECIFIER_TYPE::PROTECTED;
+
+		pEnumType->mEnumerators.push_back("FIRST");
+		pEnumType->mEnumerators.push_back("SECOND");
+		pEnumType->mEnumerators.push_back("THIRD");
+
+		symTable.SetScopeType(*symTable.LookUpNamedScope("TestEnum"), pEnumType);
+		symTable.ExitScope();
 
 		EnumsMetaExtractor extractor(E_EMIT_FLAGS::ALL);
-		extractor.VisitScope(*pRootScope.get());
+		extractor.Extract(symTable);
 
 		auto&& enums = extractor.GetTypesInfo();
 		REQUIRE(enums.empty());
 	}
+
+	SECTION("TestExtract_PassEnumDefinedAfterForwardDeclaration_ExtractsOnlyDefinition")
+	{
+		SymTable symTable;
+
+		TEnumType* pDeclarationType = symTable.CreateType<TEnumType>();
+		pDeclarationType->mId = "TestEnum";
+		pDeclarationType->mIsForwardDeclaration = true;
+
+		TEnumType* pDefinitionType = symTable.CreateType<TEnumType>();
+		pDefinitionType->mId = "TestEnum";
+		pDefinitionType->mEnumerators.push_back("FIRST");
+
+		symTable.CreateScope("TestEnum");
+		symTable.SetScopeType(*symTable.LookUpNamedScope("TestEnum"), pDeclarationType);
+		symTable.SetScopeType(*symTable.LookUpNamedScope("TestEnum"), pDefinitionType);
+		symTable.ExitScope();
+
+		symTable.CreateScope("TestClass");
+		symTable.SetScopeType(*symTable.LookUpNamedScope("TestClass"), symTable.CreateType<TClassType>());
+		symTable.ExitScope();
+
+		REQUIRE((symTable.GetEnums().size() == 1 && symTable.GetEnums()[0] == pDefinitionType));
+		REQUIRE(symTable.GetClasses().size() == 1);
+
+		EnumsMetaExtractor extractor(E_EMIT_FLAGS::ALL);
+		extractor.Extract(symTable);
+
+		auto&& enums = extractor.GetTypesInfo();
+		REQUIRE((enums.size() == 1 && enums[0] == pDefinitionType));
+	}
 }
@@ -0,0 +1,88 @@
+#include <fingerprint.h>
+#include <cacheformat.h>
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+#include <fstream>
+#include <unordered_set>
+#include <cstdio>
+
+
+using namespace TDEngine2;
+
+
+namespace
+{
+	const std::string TestFingerprintFilename = "fingerprint_test";
+
+
+	void WriteTestFile(const std::string& content)
+	{
+		std::ofstream outfile(TestFingerprintFilename, std::ios::binary | std::ios::trunc);
+		outfile << content;
+	}
+}
+
+
+TEST_CASE("Fingerprint tests")
+{
+	SECTION("TestComputeContentHash_PassReferenceStrings_ReturnsMurmurHash3Values")
+	{
+		if (!CacheFormat::IsLittleEndianHost())
+		{
+			return;
+		}
+
+		REQUIRE(ComputeContentHash("") == THash128 { 0x0, 0x0 });
+		REQUIRE(ComputeContentHash("hello") == THash128 { 0xcbd8a7b341bd9b02ull, 0x5b1e906a48ae1d19ull });
+		REQUIRE(ComputeContentHash("0123456789abcdefXYZ") == THash128 { 0x99d375026c4a901dull, 0x4e69e256eaf89cf3ull });
+		REQUIRE(ComputeContentHash("The quick brown fox jumps over the lazy dog") == THash128 { 0xe34bbc7bbc071b6cull, 0x7a433ca9c49a9347ull });
+		REQUIRE(ComputeContentHash("The quick brown fox jumps over the lazy dog").ToString() == "7a433ca9c49a9347e34bbc7bbc071b6c");
+	}
+
+	SECTION("TestComputeContentHash_PassPrefixesOfString_ReturnsDistinctHashes")
+	{
+		const std::string text = "enum class E_TYPE : uint8_t { FIRST, SECOND };\nstruct TType { int mValue; };";
+
+		std::unordered_set<std::string> hashes;
+
+		for (size_t i = 0; i <= text.size(); ++i)
+		{
+			REQUIRE(hashes.insert(ComputeContentHash(std::string_view(text).substr(0, i)).ToString()).second);
+		}
+	}
+
+	SECTION("TestMatches_PassSameStat_ReturnsTrueWithoutHashing")
+	{
+		WriteTestFile("struct A {};");
+
+		FileFingerprint fingerprint(TestFingerprintFilename);
+
+		REQUIRE(fingerprint.GetStat().mSize == 12);
+		REQUIRE(fingerprint.Matches(fingerprint.GetStat(), "not a hash"));
+	}
+
+	SECTION("TestMatches_PassOtherStatAndSameContent_ReturnsTrue")
+	{
+		const std::string content = "struct A {};";
+
+		WriteTestFile(content);
+
+		FileFingerprint fingerprint(TestFingerprintFilename);
+
+		TFileStat prevStat = fingerprint.GetStat();
+		prevStat.mLastWriteTime -= 1;
+
+		REQUIRE(fingerprint.Matches(prevStat, ComputeContentHash(content).ToString()));
+		REQUIRE(!fingerprint.Matches(prevStat, ComputeContentHash("struct B {};").ToString()));
+	}
+
+	SECTION("TestGetContentHash_PassMissingFile_ReturnsEmptyString")
+	{
+		std::remove(TestFingerprintFilename.c_str());
+
+		FileFingerprint fingerprint(TestFingerprintFilename);
+
+		REQUIRE(fingerprint.GetContentHash().empty());
+		REQUIRE(!fingerprint.Matches(TFileStat {}, ""));
+	}
+}
@@ -0,0 +1,214 @@
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <lexer.h>
+#include "mockInputStream.h"
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+
+using namespace TDEngine2;
+
+
+namespace
+{
+	/*!
+		\brief The function generates a header with a single line that contains a huge enumeration's definition
+	*/
+
+	std::string GenerateSingleLineHeader(size_t size)
+	{
+		std::string text = "enum class E_GENERATED_VALUES : uint32_t { ";
+
+		for (uint32_t i = 0; text.size() < size; ++i)
+		{
+			text.append("VALUE_").append(std::to_string(i)).append(" = ").append(std::to_string(i)).append(", ");
+		}
+
+		return text.append("};");
+	}
+
+
+	/*!
+		\brief The function generates a header where most of bytes belong to doc comments and macros
+	*/
+
+	std::string GenerateCommentedHeader(size_t size)
+	{
+		std::string text;
+
+		for (uint32_t i = 0; text.size() < size; ++i)
+		{
+			text.append("/*!\n\t\\brief The documentation of a generated value, it occupies a few lines\n\t\tlike real doc blocks do\n*/\n\n");
+			text.append("#define GENERATED_MACRO_").append(std::to_string(i)).append("(x) \\\n\tdo { x; } while (0)\n");
+			text.append("int value").append(std::to_string(i)).append("; // trailing comment\n");
+		}
+
+		return text;
+	}
+
+
+	class BufferInputStream : public IInputStream
+	{
+		public:
+			explicit BufferInputStream(const std::string& text) : mText(text) {}
+
+			bool Open() TDE2_NOEXCEPT override { return true; }
+			bool Close() TDE2_NOEXCEPT override { return true; }
+
+			std::string ReadLine() TDE2_NOEXCEPT override { return ""; }
+
+			std::optional<std::string_view> GetBuffer() const TDE2_NOEXCEPT override { return std::string_view(mText); }
+		private:
+			const std::string& mText;
+	};
+
+
+	size_t CountTokens(const std::string& text)
+	{
+		BufferInputStream stream(text);
+		Lexer lexer(stream);
+
+		size_t tokensCount = 0;
+
+		while (lexer.GetNextToken().mType != E_TOKEN_TYPE::TT_EOF)
+		{
+			++tokensCount;
+		}
+
+		return tokensCount;
+	}
+
+
+	/*!
+		\brief The function reproduces the previous implementation of the lexer's cursor that erased
+		each consumed character from the front of the processed text. It's kept here as a reference
+	*/
+
+	size_t CountIdentifiersWithErasingCursor(const std::string& text)
+	{
+		std::string processedText = text;
+
+		size_t identifiersCount = 0;
+		bool isIdentifier = false;
+
+		while (!processedText.empty())
+		{
+			const char ch = processedText.front();
+			const bool isIdentifierChar = std::isalnum(static_cast<unsigned char>(ch)) || ch == '_';
+
+			identifiersCount += (isIdentifierChar && !isIdentifier) ? 1 : 0;
+			isIdentifier = isIdentifierChar;
+
+			processedText.erase(0, 1);
+		}
+
+		return identifiersCount;
+	}
+
+
+	/*!
+		\brief The map replicates the previous implementation of keywords lookup
+	*/
+
+	std::unordered_map<std::string, E_TOKEN_TYPE> BuildReservedTokensMap()
+	{
+		std::unordered_map<std::string, E_TOKEN_TYPE> reservedTokens;
+
+		for (auto&& currEntry : ReservedKeywords)
+		{
+			reservedTokens.emplace(currEntry.mValue, currEntry.mType);
+		}
+
+		for (auto&& currEntry : ReservedSymbols)
+		{
+			reservedTokens.emplace(currEntry.mValue, currEntry.mType);
+		}
+
+		return reservedTokens;
+	}
+
+
+	std::vector<std::string> GenerateLexemes(size_t count)
+	{
+		static const std::vector<std::string> identifiers { "TValue", "mpLexer", "E_TOKEN_TYPE", "x", "uint32_t", "GetCurrToken" };
+		static const std::string symbols = "{}():;=,<>";
+
+		std::vector<std::string> lexemes;
+
+		for (size_t i = 0; lexemes.size() < count; ++i)
+		{
+			lexemes.emplace_back(ReservedKeywords[i % std::size(ReservedKeywords)].mValue);
+			lexemes.emplace_back(identifiers[i % identifiers.size()]);
+			lexemes.emplace_back(1, symbols[i % symbols.size()]);
+		}
+
+		return lexemes;
+	}
+}
+
+
+TEST_CASE("Lexer benchmarks", "[.][benchmark]")
+{
+	const std::string hugeHeader = GenerateSingleLineHeader(1024 * 1024);
+	const std::string smallHeader = GenerateSingleLineHeader(64 * 1024);
+
+	const std::string commentedHeader = GenerateCommentedHeader(1024 * 1024);
+
+	REQUIRE(CountTokens(smallHeader) > 0);
+
+	BENCHMARK("Lexer, 1 MB single line header")
+	{
+		return CountTokens(hugeHeader);
+	};
+
+	BENCHMARK("Lexer::Tokenize, 1 MB single line header")
+	{
+		BufferInputStream stream(hugeHeader);
+		return Lexer(stream).Tokenize().GetSize();
+	};
+
+	BENCHMARK("Lexer, 1 MB header with comments and macros")
+	{
+		return CountTokens(commentedHeader);
+	};
+
+	BENCHMARK("Lexer, 64 KB single line header")
+	{
+		return CountTokens(smallHeader);
+	};
+
+	BENCHMARK("Erase-from-front cursor (previous implementation), 64 KB single line header")
+	{
+		return CountIdentifiersWithErasingCursor(smallHeader);
+	};
+
+	const std::vector<std::string> lexemes = GenerateLexemes(16 * 1024);
+	const auto reservedTokens = BuildReservedTokensMap();
+
+	BENCHMARK("Keywords lookup, perfect hash and symbols table")
+	{
+		size_t reservedCount = 0;
+
+		for (auto&& currLexeme : lexemes)
+		{
+			const E_TOKEN_TYPE type = (currLexeme.size() > 1) ? GetKeywordTokenType(currLexeme) : GetSymbolTokenType(currLexeme[0]);
+			reservedCount += (E_TOKEN_TYPE::TT_IDENTIFIER != type && E_TOKEN_TYPE::TT_UNKNOWN != type) ? 1 : 0;
+		}
+
+		return reservedCount;
+	};
+
+	BENCHMARK("Keywords lookup, std::unordered_map (previous implementation)")
+	{
+		size_t reservedCount = 0;
+
+		for (auto&& currLexeme : lexemes)
+		{
+			const std::string_view lexeme = currLexeme;
+			reservedCount += (reservedTokens.find(std::string{ lexeme }) != reservedTokens.cend()) ? 1 : 0;
+		}
+
+		return reservedCount;
+	};
+}
@@ -3,6 +3,7 @@
 #include <lexer.h>
 #include "mockInputStream.h"
 #include <catch2/catch_test_macros.hpp>
+#include <fstream>
 
 
 using namespace TDEngine2;
@@ -93,6 +94,25 @@ TEST_CASE("Lexer tests")
 		}
 	}
 
+	SECTION("TestGetKeywordTokenType_PassAllReservedWords_ReturnsTheirTypesAndIdentifierForOthers")
+	{
+		for (auto&& currEntry : ReservedKeywords)
+		{
+			REQUIRE(GetKeywordTokenType(currEntry.mValue) == currEntry.mType);
+			REQUIRE(GetKeywordTokenType(std::string{ currEntry.mValue }.append("_")) == E_TOKEN_TYPE::TT_IDENTIFIER);
+		}
+
+		REQUIRE(GetKeywordTokenType("Enum") == E_TOKEN_TYPE::TT_IDENTIFIER);
+		REQUIRE(GetKeywordTokenType("x") == E_TOKEN_TYPE::TT_IDENTIFIER);
+
+		for (auto&& currEntry : ReservedSymbols)
+		{
+			REQUIRE(GetSymbolTokenType(currEntry.mValue[0]) == currEntry.mType);
+		}
+
+		REQUIRE(GetSymbolTokenType('#') == E_TOKEN_TYPE::TT_UNKNOWN);
+	}
+
 	SECTION("TestGetNextToken_PassOperators_ReturnsSequenceOfTokens")
 	{
 		std::unique_ptr<IInputStream> stream{ new MockInputStream {
@@ -267,10 +287,10 @@ TEST_CASE("Lexer tests")
 
 		Lexer lexer(*stream);
 
-		REQUIRE(lexer.GetNextToken().mPos == std::tuple<uint32_t, uint32_t>(1, 1));
-		REQUIRE(lexer.GetNextToken().mPos == std::tuple<uint32_t, uint32_t>(1, 2));
-		REQUIRE(lexer.GetNextToken().mPos == std::tuple<uint32_t, uint32_t>(1, 3));
-		REQUIRE(lexer.GetNextToken().mPos == std::tuple<uint32_t, uint32_t>(1, 4));
+		REQUIRE(lexer.GetCursorPos(lexer.GetNextToken()) == std::tuple<uint32_t, uint32_t>(1, 1));
+		REQUIRE(lexer.GetCursorPos(lexer.GetNextToken()) == std::tuple<uint32_t, uint32_t>(1, 2));
+		REQUIRE(lexer.GetCursorPos(lexer.GetNextToken()) == std::tuple<uint32_t, uint32_t>(1, 3));
+		REQUIRE(lexer.GetCursorPos(lexer.GetNextToken()) == std::tuple<uint32_t, uint32_t>(1, 4));
 		REQUIRE(lexer.GetNextToken().mType == E_TOKEN_TYPE::TT_EOF);
 	}
 
@@ -283,10 +303,83 @@ TEST_CASE("Lexer tests")
 
 		Lexer lexer(*stream);
 
-		REQUIRE(lexer.GetNextToken().mPos == std::tuple<uint32_t, uint32_t>(1, 1));
-		REQUIRE(lexer.GetNextToken().mPos == std::tuple<uint32_t, uint32_t>(3, 1));
-		REQUIRE(lexer.GetNextToken().mPos == std::tuple<uint32_t, uint32_t>(5, 1));
-		REQUIRE(lexer.GetNextToken().mPos == std::tuple<uint32_t, uint32_t>(7, 1));
+		REQUIRE(lexer.GetCursorPos(lexer.GetNextToken()) == std::tuple<uint32_t, uint32_t>(1, 1));
+		REQUIRE(lexer.GetCursorPos(lexer.GetNextToken()) == std::tuple<uint32_t, uint32_t>(3, 1));
+		REQUIRE(lexer.GetCursorPos(lexer.GetNextToken()) == std::tuple<uint32_t, uint32_t>(5, 1));
+		REQUIRE(lexer.GetCursorPos(lexer.GetNextToken()) == std::tuple<uint32_t, uint32_t>(7, 1));
+		REQUIRE(lexer.GetNextToken().mType == E_TOKEN_TYPE::TT_EOF);
+	}
+
+	SECTION("TestGetNextToken_PassCommentsAndMacrosSpanningFewLines_ReturnsExactLineIndexesNumbersInTokens")
+	{
+		std::unique_ptr<IInputStream> stream{ new MockInputStream {
+			{
+				"/* first line",
+				"   second line /* nested */ */ a // comment",
+				"#define FOO(x) \\",
+				"   x",
+				"  b /**/ c",
+			} } };
+
+		Lexer lexer(*stream);
+
+		REQUIRE(lexer.GetCursorPos(lexer.GetNextToken()) == std::tuple<uint32_t, uint32_t>(32, 2));
+		REQUIRE(lexer.GetCursorPos(lexer.GetNextToken()) == std::tuple<uint32_t, uint32_t>(3, 5));
+		REQUIRE(lexer.GetCursorPos(lexer.GetNextToken()) == std::tuple<uint32_t, uint32_t>(10, 5));
+		REQUIRE(lexer.GetNextToken().mType == E_TOKEN_TYPE::TT_EOF);
+	}
+
+	SECTION("TestGetCursorPos_PassEOFAndTokensWithoutOffsets_ReturnsPositionAfterTextOrZeroes")
+	{
+		std::unique_ptr<IInputStream> stream{ new MockInputStream {
+			{
+				"a",
+				"b;",
+			} } };
+
+		Lexer lexer(*stream);
+
+		REQUIRE(lexer.GetCursorPos(lexer.GetCurrToken()) == std::tuple<uint32_t, uint32_t>(1, 1));
+		REQUIRE(lexer.GetCursorPos(lexer.GetNextToken()) == std::tuple<uint32_t, uint32_t>(1, 2));
+		REQUIRE(lexer.GetCursorPos(lexer.GetNextToken()) == std::tuple<uint32_t, uint32_t>(2, 2));
+
+		const TToken& eofToken = lexer.GetNextToken();
+		REQUIRE(eofToken.mType == E_TOKEN_TYPE::TT_EOF);
+		REQUIRE(lexer.GetCursorPos(eofToken) == std::tuple<uint32_t, uint32_t>(0, 3));
+
+		REQUIRE(lexer.GetCursorPos(TToken(E_TOKEN_TYPE::TT_SEMICOLON)) == std::tuple<uint32_t, uint32_t>(0, 0));
+		REQUIRE(LinesIndex().GetCursorPos(TToken(E_TOKEN_TYPE::TT_EOF)) == std::tuple<uint32_t, uint32_t>(0, 0));
+	}
+
+	SECTION("TestGetNextToken_PassIdentifiersAndSymbols_TokensReferToLexemesWithinSourceBuffer")
+	{
+		std::unique_ptr<IInputStream> stream{ new MockInputStream {
+			{
+				"enum Foo {",
+				"  bar };",
+			} } };
+
+		Lexer lexer(*stream);
+
+		const std::tuple<E_TOKEN_TYPE, std::string, uint32_t> expectedTokens[]
+		{
+			{ E_TOKEN_TYPE::TT_ENUM, "enum", 0 },
+			{ E_TOKEN_TYPE::TT_IDENTIFIER, "Foo", 5 },
+			{ E_TOKEN_TYPE::TT_OPEN_BRACE, "{", 9 },
+			{ E_TOKEN_TYPE::TT_IDENTIFIER, "bar", 13 },
+			{ E_TOKEN_TYPE::TT_CLOSE_BRACE, "}", 17 },
+			{ E_TOKEN_TYPE::TT_SEMICOLON, ";", 18 },
+		};
+
+		for (auto&& currExpectedToken : expectedTokens)
+		{
+			const TToken& currToken = lexer.GetNextToken();
+
+			REQUIRE(currToken.mType == std::get<E_TOKEN_TYPE>(currExpectedToken));
+			REQUIRE(currToken.mValue == std::get<std::string>(currExpectedToken));
+			REQUIRE(currToken.mOffset == std::get<uint32_t>(currExpectedToken));
+		}
+
 		REQUIRE(lexer.GetNextToken().mType == E_TOKEN_TYPE::TT_EOF);
 	}
 
@@ -412,6 +505,47 @@ TEST_CASE("Lexer tests")
 		REQUIRE(lexer.GetNextToken().mType == E_TOKEN_TYPE::TT_EOF);
 	}
 
+	SECTION("TestSkipBalancedBlock_PassBlockWithNestedBracesAndLiterals_ReturnsTokenAfterBlock")
+	{
+		std::unique_ptr<IInputStream> stream{ new MockInputStream {
+			{
+				"{",
+				"  void Foo() { auto s = \"}\"; }",
+				"  // }",
+				"}",
+				"next;",
+			} } };
+
+		Lexer lexer(*stream);
+
+		REQUIRE(lexer.GetCurrToken().mType == E_TOKEN_TYPE::TT_OPEN_BRACE);
+		REQUIRE(lexer.PeekToken(2).mType == E_TOKEN_TYPE::TT_IDENTIFIER); // \note Peeked tokens within the block are dropped
+		REQUIRE(lexer.SkipBalancedBlock());
+
+		const TToken& currToken = lexer.GetCurrToken();
+		REQUIRE((currToken.mType == E_TOKEN_TYPE::TT_IDENTIFIER && currToken.mValue == "next"));
+		REQUIRE(std::get<1>(lexer.GetCursorPos(currToken)) == 5);
+
+		REQUIRE(lexer.GetNextToken().mType == E_TOKEN_TYPE::TT_SEMICOLON);
+		REQUIRE(!lexer.SkipBalancedBlock());
+	}
+
+	SECTION("TestSkipBalancedBlock_PeekTokensBeyondBlock_KeepsThem")
+	{
+		std::unique_ptr<IInputStream> stream{ new MockInputStream {
+			{
+				"{} a b",
+			} } };
+
+		Lexer lexer(*stream);
+
+		REQUIRE(lexer.PeekToken(3).mValue == "b");
+		REQUIRE(lexer.SkipBalancedBlock());
+		REQUIRE(lexer.GetCurrToken().mValue == "a");
+		REQUIRE(lexer.GetNextToken().mValue == "b");
+		REQUIRE(lexer.GetNextToken().mType == E_TOKEN_TYPE::TT_EOF);
+	}
+
 	SECTION("TestPeekToken_InvokePeekForEachToken_EachInvokationReturnsCorrectTokenButDoesntChangePointer")
 	{
 		std::unique_ptr<IInputStream> stream{ new MockInputStream {
@@ -464,6 +598,39 @@ TEST_CASE("Lexer tests")
 		}
 	}
 
+	SECTION("TestPeekToken_PeekFewTokensAheadAndConsumeThem_PeekedReferencesStayValidUntilTokensAreConsumed")
+	{
+		std::unique_ptr<IInputStream> stream{ new MockInputStream {
+			{
+				"a = b, c; d e f g h i j k"
+			} } };
+
+		Lexer lexer(*stream);
+
+		REQUIRE(lexer.PeekToken(0).mValue == "a");
+
+		const TToken& thirdToken = lexer.PeekToken(2);
+		const TToken& fourthToken = lexer.PeekToken(3);
+
+		REQUIRE(lexer.PeekToken(1).mType == E_TOKEN_TYPE::TT_ASSIGN_OP);
+		REQUIRE(thirdToken.mValue == "b");
+		REQUIRE(fourthToken.mType == E_TOKEN_TYPE::TT_COMMA);
+
+		REQUIRE(lexer.GetNextToken().mType == E_TOKEN_TYPE::TT_ASSIGN_OP);
+		REQUIRE(lexer.PeekToken(Lexer::mMaxLookaheadTokensCount).mValue == "g");
+		REQUIRE(thirdToken.mValue == "b");
+		REQUIRE(fourthToken.mType == E_TOKEN_TYPE::TT_COMMA);
+
+		for (const std::string expectedValue : { "b", ",", "c", ";", "d", "e", "f", "g", "h", "i", "j", "k" })
+		{
+			REQUIRE(lexer.GetNextToken().mValue == expectedValue);
+			REQUIRE(lexer.PeekToken(0).mValue == expectedValue);
+		}
+
+		REQUIRE(lexer.PeekToken().mType == E_TOKEN_TYPE::TT_EOF);
+		REQUIRE(lexer.GetNextToken().mType == E_TOKEN_TYPE::TT_EOF);
+	}
+
 	SECTION("TestGetCurrToken_InvokePeekTokenBeforeGetCurrToken_GetCurrTokenShouldReturnSameResultNoMatterOfPeekTokenCalls")
 	{
 		std::unique_ptr<IInputStream> stream{ new MockInputStream {
@@ -484,4 +651,79 @@ TEST_CASE("Lexer tests")
 		REQUIRE(lexer.GetCurrToken().mType == expectedTokens[0]);
 		REQUIRE(lexer.GetNextToken().mType == expectedTokens[1]);
 	}
+
+	SECTION("TestTokenize_PassMultilineStream_ReturnsSameTokensAsStreamingLexer")
+	{
+		const std::vector<std::string> lines
+		{
+			"namespace Test {",
+			"  /* comment */ enum class E_VALUES : uint32_t { A = 0, B, C };",
+			"}",
+		};
+
+		std::unique_ptr<IInputStream> stream{ new MockInputStream { lines } };
+		std::unique_ptr<IInputStream> tokenizedStream{ new MockInputStream { lines } };
+
+		Lexer lexer(*stream);
+		
+		const TTokensArray tokens = Lexer(*tokenizedStream).Tokenize();
+		REQUIRE(tokens.GetSize() == 20);
+
+		LinesIndex linesIndex(tokens.mSourceText);
+
+		for (size_t i = 0; i < tokens.GetSize(); ++i)
+		{
+			const TToken& expectedToken = (i ? lexer.GetNextToken() : lexer.GetCurrToken());
+			const TToken actualToken = tokens.GetToken(i);
+
+			REQUIRE(actualToken.mType == expectedToken.mType);
+			REQUIRE(actualToken.mValue == expectedToken.mValue);
+			REQUIRE(actualToken.mOffset == expectedToken.mOffset);
+			REQUIRE(linesIndex.GetCursorPos(actualToken) == lexer.GetCursorPos(expectedToken));
+		}
+
+		REQUIRE(tokens.GetToken(tokens.GetSize()).mType == E_TOKEN_TYPE::TT_EOF);
+	}
+
+	SECTION("TestMappedFileInputStream_PassSmallAndLargeFiles_LexerReadsTokensDirectlyFromBuffer")
+	{
+		const std::string filename = "mapped_stream_test.h";
+
+		for (const size_t paddingSize : { static_cast<size_t>(0), static_cast<size_t>(64 * 1024) })
+		{
+			const std::string content = std::string(paddingSize, ' ').append("enum class TEST {\n\tFIRST\n};");
+
+			{
+				std::ofstream outfile(filename, std::ios::binary);
+				outfile << content;
+			}
+
+			MappedFileInputStream stream(filename);
+			REQUIRE(stream.Open());
+
+			auto&& buffer = stream.GetBuffer();
+			REQUIRE((buffer && *buffer == content));
+
+			Lexer lexer(stream);
+
+			std::vector<E_TOKEN_TYPE> expectedTokens
+			{
+				E_TOKEN_TYPE::TT_ENUM,
+				E_TOKEN_TYPE::TT_CLASS,
+				E_TOKEN_TYPE::TT_IDENTIFIER,
+				E_TOKEN_TYPE::TT_OPEN_BRACE,
+				E_TOKEN_TYPE::TT_IDENTIFIER,
+				E_TOKEN_TYPE::TT_CLOSE_BRACE,
+				E_TOKEN_TYPE::TT_SEMICOLON,
+			};
+
+			for (E_TOKEN_TYPE currExpectedType : expectedTokens)
+			{
+				REQUIRE(lexer.GetNextToken().mType == currExpectedType);
+			}
+
+			REQUIRE(lexer.GetNextToken().mType == E_TOKEN_TYPE::TT_EOF);
+			REQUIRE(stream.Close());
+		}
+	}
 }
\ No newline at end of file
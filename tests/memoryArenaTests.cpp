@@ -0,0 +1,99 @@
+#include <memoryarena.h>
+#include <catch2/catch_test_macros.hpp>
+#include <vector>
+#include <string>
+
+
+using namespace TDEngine2;
+
+
+namespace
+{
+	struct TDestructionLogger
+	{
+		TDestructionLogger(std::vector<int>& log, int id) :
+			mLog(log), mId(id)
+		{
+		}
+
+		~TDestructionLogger()
+		{
+			mLog.push_back(mId);
+		}
+
+		std::vector<int>& mLog;
+		int               mId;
+	};
+}
+
+
+TEST_CASE("Memory arena tests")
+{
+	SECTION("TestAllocate_PassDifferentAlignments_ReturnsAlignedAndNonOverlappedBlocks")
+	{
+		MemoryArena arena;
+
+		uintptr_t prevEndPos = 0;
+
+		for (size_t alignment : { 1, 2, 8, 16, 64, 1, 4 })
+		{
+			const uintptr_t pos = reinterpret_cast<uintptr_t>(arena.Allocate(3, alignment));
+
+			REQUIRE(pos % alignment == 0);
+			REQUIRE((!prevEndPos || pos >= prevEndPos));
+
+			prevEndPos = pos + 3;
+		}
+
+		REQUIRE(arena.GetUsedBytes() == 7 * 3);
+	}
+
+	SECTION("TestAllocate_PassBlockLargerThanChunk_AllocatesDedicatedChunk")
+	{
+		MemoryArena arena;
+
+		char* pSmallBlock = static_cast<char*>(arena.Allocate(16));
+		char* pLargeBlock = static_cast<char*>(arena.Allocate(MemoryArena::mDefaultChunkSize * 2));
+
+		REQUIRE(pSmallBlock);
+		REQUIRE(pLargeBlock);
+
+		pLargeBlock[0] = pLargeBlock[MemoryArena::mDefaultChunkSize * 2 - 1] = 'a';
+	}
+
+	SECTION("TestReset_CreateObjects_DestroysThemInReverseOrder")
+	{
+		std::vector<int> log;
+
+		{
+			MemoryArena arena;
+
+			arena.Create<TDestructionLogger>(log, 1);
+			arena.Create<int>(42);
+			arena.Create<TDestructionLogger>(log, 2);
+			arena.Create<std::string>(100, 'x');
+
+			arena.Reset();
+
+			REQUIRE(log == std::vector<int>{ 2, 1 });
+			REQUIRE(arena.GetUsedBytes() == 0);
+
+			arena.Create<TDestructionLogger>(log, 3);
+		}
+
+		REQUIRE(log == std::vector<int>{ 2, 1, 3 });
+	}
+
+	SECTION("TestReset_CreateArenasOneByOne_ReusesChunksOfTheSameThread")
+	{
+		void* pFirstBlock = nullptr;
+
+		{
+			MemoryArena arena;
+			pFirstBlock = arena.Allocate(8);
+		}
+
+		MemoryArena arena;
+		REQUIRE(arena.Allocate(8) == pFirstBlock);
+	}
+}
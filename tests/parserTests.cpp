@@ -1,7 +1,10 @@
 #include <vector>
 #include <string>
+#include <algorithm>
 #include <parser.h>
 #include <symtable.h>
+#include <prefilter.h>
+#include <parsingbudget.h>
 #include "mockInputStream.h"
 #include <catch2/catch_test_macros.hpp>
 
@@ -119,7 +122,7 @@ TEST_CASE("Parser tests")
 		auto pTestEnumScope = symTable.LookUpNamedScope("TEST");
 		REQUIRE(pTestEnumScope);
 
-		TEnumType* pTypeDesc = dynamic_cast<TEnumType*>(pTestEnumScope->mpType.get());
+		TEnumType* pTypeDesc = TypeCast<TEnumType>(pTestEnumScope->mpType);
 		REQUIRE((pTypeDesc && pTypeDesc->mIsMarkedWithAttribute));
 
 	}
@@ -143,7 +146,7 @@ TEST_CASE("Parser tests")
 		auto pTestEnumScope = symTable.LookUpNamedScope("TEST");
 		REQUIRE(pTestEnumScope);
 
-		TEnumType* pTypeDesc = dynamic_cast<TEnumType*>(pTestEnumScope->mpType.get());
+		TEnumType* pTypeDesc = TypeCast<TEnumType>(pTestEnumScope->mpType);
 		REQUIRE(pTypeDesc);
 
 		auto&& enumerators = pTypeDesc->mEnumerators;
@@ -254,7 +257,7 @@ TEST_CASE("Parser tests")
 			auto pNestedEnumScope = symTable.LookUpNamedScope("NestedEnum");
 			REQUIRE(pNestedEnumScope);
 
-			TEnumType* pTypeDesc = dynamic_cast<TEnumType*>(pNestedEnumScope->mpType.get());
+			TEnumType* pTypeDesc = TypeCast<TEnumType>(pNestedEnumScope->mpType);
 			REQUIRE((pTypeDesc && E_ACCESS_SPECIFIER_TYPE::PUBLIC == pTypeDesc->mAccessModifier));
 
 			auto&& enumerators = pTypeDesc->mEnumerators;
@@ -267,7 +270,7 @@ TEST_CASE("Parser tests")
 			auto pPrivateNestedEnum = symTable.LookUpNamedScope("Test"); 
 			REQUIRE(pPrivateNestedEnum);
 
-			pTypeDesc = dynamic_cast<TEnumType*>(pPrivateNestedEnum->mpType.get());
+			pTypeDesc = TypeCast<TEnumType>(pPrivateNestedEnum->mpType);
 			REQUIRE((pTypeDesc && E_ACCESS_SPECIFIER_TYPE::PRIVATE == pTypeDesc->mAccessModifier));
 		}
 		symTable.ExitScope();
@@ -298,7 +301,7 @@ TEST_CASE("Parser tests")
 				auto pNestedEnumScope = symTable.LookUpNamedScope("NestedEnum");
 				REQUIRE(pNestedEnumScope);
 
-				TEnumType* pTypeDesc = dynamic_cast<TEnumType*>(pNestedEnumScope->mpType.get());
+				TEnumType* pTypeDesc = TypeCast<TEnumType>(pNestedEnumScope->mpType);
 				REQUIRE((pTypeDesc && E_ACCESS_SPECIFIER_TYPE::PUBLIC == pTypeDesc->mAccessModifier));
 
 				auto&& enumerators = pTypeDesc->mEnumerators;
@@ -308,9 +311,10 @@ TEST_CASE("Parser tests")
 					enumerators[1] == "Second" &&
 					enumerators[2] == "Third"));
 
-				REQUIRE(pNestedEnumScope->mpParentScope);
+				auto pParentScope = symTable.GetScope(pNestedEnumScope->mParentIndex);
+				REQUIRE(pParentScope);
 
-				TClassType* pParentType = dynamic_cast<TClassType*>(pNestedEnumScope->mpParentScope->mpType.get());
+				TClassType* pParentType = TypeCast<TClassType>(pParentScope->mpType);
 				REQUIRE((pParentType && pParentType->mId == "B"));
 			}
 			symTable.ExitScope();
@@ -343,7 +347,7 @@ TEST_CASE("Parser tests")
 			auto pNestedEnumScope = symTable.LookUpNamedScope("B");
 			REQUIRE(pNestedEnumScope);
 
-			auto pType = dynamic_cast<TClassType*>(pNestedEnumScope->mpType.get());
+			auto pType = TypeCast<TClassType>(pNestedEnumScope->mpType);
 			REQUIRE((pType && pType->mIsTemplate));
 		}
 		symTable.ExitScope();
@@ -352,7 +356,7 @@ TEST_CASE("Parser tests")
 		auto pNestedEnumScope = symTable.LookUpNamedScope("C");
 		REQUIRE(pNestedEnumScope);
 
-		auto pType = dynamic_cast<TClassType*>(pNestedEnumScope->mpType.get());
+		auto pType = TypeCast<TClassType>(pNestedEnumScope->mpType);
 		REQUIRE((pType && pType->mIsTemplate));
 	}
 
@@ -378,7 +382,7 @@ TEST_CASE("Parser tests")
 
 		REQUIRE(symTable.EnterScope("Position"));
 		{
-			TClassType::Ptr pType = std::dynamic_pointer_cast<TClassType>(symTable.GetCurrScopeType());
+			TClassType* pType = TypeCast<TClassType>(symTable.GetCurrScopeType());
 			REQUIRE(pType);
 
 			REQUIRE(pType->mFields.size() == 3);
@@ -391,7 +395,7 @@ TEST_CASE("Parser tests")
 
 		REQUIRE(symTable.EnterScope("Identifier"));
 		{
-			TClassType::Ptr pType = std::dynamic_pointer_cast<TClassType>(symTable.GetCurrScopeType());
+			TClassType* pType = TypeCast<TClassType>(symTable.GetCurrScopeType());
 			REQUIRE(pType);
 
 			REQUIRE(pType->mFields.size() == 1);
@@ -401,6 +405,46 @@ TEST_CASE("Parser tests")
 		symTable.ExitScope();
 	}
 
+	SECTION("TestParse_PassTokensArray_ParsesStructsAndEnumsSameWayAsStreamingParser")
+	{
+		std::unique_ptr<IInputStream> stream{ new MockInputStream {
+			{
+				"struct Position {",
+				"    float x, y, z;",
+				"};",
+				"ENUM_META(SECTION = animation)",
+				"enum class E_WRAP_MODE : U8 { PLAY_ONCE, LOOP };",
+			} } };
+
+		const TTokensArray tokens = Lexer(*stream).Tokenize();
+		SymTable symTable;
+
+		Parser(tokens, symTable, mockOptions, [](auto&&)
+			{
+				REQUIRE(false);
+			}).Parse();
+
+		REQUIRE(symTable.EnterScope("Position"));
+		{
+			TClassType* pType = TypeCast<TClassType>(symTable.GetCurrScopeType());
+			REQUIRE(pType);
+
+			REQUIRE(pType->mFields == std::vector<TAtom>{ "x", "y", "z" });
+		}
+		symTable.ExitScope();
+
+		REQUIRE(symTable.EnterScope("E_WRAP_MODE"));
+		{
+			auto pType = TypeCast<TEnumType>(symTable.GetCurrScopeType());
+			REQUIRE(pType);
+
+			REQUIRE(pType->mIsMarkedWithAttribute);
+			REQUIRE(pType->mSectionId == "animation");
+			REQUIRE(pType->mEnumerators.size() == 2);
+		}
+		symTable.ExitScope();
+	}
+
 	SECTION("TestParse_PassStructThatContainsFieldWithInitializer_TheyShouldCorrectlyParsed")
 	{
 		std::unique_ptr<IInputStream> stream{ new MockInputStream {
@@ -420,7 +464,7 @@ TEST_CASE("Parser tests")
 
 		REQUIRE(symTable.EnterScope("Tag"));
 		{
-			TClassType::Ptr pType = std::dynamic_pointer_cast<TClassType>(symTable.GetCurrScopeType());
+			TClassType* pType = TypeCast<TClassType>(symTable.GetCurrScopeType());
 			REQUIRE(pType);
 
 			REQUIRE(pType->mFields.size() == 1);
@@ -459,11 +503,391 @@ TEST_CASE("Parser tests")
 		{
 			REQUIRE(symTable.EnterScope("E_ANIMATION_WRAP_MODE_TYPE"));
 			
-			TEnumType::Ptr pType = std::dynamic_pointer_cast<TEnumType>(symTable.GetCurrScopeType());
+			TEnumType* pType = TypeCast<TEnumType>(symTable.GetCurrScopeType());
 			REQUIRE(pType);
 
 			symTable.ExitScope();
 		}
 		symTable.ExitScope();
 	}
+
+	SECTION("TestParse_PassUntaggedClassBodiesInTaggedOnlyMode_SkipsThemWithBothTokenSources")
+	{
+		const std::vector<std::string> lines
+		{
+			"class Untagged {",
+			"    void Foo() { const char* s = \"}\"; }",
+			"    // }",
+			"    BEGIN_IGNORE_META_SECTION } END_IGNORE_META_SECTION",
+			"};",
+			"CLASS_META()",
+			"class Tagged { int mValue; };",
+		};
+
+		TIntrospectorOptions options;
+		options.mIsTaggedOnlyModeEnabled = true;
+
+		for (const bool isTokenized : { false, true })
+		{
+			std::unique_ptr<IInputStream> stream{ new MockInputStream { lines } };
+
+			Lexer lexer(*stream);
+			SymTable symTable;
+
+			auto onError = [](auto&&)
+			{
+				REQUIRE(false);
+			};
+
+			if (isTokenized)
+			{
+				const TTokensArray tokens = lexer.Tokenize();
+				Parser(tokens, symTable, options, onError).Parse();
+			}
+			else
+			{
+				Parser(lexer, symTable, options, onError).Parse();
+			}
+
+			REQUIRE(symTable.EnterScope("Tagged"));
+			{
+				TClassType* pType = TypeCast<TClassType>(symTable.GetCurrScopeType());
+				REQUIRE((pType && pType->mIsMarkedWithAttribute && pType->mFields.size() == 1));
+			}
+			symTable.ExitScope();
+		}
+	}
+
+	SECTION("TestParse_PassTypesThatAreNeverEmitted_SkipsTheirMembersButKeepsNestedTypes")
+	{
+		const std::vector<std::string> lines
+		{
+			"class TClass {",
+			"  public:",
+			"    int mA;",
+			"    enum class E_NESTED { FIRST, SECOND };",
+			"    struct TNested { int mB; };",
+			"};",
+			"struct TSkippedData { int mC; };",
+			"struct TData { int mD, mE; };",
+			"enum class E_SKIPPED_VALUES { FIRST = 1, SECOND };",
+		};
+
+		TIntrospectorOptions options;
+		options.mpTypesFilter = std::make_shared<const TypesFilter>(E_EMIT_FLAGS::ENUMS | E_EMIT_FLAGS::STRUCTS, std::vector<std::string> { "TSkipped.*", "E_SKIPPED_.*" });
+
+		for (const bool isTokenized : { false, true })
+		{
+			std::unique_ptr<IInputStream> stream{ new MockInputStream { lines } };
+
+			Lexer lexer(*stream);
+			SymTable symTable;
+
+			auto onError = [](auto&&)
+			{
+				REQUIRE(false);
+			};
+
+			if (isTokenized)
+			{
+				const TTokensArray tokens = lexer.Tokenize();
+				Parser(tokens, symTable, options, onError).Parse();
+			}
+			else
+			{
+				Parser(lexer, symTable, options, onError).Parse();
+			}
+
+			auto getFieldsCount = [&symTable](const std::vector<std::string>& path)
+			{
+				for (auto&& currScopeName : path)
+				{
+					REQUIRE(symTable.EnterScope(currScopeName));
+				}
+
+				const TClassType* pType = TypeCast<TClassType>(symTable.GetCurrScopeType());
+				REQUIRE(pType);
+
+				for (size_t i = 0; i < path.size(); ++i)
+				{
+					symTable.ExitScope();
+				}
+
+				return pType->mFields.size();
+			};
+
+			auto getEnumeratorsCount = [&symTable](const std::vector<std::string>& path)
+			{
+				for (auto&& currScopeName : path)
+				{
+					REQUIRE(symTable.EnterScope(currScopeName));
+				}
+
+				const TEnumType* pType = TypeCast<TEnumType>(symTable.GetCurrScopeType());
+				REQUIRE(pType);
+
+				for (size_t i = 0; i < path.size(); ++i)
+				{
+					symTable.ExitScope();
+				}
+
+				return pType->mEnumerators.size();
+			};
+
+			REQUIRE(getFieldsCount({ "TClass" }) == 0);
+			REQUIRE(getEnumeratorsCount({ "TClass", "E_NESTED" }) == 2);
+			REQUIRE(getFieldsCount({ "TClass", "TNested" }) == 1);
+			REQUIRE(getFieldsCount({ "TSkippedData" }) == 0);
+			REQUIRE(getFieldsCount({ "TData" }) == 2);
+			REQUIRE(getEnumeratorsCount({ "E_SKIPPED_VALUES" }) == 0);
+		}
+	}
+
+	SECTION("TestParse_PassDeeplyNestedBlocks_SkipsThemWithoutRecursion")
+	{
+		const size_t depth = 100000;
+
+		const std::string nestedBlock = std::string(depth, '{') + std::string(depth, '}');
+		const std::string nestedArguments = std::string(depth, '(') + std::string(depth, ')');
+
+		std::unique_ptr<IInputStream> stream{ new MockInputStream {
+			{
+				nestedBlock,
+				"struct TData {",
+				"    void Foo" + nestedArguments + " { " + nestedBlock + " };",
+				"    int mValue;",
+				"};",
+			} } };
+
+		Lexer lexer(*stream);
+		SymTable symTable;
+
+		Parser(lexer, symTable, mockOptions, [](auto&&)
+		{
+			REQUIRE(false);
+		}).Parse();
+
+		REQUIRE(symTable.EnterScope("TData"));
+		{
+			TClassType* pType = TypeCast<TClassType>(symTable.GetCurrScopeType());
+			REQUIRE((pType && pType->mFields.size() == 1 && pType->mFields[0] == "mValue"));
+		}
+		symTable.ExitScope();
+	}
+
+	SECTION("TestParse_PassMismatchedBracketsInMethodArguments_ReportsExpectedClosingToken")
+	{
+		std::unique_ptr<IInputStream> stream{ new MockInputStream {
+			{
+				"struct TData {",
+				"    void Foo(int a<) { }",
+				"};",
+			} } };
+
+		Lexer lexer(*stream);
+		SymTable symTable;
+
+		bool hasErrors = false;
+
+		Parser(lexer, symTable, mockOptions, [&hasErrors](auto&&)
+		{
+			hasErrors = true;
+		}).Parse();
+
+		REQUIRE(hasErrors);
+	}
+
+	SECTION("TestParseChunk_PassChunksOfDeclarations_MergedTableEqualsSequentiallyParsedOne")
+	{
+		std::unique_ptr<IInputStream> stream{ new MockInputStream {
+			{
+				"class TForward;",
+				"ENUM_META(SECTION = first)",
+				"enum class E_FIRST { A, B };",
+				"class TForward { int mValue; };",
+				"namespace Outer {",
+				"struct TData { int mValue; struct TNested { int mInner; }; };",
+				"ENUM_META(SECTION = second)",
+				"enum class E_SECOND { C };",
+				"enum E_UNTAGGED { D };",
+				"namespace Inner {",
+				"class TDerived : public TData { int mField; };",
+				"}",
+				"}",
+			} } };
+
+		const TTokensArray tokens = Lexer(*stream).Tokenize();
+
+		SymTable expectedSymTable;
+		uint32_t expectedErrorsCount = 0;
+
+		Parser(tokens, expectedSymTable, mockOptions, [&expectedErrorsCount](auto&&) { ++expectedErrorsCount; }).Parse();
+
+		const std::vector<TDeclarationsChunk> chunks = SplitIntoDeclarationsChunks(tokens, 1);
+		REQUIRE(chunks.size() > 4);
+
+		SymTable symTable;
+		uint32_t errorsCount = 0;
+
+		for (size_t i = 0; i < chunks.size(); ++i)
+		{
+			SymTable chunkSymTable;
+
+			REQUIRE(Parser(tokens, chunkSymTable, mockOptions, [&errorsCount](auto&&) { ++errorsCount; }).ParseChunk(chunks[i], i + 1 == chunks.size()));
+			REQUIRE(symTable.Merge(chunkSymTable));
+		}
+
+		REQUIRE(errorsCount == expectedErrorsCount);
+
+		auto getParentId = [](const TType* pType)
+		{
+			return pType->mpParentType ? pType->mpParentType->mId : TAtom{};
+		};
+
+		REQUIRE(symTable.GetEnums().size() == expectedSymTable.GetEnums().size());
+
+		for (size_t i = 0; i < symTable.GetEnums().size(); ++i)
+		{
+			const TEnumType* pType = symTable.GetEnums()[i];
+			const TEnumType* pExpectedType = expectedSymTable.GetEnums()[i];
+
+			REQUIRE(pType->mMangledId == pExpectedType->mMangledId);
+			REQUIRE(pType->mSectionId == pExpectedType->mSectionId);
+			REQUIRE(pType->mIsMarkedWithAttribute == pExpectedType->mIsMarkedWithAttribute);
+			REQUIRE(pType->mEnumerators == pExpectedType->mEnumerators);
+			REQUIRE(getParentId(pType) == getParentId(pExpectedType));
+			REQUIRE(pType->mpOwner == &symTable);
+		}
+
+		REQUIRE(symTable.GetClasses().size() == expectedSymTable.GetClasses().size());
+
+		for (size_t i = 0; i < symTable.GetClasses().size(); ++i)
+		{
+			const TClassType* pType = symTable.GetClasses()[i];
+			const TClassType* pExpectedType = expectedSymTable.GetClasses()[i];
+
+			REQUIRE(pType->mMangledId == pExpectedType->mMangledId);
+			REQUIRE(pType->mIsForwardDeclaration == pExpectedType->mIsForwardDeclaration);
+			REQUIRE(pType->mFields == pExpectedType->mFields);
+			REQUIRE(pType->mBaseClasses.size() == pExpectedType->mBaseClasses.size());
+			REQUIRE(getParentId(pType) == getParentId(pExpectedType));
+			REQUIRE(pType->mpOwner == &symTable);
+		}
+
+		REQUIRE(symTable.GetEnums()[2]->mSectionId == "second"); // \note The section lasts up to the end of the namespace's body
+		REQUIRE(symTable.GetClasses()[0]->mFields == std::vector<TAtom>{ "mValue" });
+	}
+
+	SECTION("TestParseChunk_PassEnumRedeclaredWithinAnotherChunk_MergeFails")
+	{
+		std::unique_ptr<IInputStream> stream{ new MockInputStream {
+			{
+				"enum E_VALUES { A };",
+				"enum E_VALUES { B };",
+			} } };
+
+		const TTokensArray tokens = Lexer(*stream).Tokenize();
+
+		const std::vector<TDeclarationsChunk> chunks = SplitIntoDeclarationsChunks(tokens, 1);
+		REQUIRE(chunks.size() == 2);
+
+		SymTable symTable;
+		bool isMerged = true;
+
+		for (size_t i = 0; i < chunks.size(); ++i)
+		{
+			SymTable chunkSymTable;
+
+			REQUIRE(Parser(tokens, chunkSymTable, mockOptions, [](auto&&) { REQUIRE(false); }).ParseChunk(chunks[i], i + 1 == chunks.size()));
+			isMerged = symTable.Merge(chunkSymTable);
+		}
+
+		REQUIRE(!isMerged);
+	}
+
+	SECTION("TestSplitIntoDeclarationsChunks_PassNamespacesThatChunksCantStartWithin_ReturnsNothing")
+	{
+		for (const std::string& currSource : { "namespace A::B { enum E { A }; }", "namespace X = Y; enum E { A };" })
+		{
+			std::unique_ptr<IInputStream> stream{ new MockInputStream { { currSource } } };
+
+			REQUIRE(SplitIntoDeclarationsChunks(Lexer(*stream).Tokenize(), 1).empty());
+		}
+	}
+
+	SECTION("TestParse_PassDeclarationsCutOffByEOF_StopsWithErrors")
+	{
+		for (const std::string& currSource : { "typedef int TValue", "class TDerived : public TBase<int", "class TData { int mValue; }", "struct TData { void Foo() const" })
+		{
+			for (const bool isTaggedOnlyModeEnabled : { false, true })
+			{
+				std::unique_ptr<IInputStream> stream{ new MockInputStream { { currSource } } };
+
+				TIntrospectorOptions options;
+				options.mIsTaggedOnlyModeEnabled = isTaggedOnlyModeEnabled;
+
+				const TTokensArray tokens = Lexer(*stream).Tokenize();
+				SymTable symTable;
+
+				bool hasErrors = false;
+
+				Parser(tokens, symTable, options, [&hasErrors](auto&&) { hasErrors = true; }).Parse();
+
+				REQUIRE(hasErrors);
+			}
+		}
+	}
+
+	SECTION("TestParse_PassFileThatExceedsTokensBudget_ReportsBudgetExceededOnce")
+	{
+		const std::vector<std::string> lines
+		{
+			"struct TFirst { int mValue; };",
+			"struct TSecond { int mValue; };",
+			"struct TThird { int mValue; };",
+		};
+
+		for (const bool isTokenized : { false, true })
+		{
+			std::unique_ptr<IInputStream> stream{ new MockInputStream { lines } };
+
+			ParsingBudget budget(12, 0);
+			SymTable symTable;
+
+			std::vector<TParserError::E_PARSER_ERROR_CODE> errors;
+
+			auto onErrorCallback = [&errors](auto&& error)
+			{
+				errors.push_back(error.mCode);
+			};
+
+			Lexer lexer(*stream);
+
+			if (isTokenized)
+			{
+				const TTokensArray tokens = lexer.Tokenize(&budget);
+				REQUIRE(tokens.GetSize() == 13);
+
+				Parser(tokens, symTable, mockOptions, onErrorCallback, &budget).Parse();
+			}
+			else
+			{
+				Parser(lexer, symTable, mockOptions, onErrorCallback, &budget).Parse();
+			}
+
+			REQUIRE(budget.IsExceeded());
+			REQUIRE(std::count(errors.cbegin(), errors.cend(), TParserError::E_PARSER_ERROR_CODE::BUDGET_EXCEEDED) == 1);
+			REQUIRE(symTable.GetClasses().size() < 3);
+		}
+
+		std::unique_ptr<IInputStream> stream{ new MockInputStream { lines } };
+
+		ParsingBudget unlimitedBudget(0, 0);
+		SymTable symTable;
+
+		Parser(Lexer(*stream).Tokenize(&unlimitedBudget), symTable, mockOptions, [](auto&&) { REQUIRE(false); }, &unlimitedBudget).Parse();
+
+		REQUIRE(!unlimitedBudget.IsExceeded());
+		REQUIRE(symTable.GetClasses().size() == 3);
+	}
 }
@@ -0,0 +1,196 @@
+#include <scankernels.h>
+#include <prefilter.h>
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+#include <vector>
+#include <random>
+
+
+using namespace TDEngine2;
+
+
+namespace
+{
+	std::vector<const TScanKernels*> GetSupportedKernels()
+	{
+		std::vector<const TScanKernels*> kernels;
+
+		for (const E_SCAN_KERNELS_TYPE currType : { E_SCAN_KERNELS_TYPE::SCALAR, E_SCAN_KERNELS_TYPE::SSE2, E_SCAN_KERNELS_TYPE::AVX2 })
+		{
+			if (IsScanKernelsTypeSupported(currType))
+			{
+				kernels.push_back(&GetScanKernels(currType));
+			}
+		}
+
+		return kernels;
+	}
+
+
+	std::string GenerateRandomText(size_t size, uint32_t seed)
+	{
+		static const std::string alphabet = "abcXYZ019_ \t\n*/\\#{};\x80\xFF";
+
+		std::mt19937 generator(seed);
+		std::uniform_int_distribution<size_t> distribution(0, alphabet.size() - 1);
+
+		std::string text(size, ' ');
+
+		for (char& currCh : text)
+		{
+			currCh = alphabet[distribution(generator)];
+		}
+
+		return text;
+	}
+}
+
+
+TEST_CASE("Scan kernels tests")
+{
+	SECTION("TestCharClassesTable_PassAllChars_MatchesClassicLocale")
+	{
+		for (uint32_t ch = 0; ch < 128; ++ch)
+		{
+			const bool isAlpha = (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z');
+			const bool isDigit = (ch >= '0' && ch <= '9');
+
+			REQUIRE(IsIdentifierStartChar(static_cast<char>(ch)) == (isAlpha || ch == '_'));
+			REQUIRE(IsIdentifierChar(static_cast<char>(ch)) == (isAlpha || isDigit || ch == '_'));
+			REQUIRE(IsWhitespaceChar(static_cast<char>(ch)) == (ch == ' ' || (ch >= '\t' && ch <= '\r')));
+		}
+
+		for (uint32_t ch = 128; ch < 256; ++ch)
+		{
+			REQUIRE(!IsIdentifierChar(static_cast<char>(ch)));
+			REQUIRE(!IsWhitespaceChar(static_cast<char>(ch)));
+		}
+	}
+
+	SECTION("TestScanKernels_PassRandomTexts_AllKernelsReturnSameResultsAsScalarOnes")
+	{
+		const TScanKernels& scalarKernels = GetScanKernels(E_SCAN_KERNELS_TYPE::SCALAR);
+
+		TCharsSet chars;
+		chars.Add('#');
+		chars.Add('Z');
+		chars.Add('\x80');
+
+		for (uint32_t seed = 0; seed < 8; ++seed)
+		{
+			const std::string text = GenerateRandomText(257 + seed * 31, seed);
+
+			for (const TScanKernels* pKernels : GetSupportedKernels())
+			{
+				for (size_t pos = 0; pos <= text.size(); ++pos)
+				{
+					REQUIRE(pKernels->mpFindNewLine(text, pos) == scalarKernels.mpFindNewLine(text, pos));
+					REQUIRE(pKernels->mpFindCommentDelimiter(text, pos) == scalarKernels.mpFindCommentDelimiter(text, pos));
+					REQUIRE(pKernels->mpFindIdentifierEnd(text, pos) == scalarKernels.mpFindIdentifierEnd(text, pos));
+					REQUIRE(pKernels->mpCountNewLines(text, pos, text.size()) == scalarKernels.mpCountNewLines(text, pos, text.size()));
+					REQUIRE(pKernels->mpFindAnyOfChars(text, pos, chars) == scalarKernels.mpFindAnyOfChars(text, pos, chars));
+				}
+			}
+		}
+	}
+
+	SECTION("TestScanKernels_PassLongRunsWithoutMatches_ReturnsPositionsAfterVectorizedPart")
+	{
+		const std::string identifier(100, 'a');
+		const std::string comment = std::string(70, ' ') + "*/";
+
+		for (const TScanKernels* pKernels : GetSupportedKernels())
+		{
+			REQUIRE(pKernels->mpFindIdentifierEnd(identifier + " ", 0) == identifier.size());
+			REQUIRE(pKernels->mpFindIdentifierEnd(identifier, 3) == identifier.size());
+			REQUIRE(pKernels->mpFindNewLine(identifier, 0) == identifier.size());
+			REQUIRE(pKernels->mpFindCommentDelimiter(comment, 0) == comment.size() - 2);
+			REQUIRE(pKernels->mpCountNewLines(identifier + "\n\n", 0, identifier.size() + 1) == 1);
+		}
+	}
+
+	SECTION("TestFindMacroDefinitionEnd_PassContinuedLines_ReturnsPositionOfLastNewLine")
+	{
+		const std::string text = "define FOO(x) \\\n{\\\r\n blah \\\n}\nint";
+
+		for (const TScanKernels* pKernels : GetSupportedKernels())
+		{
+			REQUIRE(FindMacroDefinitionEnd(*pKernels, text, 0) == text.find("}\n") + 1);
+			REQUIRE(FindMacroDefinitionEnd(*pKernels, "define FOO", 0) == 10);
+			REQUIRE(FindMacroDefinitionEnd(*pKernels, "pragma once\n\\\n", 0) == 11);
+		}
+	}
+
+	SECTION("TestKeywordsPrefilter_PassTextsWithAndWithoutKeywords_MatchesOnlyWholeIdentifiers")
+	{
+		for (const TScanKernels* pKernels : GetSupportedKernels())
+		{
+			const KeywordsPrefilter prefilter({ "ENUM_META", "CLASS_META", "INTERFACE_META" }, *pKernels);
+
+			REQUIRE(!prefilter.HasAnyKeyword(""));
+			REQUIRE(!prefilter.HasAnyKeyword("enum class E_VALUES { FIRST, SECOND };\nvoid Foo();"));
+			REQUIRE(!prefilter.HasAnyKeyword(std::string(100, ' ') + "MY_ENUM_META() CLASS_METADATA"));
+			REQUIRE(prefilter.HasAnyKeyword(std::string(100, ' ') + "enum class ENUM_META() E_VALUES {};"));
+			REQUIRE(prefilter.HasAnyKeyword("class CLASS_META"));
+			REQUIRE(prefilter.HasAnyKeyword("INTERFACE_META"));
+		}
+
+		TIntrospectorOptions options;
+		options.mIsTaggedOnlyModeEnabled = false;
+
+		const KeywordsPrefilter defaultPrefilter = KeywordsPrefilter::CreateFromOptions(options);
+
+		REQUIRE(defaultPrefilter.HasAnyKeyword("typedef struct { int a; } TData;"));
+		REQUIRE(!defaultPrefilter.HasAnyKeyword("#define ENUMERATE(x) classify(x)\nvoid Foo(); // enumeration"));
+	}
+
+	SECTION("TestTypesFilter_PassEmitFlagsAndExcludedTypenames_AnswersWhetherTypesAreEmitted")
+	{
+		const TypesFilter filter(E_EMIT_FLAGS::ENUMS | E_EMIT_FLAGS::STRUCTS, { "T.*Impl", "E_INTERNAL" });
+
+		REQUIRE(filter.IsEnumEmittable("E_VALUES"));
+		REQUIRE(!filter.IsEnumEmittable("E_INTERNAL"));
+		REQUIRE(filter.IsClassEmittable("TData", true));
+		REQUIRE(!filter.IsClassEmittable("TDataImpl", true));
+		REQUIRE(!filter.IsClassEmittable("CClass", false));
+
+		const TypesFilter enumsOnlyFilter(E_EMIT_FLAGS::ENUMS, {});
+
+		REQUIRE(!enumsOnlyFilter.IsClassEmittable("TData", true));
+		REQUIRE(!enumsOnlyFilter.IsClassEmittable("CClass", false));
+
+		REQUIRE(filter.GetDigest() != enumsOnlyFilter.GetDigest());
+		REQUIRE(filter.GetDigest() != TypesFilter(E_EMIT_FLAGS::ENUMS | E_EMIT_FLAGS::STRUCTS, { "T.*Impl" }).GetDigest());
+		REQUIRE(filter.GetDigest() == TypesFilter(E_EMIT_FLAGS::ENUMS | E_EMIT_FLAGS::STRUCTS, { "T.*Impl", "E_INTERNAL" }).GetDigest());
+	}
+
+	SECTION("TestFindBalancedBlockEnd_PassBracesWithinCommentsLiteralsAndMacros_SkipsThem")
+	{
+		const std::string text =
+			"{ void Foo() { const char* s = \"}\\\"{\"; char c = '}'; int n = 1'000; }\n"
+			"// }\n"
+			"/* } /* nested } */ } */\n"
+			"#define BRACE }\n"
+			"BEGIN_IGNORE_META_SECTION } END_IGNORE_META_SECTION\n"
+			"MY_BEGIN_IGNORE_META_SECTION { }\n"
+			"} int after;";
+
+		for (const TScanKernels* pKernels : GetSupportedKernels())
+		{
+			REQUIRE(FindBalancedBlockEnd(*pKernels, text, 0) == text.rfind('}') + 1);
+			REQUIRE(FindBalancedBlockEnd(*pKernels, "{ { }", 0) == 5);
+			REQUIRE(FindBalancedBlockEnd(*pKernels, "{}", 0) == 2);
+		}
+	}
+
+	SECTION("TestFindIgnoreSectionEnd_PassSectionWithKeywordsInCommentsAndLiterals_ReturnsPositionAfterEndKeyword")
+	{
+		const std::string text = "a // END_IGNORE_META_SECTION\n\"END_IGNORE_META_SECTION\" MY_END_IGNORE_META_SECTION END_IGNORE_META_SECTION b";
+
+		for (const TScanKernels* pKernels : GetSupportedKernels())
+		{
+			REQUIRE(FindIgnoreSectionEnd(*pKernels, text, 0) == text.size() - 2);
+			REQUIRE(FindIgnoreSectionEnd(*pKernels, "a b c", 0) == 5);
+		}
+	}
+}
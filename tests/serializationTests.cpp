@@ -1,8 +1,10 @@
 #include <symtable.h>
 #include <common.h>
+#include <cacheformat.h>
 #include "../deps/archive/archive.h"
 #include <catch2/catch_test_macros.hpp>
 #include <fstream>
+#include <sstream>
 
 
 using namespace TDEngine2;
@@ -41,10 +43,12 @@ TEST_CASE("Serialization tests")
 			std::ifstream infile(filename, std::ios::binary);
 			Archive<std::ifstream> archive(infile);
 
-			std::unique_ptr<TType> pType = TType::Deserialize(archive);
+			MemoryArena arena;
+
+			TType* pType = TType::Deserialize(archive, arena);
 			REQUIRE(pType);
 
-			TEnumType* pEnumType = dynamic_cast<TEnumType*>(pType.get());
+			TEnumType* pEnumType = TypeCast<TEnumType>(pType);
 			REQUIRE((pEnumType && pEnumType->mId == enumName && pEnumType->mEnumerators.size() == 4));
 
 			infile.close();
@@ -76,10 +80,12 @@ TEST_CASE("Serialization tests")
 			std::ifstream infile(TestSerializationFilename);
 			Archive<std::ifstream> archive(infile);
 
-			std::unique_ptr<TType> pType = TType::Deserialize(archive);
+			MemoryArena arena;
+
+			TType* pType = TType::Deserialize(archive, arena);
 			REQUIRE(pType);
 
-			TClassType* pClassType = dynamic_cast<TClassType*>(pType.get());
+			TClassType* pClassType = TypeCast<TClassType>(pType);
 			REQUIRE((pClassType && pClassType->mId == className && pClassType->mBaseClasses.size() == 2));
 			
 			if (pClassType)
@@ -114,10 +120,12 @@ TEST_CASE("Serialization tests")
 			std::ifstream infile(TestSerializationFilename);
 			Archive<std::ifstream> archive(infile);
 
-			std::unique_ptr<TType> pType = TType::Deserialize(archive);
+			MemoryArena arena;
+
+			TType* pType = TType::Deserialize(archive, arena);
 			REQUIRE(pType);
 
-			TNamespaceType* pNamespaceType = dynamic_cast<TNamespaceType*>(pType.get());
+			TNamespaceType* pNamespaceType = TypeCast<TNamespaceType>(pType);
 			REQUIRE((pNamespaceType && pNamespaceType->mId == namespaceName));
 
 			infile.close();
@@ -141,26 +149,35 @@ TEST_CASE("Serialization tests")
 			std::ifstream infile(TestSerializationFilename);
 			Archive<std::ifstream> archive(infile);
 
-			std::unique_ptr<TType> pType = TType::Deserialize(archive);
+			MemoryArena arena;
+
+			TType* pType = TType::Deserialize(archive, arena);
 			REQUIRE(!pType);
 
 			infile.close();
 		}
 	}
 
-	SECTION("TestScopeEntitySerializationDeserialization")
+	SECTION("TestSymTableSerializationDeserialization")
 	{
 		// Serialization
 		{
-			std::unique_ptr<SymTable::TScopeEntity> pScope = std::make_unique<SymTable::TScopeEntity>();
-			pScope->mIndex = 2;
-			pScope->mVariables.push_back({ "a" });
-			pScope->mVariables.push_back({ "b" });
+			SymTable symTable;
+			symTable.AddSymbol({ "a" });
+			symTable.AddSymbol({ "b" });
+
+			symTable.CreateScope("A");
+			symTable.AddSymbol({ "c" });
+			symTable.AddSymbol({ "d" });
+			symTable.ExitScope();
+
+			symTable.CreateScope();
+			symTable.ExitScope();
 
 			std::ofstream outfile(TestSerializationFilename);
 			Archive<std::ofstream> archive(outfile);
 
-			REQUIRE(pScope->Save(archive));
+			REQUIRE(symTable.Save(archive));
 
 			outfile.close();
 		}
@@ -170,66 +187,180 @@ TEST_CASE("Serialization tests")
 			std::ifstream infile(TestSerializationFilename);
 			Archive<std::ifstream> archive(infile);
 
-			std::unique_ptr<SymTable::TScopeEntity> pScope = std::make_unique<SymTable::TScopeEntity>();
-			REQUIRE(pScope->Load(archive, nullptr));
+			SymTable symTable;
+			REQUIRE(symTable.Load(archive));
 
-			REQUIRE(pScope->mIndex == 2);
+			SymTable::TScopeEntity* pScope = symTable.GetScope(SymTable::mGlobalScopeIndex);
+			REQUIRE(pScope);
 			REQUIRE(pScope->mVariables.size() == 2);
 			REQUIRE(pScope->mVariables[0].mName == "a");
 			REQUIRE(pScope->mVariables[1].mName == "b");
-			REQUIRE(pScope->mpNamedScopes.empty());
-			REQUIRE(pScope->mpNestedScopes.empty());
+			REQUIRE(pScope->GetNamedScopesCount() == 1);
+			REQUIRE(pScope->mNestedScopes.size() == 1);
+
+			SymTable::TScopeEntity* pNestedScope = symTable.LookUpNamedScope("A");
+			REQUIRE(pNestedScope);
+
+			REQUIRE(pNestedScope->mIndex == -1);
+			REQUIRE(pNestedScope->mParentIndex == SymTable::mGlobalScopeIndex);
+			REQUIRE(pNestedScope->mVariables.size() == 2);
+			REQUIRE(pNestedScope->mVariables[0].mName == "c");
+			REQUIRE(pNestedScope->mVariables[1].mName == "d");
+			REQUIRE(pNestedScope->GetNamedScopesCount() == 0);
+			REQUIRE(pNestedScope->mNestedScopes.empty());
+
+			REQUIRE(symTable.GetScope(pScope->mNestedScopes[0])->mIndex == 0);
 
 			infile.close();
 		}
 	}
 
-	SECTION("TestComplexScopeEntitySerializationDeserialization")
+	SECTION("TestSymTableDeserialization_PassDataOfAnotherLayout_ReturnsFalse")
 	{
-		// Serialization
 		{
-			std::unique_ptr<SymTable::TScopeEntity> pScope = std::make_unique<SymTable::TScopeEntity>();
-			pScope->mIndex = 2;
-			pScope->mVariables.push_back({ "a" });
-			pScope->mVariables.push_back({ "b" });
-			pScope->mpNamedScopes["A"] = std::make_unique<SymTable::TScopeEntity>();
-			pScope->mpNamedScopes["A"]->mIndex = 0;
-			pScope->mpNamedScopes["A"]->mVariables.push_back({ "c" });
-			pScope->mpNamedScopes["A"]->mVariables.push_back({ "d" });
-
 			std::ofstream outfile(TestSerializationFilename);
 			Archive<std::ofstream> archive(outfile);
 
-			REQUIRE(pScope->Save(archive));
+			archive << static_cast<uint32_t>(42);
 
 			outfile.close();
 		}
 
-		// Deserialization
+		std::ifstream infile(TestSerializationFilename);
+		Archive<std::ifstream> archive(infile);
+
+		SymTable symTable;
+		REQUIRE(!symTable.Load(archive));
+
+		infile.close();
+	}
+
+	SECTION("TestSymTableImage_SaveAndLoadTable_RestoresScopesAndSharedTypes")
+	{
+		const std::string optionsDigest = "tagged:0";
+
+		std::string image;
+
 		{
-			std::ifstream infile(TestSerializationFilename);
-			Archive<std::ifstream> archive(infile);
+			SymTable symTable;
+			symTable.SetSourceFilename("test.h");
+
+			symTable.CreateScope("N");
+			TNamespaceType* pNamespaceType = symTable.CreateType<TNamespaceType>();
+			pNamespaceType->mId = "N";
+			symTable.SetScopeType(*symTable.LookUpNamedScope("N"), pNamespaceType);
+
+			symTable.CreateScope("B");
+			TClassType* pClassType = symTable.CreateType<TClassType>();
+			pClassType->mId = "B";
+			pClassType->mMangledId = "N@B";
+			pClassType->mIsStruct = true;
+			pClassType->mpParentType = pNamespaceType;
+			pClassType->mFields.push_back("mValue");
+			pClassType->mBaseClasses.push_back({ "N::A", true, E_ACCESS_SPECIFIER_TYPE::PUBLIC });
+			symTable.SetScopeType(*symTable.LookUpNamedScope("B"), pClassType);
+			symTable.ExitScope();
+
+			symTable.CreateScope("E");
+			TEnumType* pEnumType = symTable.CreateType<TEnumType>();
+			pEnumType->mId = "E";
+			pEnumType->mMangledId = "N@E";
+			pEnumType->mSectionId = "common";
+			pEnumType->mIsStronglyTyped = true;
+			pEnumType->mUnderlyingTypeStr = "uint8_t";
+			pEnumType->mEnumerators = { "FIRST", "SECOND" };
+			pEnumType->mpParentType = pNamespaceType;
+			symTable.SetScopeType(*symTable.LookUpNamedScope("E"), pEnumType);
+			symTable.ExitScope();
+
+			symTable.AddSymbol({ "b", pClassType });
+			symTable.ExitScope();
+
+			image = symTable.SaveImage(optionsDigest);
+		}
 
-			std::unique_ptr<SymTable::TScopeEntity> pScope = std::make_unique<SymTable::TScopeEntity>();
-			REQUIRE(pScope->Load(archive, nullptr));
+		REQUIRE(CacheFormat::IsImage(image));
 
-			REQUIRE(pScope->mIndex == 2);
-			REQUIRE(pScope->mVariables.size() == 2);
-			REQUIRE(pScope->mVariables[0].mName == "a");
-			REQUIRE(pScope->mVariables[1].mName == "b");
-			REQUIRE(pScope->mpNamedScopes.size() == 1);
-			REQUIRE(pScope->mpNestedScopes.empty());
+		SymTable symTable;
+		REQUIRE(symTable.LoadImage(image, optionsDigest));
 
-			SymTable::TScopeEntity* pNestedScope = pScope->mpNamedScopes["A"].get();
+		REQUIRE(symTable.GetSourceFilename() == "test.h");
+		REQUIRE(!symTable.IsSkipped());
 
-			REQUIRE(pNestedScope->mIndex == 0);
-			REQUIRE(pNestedScope->mVariables.size() == 2);
-			REQUIRE(pNestedScope->mVariables[0].mName == "c");
-			REQUIRE(pNestedScope->mVariables[1].mName == "d");
-			REQUIRE(pNestedScope->mpNamedScopes.empty());
-			REQUIRE(pNestedScope->mpNestedScopes.empty());
+		REQUIRE(symTable.GetEnums().size() == 1);
+		REQUIRE(symTable.GetClasses().size() == 1);
 
-			infile.close();
+		const TEnumType* pEnumType = symTable.GetEnums()[0];
+		REQUIRE((pEnumType && pEnumType->mMangledId == "N@E" && pEnumType->mSectionId == "common" && pEnumType->mUnderlyingTypeStr == "uint8_t"));
+		REQUIRE((pEnumType->mIsStronglyTyped && pEnumType->mEnumerators.size() == 2 && pEnumType->mEnumerators[1] == "SECOND"));
+
+		const TClassType* pClassType = symTable.GetClasses()[0];
+		REQUIRE((pClassType && pClassType->mMangledId == "N@B" && pClassType->mIsStruct && !pClassType->mIsFinal));
+		REQUIRE((pClassType->mFields.size() == 1 && pClassType->mFields[0] == "mValue"));
+		REQUIRE((pClassType->mBaseClasses.size() == 1 && pClassType->mBaseClasses[0].mFullName == "N::A" && pClassType->mBaseClasses[0].mIsVirtualInherited));
+
+		/// \note Types are shared as they were within the saved table
+		REQUIRE(TypeCast<TNamespaceType>(pClassType->mpParentType));
+		REQUIRE(pClassType->mpParentType == pEnumType->mpParentType);
+
+		SymTable::TScopeEntity* pNamespaceScope = symTable.LookUpNamedScope("N");
+		REQUIRE(pNamespaceScope);
+		REQUIRE(pNamespaceScope->mpType == pClassType->mpParentType);
+		REQUIRE((pNamespaceScope->mVariables.size() == 1 && pNamespaceScope->mVariables[0].mpType == pClassType));
+	}
+
+	SECTION("TestSymTableImage_PassImageOfOtherOptionsOrDamagedOne_ReturnsFalse")
+	{
+		SymTable symTable;
+		symTable.AddSymbol({ "a" });
+		symTable.MarkAsSkipped();
+
+		const std::string image = symTable.SaveImage("tagged:0");
+
+		SymTable loadedSymTable;
+		REQUIRE(loadedSymTable.LoadImage(image, "tagged:0"));
+		REQUIRE(loadedSymTable.IsSkipped());
+
+		REQUIRE(!loadedSymTable.LoadImage(image, "tagged:1"));
+		REQUIRE(!loadedSymTable.LoadImage(image.substr(0, image.size() - 1), "tagged:0"));
+		REQUIRE(!loadedSymTable.LoadImage(image.substr(0, sizeof(CacheFormat::THeader) - 1), "tagged:0"));
+	}
+
+	SECTION("TestIsImage_PassTableOfPreviousFormat_ReturnsFalse")
+	{
+		{
+			std::ofstream outfile(TestSerializationFilename, std::ios::binary);
+			Archive<std::ofstream> archive(outfile);
+
+			SymTable symTable;
+			REQUIRE(symTable.Save(archive));
+
+			outfile.close();
 		}
+
+		std::ifstream infile(TestSerializationFilename, std::ios::binary);
+
+		std::stringstream content;
+		content << infile.rdbuf();
+
+		REQUIRE(!CacheFormat::IsImage(content.str()));
+	}
+
+	SECTION("TestIsIndex_PassImageOfTable_ReturnsFalse")
+	{
+		SymTable symTable;
+
+		const std::string image = symTable.SaveImage("tagged:0");
+
+		REQUIRE(!CacheFormat::IsIndex(image));
+
+		CacheFormat::TIndexHeader header { CacheFormat::mIndexMagic, CacheFormat::mVersion };
+		CacheFormat::SwapWordsIfBigEndian(reinterpret_cast<uint32_t*>(&header), sizeof(header) / sizeof(uint32_t));
+
+		const std::string index(reinterpret_cast<const char*>(&header), sizeof(header));
+
+		REQUIRE(CacheFormat::IsIndex(index));
+		REQUIRE(!CacheFormat::IsImage(index));
+		REQUIRE(!CacheFormat::IsIndex(index.substr(0, sizeof(header) - 1)));
 	}
 }
@@ -0,0 +1,104 @@
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <symtable.h>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark.hpp>
+
+
+using namespace TDEngine2;
+
+
+namespace
+{
+	std::vector<TAtom> GenerateSymbolsNames(size_t count)
+	{
+		std::vector<TAtom> names;
+		names.reserve(count);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			names.emplace_back(std::string("mGeneratedField").append(std::to_string(i)));
+		}
+
+		return names;
+	}
+
+
+	/*!
+		\brief The function fills a named scope with the given symbols and looks each of them up from within the scope
+	*/
+
+	size_t AddAndLookUpSymbols(const std::vector<TAtom>& names)
+	{
+		SymTable symTable;
+		symTable.CreateScope("TGeneratedClass");
+
+		for (auto&& currName : names)
+		{
+			symTable.AddSymbol({ currName });
+		}
+
+		size_t foundCount = 0;
+
+		for (auto&& currName : names)
+		{
+			foundCount += (symTable.LookUpSymbol(currName) != TSymbolDesc::mInvalid) ? 1 : 0;
+		}
+
+		symTable.ExitScope();
+
+		return foundCount;
+	}
+
+
+	/*!
+		\brief The function reproduces the previous implementation that scanned all variables of a scope on each insertion
+	*/
+
+	size_t AddSymbolsWithLinearScan(const std::vector<TAtom>& names)
+	{
+		std::vector<TSymbolDesc> symbols;
+
+		for (auto&& currName : names)
+		{
+			auto it = std::find_if(symbols.begin(), symbols.end(), [&currName](const TSymbolDesc& entity) { return currName == entity.mName; });
+			if (it == symbols.end())
+			{
+				symbols.push_back({ currName });
+			}
+		}
+
+		return symbols.size();
+	}
+}
+
+
+TEST_CASE("SymTable benchmarks", "[.][benchmark]")
+{
+	const std::vector<TAtom> smallScopeNames = GenerateSymbolsNames(10);
+	const std::vector<TAtom> mediumScopeNames = GenerateSymbolsNames(100);
+	const std::vector<TAtom> hugeScopeNames = GenerateSymbolsNames(10000);
+
+	REQUIRE(AddAndLookUpSymbols(hugeScopeNames) == hugeScopeNames.size());
+
+	BENCHMARK("SymTable, add and look up 10 symbols per scope")
+	{
+		return AddAndLookUpSymbols(smallScopeNames);
+	};
+
+	BENCHMARK("SymTable, add and look up 100 symbols per scope")
+	{
+		return AddAndLookUpSymbols(mediumScopeNames);
+	};
+
+	BENCHMARK("SymTable, add and look up 10k symbols per scope")
+	{
+		return AddAndLookUpSymbols(hugeScopeNames);
+	};
+
+	BENCHMARK("Linear scan (previous implementation), add 10k symbols per scope")
+	{
+		return AddSymbolsWithLinearScan(hugeScopeNames);
+	};
+}
@@ -58,4 +58,93 @@ TEST_CASE("SymTable tests")
 		REQUIRE(symTable.LookUpSymbol("x") != TSymbolDesc::mInvalid);
 		symTable.ExitScope();
 	}
+
+	SECTION("TestLookUpNamedScope_PassManyNamedScopes_FindsEachOfThem")
+	{
+		SymTable symTable;
+
+		for (int i = 0; i < 100; ++i)
+		{
+			REQUIRE(symTable.CreateScope("Scope" + std::to_string(i)));
+			symTable.ExitScope();
+		}
+
+		REQUIRE(!symTable.CreateScope("Scope42"));
+
+		for (int i = 0; i < 100; ++i)
+		{
+			auto pScope = symTable.LookUpNamedScope("Scope" + std::to_string(i));
+			REQUIRE((pScope && pScope->mName == "Scope" + std::to_string(i)));
+		}
+
+		REQUIRE(!symTable.LookUpNamedScope("Scope100"));
+	}
+
+	SECTION("TestGetMangledNameForNamedScope_PassNestedTypedScopes_ReturnsPathOfTypes")
+	{
+		SymTable symTable;
+
+		symTable.CreateScope("NS");
+		symTable.LookUpNamedScope("NS")->mpType = symTable.CreateType<TNamespaceType>();
+		symTable.LookUpNamedScope("NS")->mpType->mId = "NS";
+
+		symTable.CreateScope(); // \note Anonymous scopes don't affect the result
+		symTable.CreateScope("Class");
+		symTable.LookUpNamedScope("Class")->mpType = symTable.CreateType<TClassType>();
+		symTable.LookUpNamedScope("Class")->mpType->mId = "Class";
+
+		symTable.CreateScope("Enum");
+
+		REQUIRE(symTable.GetMangledNameForNamedScope("Enum") == "NS@Class@Enum");
+		REQUIRE(symTable.GetMangledNameForNamedScope("Class") == "NS@Class");
+		REQUIRE(symTable.GetMangledNameForNamedScope("NS") == "NS");
+		REQUIRE(symTable.GetMangledNameForNamedScope("Unknown").IsEmpty());
+	}
+
+	SECTION("TestAddSymbol_PassManySymbolsIntoScope_KeepsDeclarationOrderAndUpdatesDuplicates")
+	{
+		SymTable symTable;
+
+		TClassType type;
+
+		for (uint32_t i = 0; i < 4 * SymTable::mSymbolsIndexThreshold; ++i)
+		{
+			symTable.AddSymbol({ "var" + std::to_string(i) });
+
+			/// \note Lookups in the middle of insertions make the index to be rebuilt incrementally
+			REQUIRE(symTable.LookUpSymbol("var" + std::to_string(i / 2)) != TSymbolDesc::mInvalid);
+		}
+
+		symTable.AddSymbol({ "var3", &type });
+
+		auto pScope = symTable.GetScope(SymTable::mGlobalScopeIndex);
+		REQUIRE(pScope->mVariables.size() == 4 * SymTable::mSymbolsIndexThreshold);
+
+		for (uint32_t i = 0; i < pScope->mVariables.size(); ++i)
+		{
+			REQUIRE(pScope->mVariables[i].mName == "var" + std::to_string(i));
+		}
+
+		REQUIRE(symTable.LookUpSymbol("var3").mpType == &type);
+		REQUIRE(symTable.LookUpSymbol("unknown") == TSymbolDesc::mInvalid);
+	}
+
+	SECTION("TestTypeCast_PassTypesOfDifferentSubtypes_ReturnsOnlyMatchingOnes")
+	{
+		TEnumType enumType;
+		TClassType classType;
+		TNamespaceType namespaceType;
+
+		TType* pEnumType = &enumType;
+		const TType* pClassType = &classType;
+
+		REQUIRE(TypeCast<TEnumType>(pEnumType) == &enumType);
+		REQUIRE(!TypeCast<TClassType>(pEnumType));
+		REQUIRE(TypeCast<TClassType>(pClassType) == &classType);
+		REQUIRE(!TypeCast<TNamespaceType>(pClassType));
+		REQUIRE(!TypeCast<TEnumType>(static_cast<TType*>(nullptr)));
+
+		REQUIRE(namespaceType.GetSubtype() == TType::E_SUBTYPE::NAMESPACE);
+		REQUIRE(TType{}.GetSubtype() == TType::E_SUBTYPE::BASE);
+	}
 }